@@ -0,0 +1,190 @@
+/**
+ * b_plus_tree_bulk_loader.cpp
+ */
+#include <algorithm>
+#include <cmath>
+
+#include "common/exception.h"
+#include "common/rid.h"
+#include "index/b_plus_tree_bulk_loader.h"
+#include "page/header_page.h"
+
+namespace scudb {
+
+/*
+ * Plan every level from the leaves up until a level fits in one page, the
+ * root. The leaf level has num_entries entries; each level above has one
+ * entry per page of the level below.
+ */
+INDEX_TEMPLATE_ARGUMENTS
+B_PLUS_TREE_BULK_LOADER_TYPE::BPlusTreeBulkLoader(
+    BufferPoolManager *buffer_pool_manager, const KeyComparator &comparator,
+    size_t num_entries, double fill_factor)
+    : buffer_pool_manager_(buffer_pool_manager), comparator_(comparator),
+      num_entries_(num_entries), appended_(0) {
+  // max/min size as set by Init, without creating a page
+  int leaf_max = static_cast<int>((PAGE_SIZE - sizeof(LeafPage)) /
+                                  sizeof(std::pair<KeyType, ValueType>)) - 1;
+  int internal_max = static_cast<int>((PAGE_SIZE - sizeof(InternalPage)) /
+                                      sizeof(std::pair<KeyType, page_id_t>)) - 1;
+  size_t entries = num_entries;
+  bool leaf = true;
+  while (entries > 0) {
+    int max_size = leaf ? leaf_max : internal_max;
+    size_t pages = PlanPages(entries, max_size, max_size / 2, fill_factor);
+    levels_.push_back(Level{entries, pages, 0, nullptr});
+    if (pages == 1) {
+      break;
+    }
+    entries = pages;
+    leaf = false;
+  }
+}
+
+INDEX_TEMPLATE_ARGUMENTS
+B_PLUS_TREE_BULK_LOADER_TYPE::~BPlusTreeBulkLoader() {
+  for (auto &level : levels_) {
+    if (level.page != nullptr) {
+      buffer_pool_manager_->UnpinPage(level.page->GetPageId(), true);
+      level.page = nullptr;
+    }
+  }
+}
+
+/*
+ * Pages per level: as few as fill_factor allows, but never so few that a
+ * page overflows nor so many that an evenly filled page underflows.
+ */
+INDEX_TEMPLATE_ARGUMENTS
+size_t B_PLUS_TREE_BULK_LOADER_TYPE::PlanPages(size_t num_entries,
+                                               int max_size, int min_size,
+                                               double fill_factor) {
+  size_t target = static_cast<size_t>(std::floor(max_size * fill_factor));
+  target = std::max(target, static_cast<size_t>(std::max(min_size, 1)));
+  target = std::min(target, static_cast<size_t>(max_size));
+  size_t pages = (num_entries + target - 1) / target;
+  if (min_size > 0) {
+    pages = std::min(pages, std::max<size_t>(num_entries / min_size, 1));
+  }
+  return std::max(pages, (num_entries + max_size - 1) / max_size);
+}
+
+// entries are spread evenly, the first (num_entries % num_pages) get one more
+INDEX_TEMPLATE_ARGUMENTS
+int B_PLUS_TREE_BULK_LOADER_TYPE::PageCapacity(const Level &level) const {
+  return static_cast<int>(level.num_entries / level.num_pages +
+                          (level.page_index < level.num_entries % level.num_pages ? 1 : 0));
+}
+
+/*****************************************************************************
+ * LOADING
+ *****************************************************************************/
+INDEX_TEMPLATE_ARGUMENTS
+void B_PLUS_TREE_BULK_LOADER_TYPE::Append(const KeyType &key,
+                                          const ValueType &value) {
+  if (appended_ == num_entries_) {
+    throw Exception(EXCEPTION_TYPE_INDEX, "bulk load got more entries than planned");
+  }
+  if (appended_ > 0 && comparator_(last_key_, key) >= 0) {
+    throw Exception(EXCEPTION_TYPE_INDEX, "bulk load input is not strictly increasing");
+  }
+  Level &level = levels_[0];
+  if (level.page == nullptr || level.page->GetSize() == PageCapacity(level)) {
+    OpenPage(0, key);
+  }
+  LeafPage *leaf = reinterpret_cast<LeafPage *>(level.page);
+  // appending at the end: the binary search lands past the last entry and
+  // nothing is shifted
+  leaf->Insert(key, value, comparator_);
+  last_key_ = key;
+  appended_++;
+}
+
+/*
+ * Close the open page of this level (if any) and start the next one. Any page
+ * but the root is registered with the level above, whose open page becomes
+ * its parent; first_key is its separator there.
+ */
+INDEX_TEMPLATE_ARGUMENTS
+BPlusTreePage *B_PLUS_TREE_BULK_LOADER_TYPE::OpenPage(size_t level,
+                                                      const KeyType &first_key) {
+  Level &cur = levels_[level];
+  page_id_t page_id;
+  Page *raw = buffer_pool_manager_->NewPage(page_id);
+  if (raw == nullptr) {
+    throw Exception(EXCEPTION_TYPE_INDEX, "out of memory while bulk loading");
+  }
+  page_id_t parent_id = INVALID_PAGE_ID;
+  if (level + 1 < levels_.size()) {
+    parent_id = AppendChild(level + 1, first_key, page_id);
+  }
+  if (level == 0) {
+    LeafPage *leaf = reinterpret_cast<LeafPage *>(raw->GetData());
+    leaf->Init(page_id, parent_id);
+    if (cur.page != nullptr) {
+      reinterpret_cast<LeafPage *>(cur.page)->SetNextPageId(page_id);
+    }
+  } else {
+    reinterpret_cast<InternalPage *>(raw->GetData())->Init(page_id, parent_id);
+  }
+  if (cur.page != nullptr) {
+    assert(cur.page->GetSize() == PageCapacity(cur));
+    buffer_pool_manager_->UnpinPage(cur.page->GetPageId(), true);
+    cur.page_index++;
+  }
+  cur.page = reinterpret_cast<BPlusTreePage *>(raw->GetData());
+  return cur.page;
+}
+
+// returns the page the child went into, which is the child's parent
+INDEX_TEMPLATE_ARGUMENTS
+page_id_t B_PLUS_TREE_BULK_LOADER_TYPE::AppendChild(size_t level,
+                                                    const KeyType &key,
+                                                    page_id_t child) {
+  Level &cur = levels_[level];
+  if (cur.page == nullptr || cur.page->GetSize() == PageCapacity(cur)) {
+    OpenPage(level, key);
+  }
+  // the first key of an internal page is invalid; storing the separator there
+  // anyway is harmless
+  reinterpret_cast<InternalPage *>(cur.page)->Append(key, child);
+  return cur.page->GetPageId();
+}
+
+INDEX_TEMPLATE_ARGUMENTS
+page_id_t B_PLUS_TREE_BULK_LOADER_TYPE::Finish(const std::string &index_name) {
+  if (appended_ != num_entries_) {
+    throw Exception(EXCEPTION_TYPE_INDEX, "bulk load got fewer entries than planned");
+  }
+  page_id_t root_page_id = INVALID_PAGE_ID;
+  for (auto &level : levels_) {
+    root_page_id = level.page->GetPageId();
+    buffer_pool_manager_->UnpinPage(root_page_id, true);
+    level.page = nullptr;
+  }
+  if (!index_name.empty()) {
+    HeaderPage *header_page = static_cast<HeaderPage *>(
+        buffer_pool_manager_->FetchPage(HEADER_PAGE_ID));
+    if (header_page == nullptr) {
+      throw Exception(EXCEPTION_TYPE_INDEX, "all page are pinned while bulk loading");
+    }
+    if (!header_page->UpdateRecord(index_name, root_page_id)) {
+      header_page->InsertRecord(index_name, root_page_id);
+    }
+    buffer_pool_manager_->UnpinPage(HEADER_PAGE_ID, true);
+  }
+  return root_page_id;
+}
+
+template class BPlusTreeBulkLoader<GenericKey<4>, RID, GenericComparator<4>>;
+template class BPlusTreeBulkLoader<GenericKey<8>, RID, GenericComparator<8>>;
+template class BPlusTreeBulkLoader<GenericKey<16>, RID, GenericComparator<16>>;
+template class BPlusTreeBulkLoader<GenericKey<32>, RID, GenericComparator<32>>;
+template class BPlusTreeBulkLoader<GenericKey<64>, RID, GenericComparator<64>>;
+template class BPlusTreeBulkLoader<NormalizedKey<4>, RID, NormalizedComparator<4>>;
+template class BPlusTreeBulkLoader<NormalizedKey<8>, RID, NormalizedComparator<8>>;
+template class BPlusTreeBulkLoader<NormalizedKey<16>, RID, NormalizedComparator<16>>;
+template class BPlusTreeBulkLoader<NormalizedKey<32>, RID, NormalizedComparator<32>>;
+template class BPlusTreeBulkLoader<NormalizedKey<64>, RID, NormalizedComparator<64>>;
+
+} // namespace scudb
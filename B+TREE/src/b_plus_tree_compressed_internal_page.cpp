@@ -0,0 +1,326 @@
+/**
+ * b_plus_tree_compressed_internal_page.cpp
+ */
+#include "common/exception.h"
+#include "page/b_plus_tree_compressed_internal_page.h"
+
+namespace scudb {
+
+/*****************************************************************************
+ * HELPER METHODS AND UTILITIES
+ *****************************************************************************/
+
+INDEX_TEMPLATE_ARGUMENTS
+void B_PLUS_TREE_COMPRESSED_INTERNAL_PAGE_TYPE::Init(page_id_t page_id,
+                                                     page_id_t parent_id) {
+  this->SetPageType(IndexPageType::INTERNAL_PAGE);
+  this->SetSize(0);
+  this->SetPageId(page_id);
+  this->SetParentPageId(parent_id);
+  this->ResetVersion();
+  this->InitCompression();
+}
+
+// re-encodes the page, narrowing it if the replaced key was the widest
+INDEX_TEMPLATE_ARGUMENTS
+bool B_PLUS_TREE_COMPRESSED_INTERNAL_PAGE_TYPE::SetKeyAt(int index,
+                                                         const KeyType &key) {
+  assert(index > 0 && index < this->GetSize());
+  std::vector<MappingType> items = this->Entries(0, this->GetSize());
+  items[index].first = key;
+  return this->Assign(items);
+}
+
+INDEX_TEMPLATE_ARGUMENTS
+int B_PLUS_TREE_COMPRESSED_INTERNAL_PAGE_TYPE::ValueIndex(
+    const ValueType &value) const {
+  for (int i = 0; i < this->GetSize(); i++) {
+    if (value == this->ValueAt(i)) return i;
+  }
+  return -1;
+}
+
+INDEX_TEMPLATE_ARGUMENTS
+int B_PLUS_TREE_COMPRESSED_INTERNAL_PAGE_TYPE::ValueIndex(
+    const ValueType &value, int hint) const {
+  if (hint >= 0 && hint < this->GetSize() && this->ValueAt(hint) == value) {
+    return hint;
+  }
+  return ValueIndex(value);
+}
+
+/*****************************************************************************
+ * LOOKUP
+ *****************************************************************************/
+
+INDEX_TEMPLATE_ARGUMENTS
+ValueType B_PLUS_TREE_COMPRESSED_INTERNAL_PAGE_TYPE::Lookup(
+    const KeyType &key, const KeyComparator &comparator) const {
+  return this->ValueAt(LookupIndex(key, comparator));
+}
+
+INDEX_TEMPLATE_ARGUMENTS
+int B_PLUS_TREE_COMPRESSED_INTERNAL_PAGE_TYPE::LookupIndex(
+    const KeyType &key, const KeyComparator &comparator) const {
+  assert(this->GetSize() > 1);
+  int st = 1, ed = this->GetSize() - 1;
+  while (st <= ed) { //find the last key in array <= input
+    int mid = (ed - st) / 2 + st;
+    if (comparator(this->KeyAt(mid), key) <= 0) st = mid + 1;
+    else ed = mid - 1;
+  }
+  return st - 1;
+}
+
+/*****************************************************************************
+ * INSERTION
+ *****************************************************************************/
+
+INDEX_TEMPLATE_ARGUMENTS
+void B_PLUS_TREE_COMPRESSED_INTERNAL_PAGE_TYPE::PopulateNewRoot(
+    const ValueType &old_value, const KeyType &new_key,
+    const ValueType &new_value) {
+  bool fits = this->Assign({{new_key, old_value}, {new_key, new_value}});
+  assert(fits);
+  (void)fits;
+}
+
+INDEX_TEMPLATE_ARGUMENTS
+int B_PLUS_TREE_COMPRESSED_INTERNAL_PAGE_TYPE::InsertNodeAfter(
+    const ValueType &old_value, const KeyType &new_key,
+    const ValueType &new_value) {
+  int idx = ValueIndex(old_value) + 1;
+  assert(idx > 0);
+  return InsertNodeAt(idx, new_key, new_value);
+}
+
+INDEX_TEMPLATE_ARGUMENTS
+int B_PLUS_TREE_COMPRESSED_INTERNAL_PAGE_TYPE::InsertNodeAt(
+    int index, const KeyType &new_key, const ValueType &new_value) {
+  assert(index > 0 && index <= this->GetSize());
+  if (!this->Admit(new_key, 1)) {
+    return -1;
+  }
+  this->InsertAt(index, new_key, new_value);
+  return this->GetSize();
+}
+
+/*****************************************************************************
+ * SPLIT
+ *****************************************************************************/
+
+/*
+ * Move the upper half of the children to the empty recipient and return the
+ * key that separates the two pages, for the parent. It was the first key of
+ * the recipient, which is invalid and not kept there.
+ */
+INDEX_TEMPLATE_ARGUMENTS
+KeyType B_PLUS_TREE_COMPRESSED_INTERNAL_PAGE_TYPE::MoveHalfTo(
+    BPlusTreeCompressedInternalPage *recipient,
+    BufferPoolManager *buffer_pool_manager) {
+  KeyType middle_key = MoveHalfTo(recipient);
+  recipient->AdoptChildren(0, recipient->GetSize(), recipient->GetPageId(),
+                           buffer_pool_manager);
+  return middle_key;
+}
+
+INDEX_TEMPLATE_ARGUMENTS
+KeyType B_PLUS_TREE_COMPRESSED_INTERNAL_PAGE_TYPE::MoveHalfTo(
+    BPlusTreeCompressedInternalPage *recipient) {
+  assert(recipient != nullptr && recipient->GetSize() == 0);
+  int total = this->GetSize();
+  int copyIdx = total / 2;
+  KeyType middle_key = this->KeyAt(copyIdx);
+  bool fits = recipient->Assign(this->Entries(copyIdx, total));
+  assert(fits);
+  (void)fits;
+  this->SetSize(copyIdx);
+  this->Recompress();
+  return middle_key;
+}
+
+INDEX_TEMPLATE_ARGUMENTS
+void B_PLUS_TREE_COMPRESSED_INTERNAL_PAGE_TYPE::AdoptChildren(
+    int begin, int end, page_id_t parent_id,
+    BufferPoolManager *buffer_pool_manager) {
+  for (int i = begin; i < end; i++) {
+    page_id_t child_id = this->ValueAt(i);
+    Page *page = buffer_pool_manager->FetchPage(child_id);
+    if (page == nullptr)
+      throw Exception(EXCEPTION_TYPE_INDEX, "all page are pinned while moving children");
+    reinterpret_cast<BPlusTreePage *>(page->GetData())->SetParentPageId(parent_id);
+    buffer_pool_manager->UnpinPage(child_id, true);
+  }
+}
+
+/*****************************************************************************
+ * REMOVE
+ *****************************************************************************/
+
+INDEX_TEMPLATE_ARGUMENTS
+void B_PLUS_TREE_COMPRESSED_INTERNAL_PAGE_TYPE::Remove(int index) {
+  this->RemoveAt(index);
+}
+
+INDEX_TEMPLATE_ARGUMENTS
+ValueType B_PLUS_TREE_COMPRESSED_INTERNAL_PAGE_TYPE::RemoveAndReturnOnlyChild() {
+  assert(this->GetSize() == 1);
+  ValueType ret = this->ValueAt(0);
+  this->RemoveAt(0);
+  return ret;
+}
+
+/*****************************************************************************
+ * MERGE
+ *****************************************************************************/
+
+/*
+ * Append all children to recipient, the left sibling, with the separator
+ * from the parent as the key of the first one. False, with both pages
+ * unchanged, if the keys do not fit in recipient.
+ */
+INDEX_TEMPLATE_ARGUMENTS
+bool B_PLUS_TREE_COMPRESSED_INTERNAL_PAGE_TYPE::MoveAllTo(
+    BPlusTreeCompressedInternalPage *recipient, int index_in_parent,
+    BufferPoolManager *buffer_pool_manager) {
+  assert(recipient != nullptr);
+  Page *page = buffer_pool_manager->FetchPage(this->GetParentPageId());
+  if (page == nullptr)
+    throw Exception(EXCEPTION_TYPE_INDEX, "all page are pinned while merging");
+  auto *parent = reinterpret_cast<BPlusTreeCompressedInternalPage *>(page->GetData());
+  KeyType middle_key = parent->KeyAt(index_in_parent);
+  buffer_pool_manager->UnpinPage(parent->GetPageId(), false);
+
+  int start = recipient->GetSize();
+  if (!MoveAllTo(recipient, middle_key)) {
+    return false;
+  }
+  recipient->AdoptChildren(start, recipient->GetSize(), recipient->GetPageId(),
+                           buffer_pool_manager);
+  return true;
+}
+
+INDEX_TEMPLATE_ARGUMENTS
+bool B_PLUS_TREE_COMPRESSED_INTERNAL_PAGE_TYPE::MoveAllTo(
+    BPlusTreeCompressedInternalPage *recipient, const KeyType &middle_key) {
+  assert(recipient != nullptr);
+  std::vector<MappingType> items = recipient->Entries(0, recipient->GetSize());
+  std::vector<MappingType> mine = this->Entries(0, this->GetSize());
+  mine[0].first = middle_key;
+  items.insert(items.end(), mine.begin(), mine.end());
+  if (!recipient->Assign(items)) {
+    return false;
+  }
+  this->SetSize(0);
+  return true;
+}
+
+/*****************************************************************************
+ * REDISTRIBUTE
+ *****************************************************************************/
+
+INDEX_TEMPLATE_ARGUMENTS
+bool B_PLUS_TREE_COMPRESSED_INTERNAL_PAGE_TYPE::MoveFirstToEndOf(
+    BPlusTreeCompressedInternalPage *recipient,
+    BufferPoolManager *buffer_pool_manager) {
+  return MoveFirstToEndOf(recipient, -1, buffer_pool_manager);
+}
+
+INDEX_TEMPLATE_ARGUMENTS
+bool B_PLUS_TREE_COMPRESSED_INTERNAL_PAGE_TYPE::MoveFirstToEndOf(
+    BPlusTreeCompressedInternalPage *recipient, int index_in_parent,
+    BufferPoolManager *buffer_pool_manager) {
+  Page *page = buffer_pool_manager->FetchPage(this->GetParentPageId());
+  if (page == nullptr)
+    throw Exception(EXCEPTION_TYPE_INDEX, "all page are pinned while redistributing");
+  auto *parent = reinterpret_cast<BPlusTreeCompressedInternalPage *>(page->GetData());
+  bool moved = MoveFirstToEndOf(recipient, parent,
+                                parent->ValueIndex(this->GetPageId(), index_in_parent));
+  buffer_pool_manager->UnpinPage(parent->GetPageId(), moved);
+  if (moved) {
+    recipient->AdoptChildren(recipient->GetSize() - 1, recipient->GetSize(),
+                             recipient->GetPageId(), buffer_pool_manager);
+  }
+  return moved;
+}
+
+/*
+ * The separator comes down with the first child and the next key goes up,
+ * as in BPlusTreeInternalPage. The parent is checked first, with the
+ * encoding widened for the new separator; after that only recipient can
+ * refuse, before anything has changed.
+ */
+INDEX_TEMPLATE_ARGUMENTS
+bool B_PLUS_TREE_COMPRESSED_INTERNAL_PAGE_TYPE::MoveFirstToEndOf(
+    BPlusTreeCompressedInternalPage *recipient,
+    BPlusTreeCompressedInternalPage *parent, int index_in_parent) {
+  assert(recipient != nullptr && this->GetSize() > 1);
+  KeyType separator = this->KeyAt(1);
+  if (parent->GetSize() > parent->MaxEntriesWith(separator)) {
+    return false;
+  }
+  std::vector<MappingType> items = recipient->Entries(0, recipient->GetSize());
+  items.emplace_back(parent->KeyAt(index_in_parent), this->ValueAt(0));
+  if (!recipient->Assign(items)) {
+    return false;
+  }
+  this->RemoveAt(0);
+  bool fits = parent->SetKeyAt(index_in_parent, separator);
+  assert(fits);
+  (void)fits;
+  return true;
+}
+
+INDEX_TEMPLATE_ARGUMENTS
+bool B_PLUS_TREE_COMPRESSED_INTERNAL_PAGE_TYPE::MoveLastToFrontOf(
+    BPlusTreeCompressedInternalPage *recipient, int parent_index,
+    BufferPoolManager *buffer_pool_manager) {
+  Page *page = buffer_pool_manager->FetchPage(recipient->GetParentPageId());
+  if (page == nullptr)
+    throw Exception(EXCEPTION_TYPE_INDEX, "all page are pinned while redistributing");
+  auto *parent = reinterpret_cast<BPlusTreeCompressedInternalPage *>(page->GetData());
+  bool moved = MoveLastToFrontOf(recipient, parent, parent_index);
+  buffer_pool_manager->UnpinPage(parent->GetPageId(), moved);
+  if (moved) {
+    recipient->AdoptChildren(0, 1, recipient->GetPageId(), buffer_pool_manager);
+  }
+  return moved;
+}
+
+INDEX_TEMPLATE_ARGUMENTS
+bool B_PLUS_TREE_COMPRESSED_INTERNAL_PAGE_TYPE::MoveLastToFrontOf(
+    BPlusTreeCompressedInternalPage *recipient,
+    BPlusTreeCompressedInternalPage *parent, int parent_index) {
+  assert(recipient != nullptr && this->GetSize() > 1);
+  int last = this->GetSize() - 1;
+  KeyType separator = this->KeyAt(last);
+  if (parent->GetSize() > parent->MaxEntriesWith(separator)) {
+    return false;
+  }
+  std::vector<MappingType> items{{separator, this->ValueAt(last)}};
+  std::vector<MappingType> theirs = recipient->Entries(0, recipient->GetSize());
+  // the separator goes down to the recipient's former first child
+  theirs[0].first = parent->KeyAt(parent_index);
+  items.insert(items.end(), theirs.begin(), theirs.end());
+  if (!recipient->Assign(items)) {
+    return false;
+  }
+  this->RemoveAt(last);
+  bool fits = parent->SetKeyAt(parent_index, separator);
+  assert(fits);
+  (void)fits;
+  return true;
+}
+
+template class BPlusTreeCompressedInternalPage<GenericKey<4>, page_id_t, GenericComparator<4>>;
+template class BPlusTreeCompressedInternalPage<GenericKey<8>, page_id_t, GenericComparator<8>>;
+template class BPlusTreeCompressedInternalPage<GenericKey<16>, page_id_t, GenericComparator<16>>;
+template class BPlusTreeCompressedInternalPage<GenericKey<32>, page_id_t, GenericComparator<32>>;
+template class BPlusTreeCompressedInternalPage<GenericKey<64>, page_id_t, GenericComparator<64>>;
+template class BPlusTreeCompressedInternalPage<NormalizedKey<4>, page_id_t, NormalizedComparator<4>>;
+template class BPlusTreeCompressedInternalPage<NormalizedKey<8>, page_id_t, NormalizedComparator<8>>;
+template class BPlusTreeCompressedInternalPage<NormalizedKey<16>, page_id_t, NormalizedComparator<16>>;
+template class BPlusTreeCompressedInternalPage<NormalizedKey<32>, page_id_t, NormalizedComparator<32>>;
+template class BPlusTreeCompressedInternalPage<NormalizedKey<64>, page_id_t, NormalizedComparator<64>>;
+
+} // namespace scudb
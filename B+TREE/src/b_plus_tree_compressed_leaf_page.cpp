@@ -0,0 +1,230 @@
+/**
+ * b_plus_tree_compressed_leaf_page.cpp
+ */
+#include "common/exception.h"
+#include "common/rid.h"
+#include "page/b_plus_tree_compressed_internal_page.h"
+#include "page/b_plus_tree_compressed_leaf_page.h"
+
+namespace scudb {
+
+/*****************************************************************************
+ * HELPER METHODS AND UTILITIES
+ *****************************************************************************/
+
+INDEX_TEMPLATE_ARGUMENTS
+void B_PLUS_TREE_COMPRESSED_LEAF_PAGE_TYPE::Init(page_id_t page_id,
+                                                 page_id_t parent_id) {
+  this->SetPageType(IndexPageType::LEAF_PAGE);
+  this->SetSize(0);
+  this->SetPageId(page_id);
+  this->SetParentPageId(parent_id);
+  this->ResetVersion();
+  this->InitCompression();
+}
+
+INDEX_TEMPLATE_ARGUMENTS
+int B_PLUS_TREE_COMPRESSED_LEAF_PAGE_TYPE::KeyIndex(
+    const KeyType &key, const KeyComparator &comparator) const {
+  int st = 0, ed = this->GetSize() - 1;
+  while (st <= ed) { //find the first key in array >= input
+    int mid = (ed - st) / 2 + st;
+    if (comparator(this->KeyAt(mid), key) >= 0) ed = mid - 1;
+    else st = mid + 1;
+  }
+  return ed + 1;
+}
+
+INDEX_TEMPLATE_ARGUMENTS
+bool B_PLUS_TREE_COMPRESSED_LEAF_PAGE_TYPE::IsSafeToInsert(const KeyType &key) {
+  return this->GetSize() + 1 < this->MaxEntriesWith(key);
+}
+
+/*****************************************************************************
+ * INSERTION
+ *****************************************************************************/
+
+INDEX_TEMPLATE_ARGUMENTS
+int B_PLUS_TREE_COMPRESSED_LEAF_PAGE_TYPE::Insert(const KeyType &key,
+                                                  const ValueType &value,
+                                                  const KeyComparator &comparator) {
+  if (!this->Admit(key, 1)) {
+    return -1;
+  }
+  this->InsertAt(KeyIndex(key, comparator), key, value);
+  return this->GetSize();
+}
+
+/*
+ * Like BPlusTreeLeafPage::MoveHalfTo, but without the size precondition, as
+ * compressed pages can also be split before they are full. The keys of each
+ * half have at least as much in common as before, so both halves fit.
+ */
+INDEX_TEMPLATE_ARGUMENTS
+void B_PLUS_TREE_COMPRESSED_LEAF_PAGE_TYPE::MoveHalfTo(
+    BPlusTreeCompressedLeafPage *recipient,
+    __attribute__((unused)) BufferPoolManager *buffer_pool_manager) {
+  assert(recipient != nullptr && recipient->GetSize() == 0);
+  int total = this->GetSize();
+  int copyIdx = total / 2;
+  bool fits = recipient->Assign(this->Entries(copyIdx, total));
+  assert(fits);
+  (void)fits;
+  this->SetSize(copyIdx);
+  this->Recompress();
+  recipient->SetNextPageId(GetNextPageId());
+  SetNextPageId(recipient->GetPageId());
+}
+
+/*****************************************************************************
+ * LOOKUP
+ *****************************************************************************/
+
+INDEX_TEMPLATE_ARGUMENTS
+bool B_PLUS_TREE_COMPRESSED_LEAF_PAGE_TYPE::Lookup(
+    const KeyType &key, ValueType &value, const KeyComparator &comparator) const {
+  int idx = KeyIndex(key, comparator);
+  if (idx < this->GetSize() && comparator(this->KeyAt(idx), key) == 0) {
+    value = this->ValueAt(idx);
+    return true;
+  }
+  return false;
+}
+
+/*****************************************************************************
+ * REMOVE
+ *****************************************************************************/
+
+// the encoding stays as wide as it is; it only narrows on a split
+INDEX_TEMPLATE_ARGUMENTS
+int B_PLUS_TREE_COMPRESSED_LEAF_PAGE_TYPE::RemoveAndDeleteRecord(
+    const KeyType &key, const KeyComparator &comparator) {
+  int idx = KeyIndex(key, comparator);
+  if (idx < this->GetSize() && comparator(this->KeyAt(idx), key) == 0) {
+    this->RemoveAt(idx);
+  }
+  return this->GetSize();
+}
+
+/*****************************************************************************
+ * MERGE
+ *****************************************************************************/
+
+INDEX_TEMPLATE_ARGUMENTS
+bool B_PLUS_TREE_COMPRESSED_LEAF_PAGE_TYPE::MoveAllTo(
+    BPlusTreeCompressedLeafPage *recipient, int, BufferPoolManager *) {
+  assert(recipient != nullptr);
+  std::vector<MappingType> items = recipient->Entries(0, recipient->GetSize());
+  std::vector<MappingType> mine = this->Entries(0, this->GetSize());
+  items.insert(items.end(), mine.begin(), mine.end());
+  if (!recipient->Assign(items)) {
+    return false;
+  }
+  recipient->SetNextPageId(GetNextPageId());
+  this->SetSize(0);
+  return true;
+}
+
+/*****************************************************************************
+ * REDISTRIBUTE
+ *****************************************************************************/
+
+INDEX_TEMPLATE_ARGUMENTS
+bool B_PLUS_TREE_COMPRESSED_LEAF_PAGE_TYPE::MoveFirstToEndOf(
+    BPlusTreeCompressedLeafPage *recipient,
+    BufferPoolManager *buffer_pool_manager) {
+  return MoveFirstToEndOf(recipient, -1, buffer_pool_manager);
+}
+
+INDEX_TEMPLATE_ARGUMENTS
+bool B_PLUS_TREE_COMPRESSED_LEAF_PAGE_TYPE::MoveFirstToEndOf(
+    BPlusTreeCompressedLeafPage *recipient, int index_in_parent,
+    BufferPoolManager *buffer_pool_manager) {
+  Page *page = buffer_pool_manager->FetchPage(this->GetParentPageId());
+  if (page == nullptr)
+    throw Exception(EXCEPTION_TYPE_INDEX, "all page are pinned while redistributing");
+  auto *parent = reinterpret_cast<
+      BPlusTreeCompressedInternalPage<KeyType, page_id_t, KeyComparator> *>(page->GetData());
+  bool moved = MoveFirstToEndOf(recipient, parent,
+                                parent->ValueIndex(this->GetPageId(), index_in_parent));
+  buffer_pool_manager->UnpinPage(parent->GetPageId(), moved);
+  return moved;
+}
+
+/*
+ * The parent is checked first, with the encoding widened for the new
+ * separator, which is at least as wide as the one SetKeyAt picks; after
+ * that only recipient can refuse, before anything has changed.
+ */
+INDEX_TEMPLATE_ARGUMENTS
+bool B_PLUS_TREE_COMPRESSED_LEAF_PAGE_TYPE::MoveFirstToEndOf(
+    BPlusTreeCompressedLeafPage *recipient,
+    BPlusTreeCompressedInternalPage<KeyType, page_id_t, KeyComparator> *parent,
+    int index_in_parent) {
+  assert(recipient != nullptr && this->GetSize() > 1);
+  KeyType separator = this->KeyAt(1);
+  if (parent->GetSize() > parent->MaxEntriesWith(separator)) {
+    return false;
+  }
+  std::vector<MappingType> items = recipient->Entries(0, recipient->GetSize());
+  items.emplace_back(this->KeyAt(0), this->ValueAt(0));
+  if (!recipient->Assign(items)) {
+    return false;
+  }
+  this->RemoveAt(0);
+  bool fits = parent->SetKeyAt(index_in_parent, separator);
+  assert(fits);
+  (void)fits;
+  return true;
+}
+
+INDEX_TEMPLATE_ARGUMENTS
+bool B_PLUS_TREE_COMPRESSED_LEAF_PAGE_TYPE::MoveLastToFrontOf(
+    BPlusTreeCompressedLeafPage *recipient, int parentIndex,
+    BufferPoolManager *buffer_pool_manager) {
+  Page *page = buffer_pool_manager->FetchPage(recipient->GetParentPageId());
+  if (page == nullptr)
+    throw Exception(EXCEPTION_TYPE_INDEX, "all page are pinned while redistributing");
+  auto *parent = reinterpret_cast<
+      BPlusTreeCompressedInternalPage<KeyType, page_id_t, KeyComparator> *>(page->GetData());
+  bool moved = MoveLastToFrontOf(recipient, parent, parentIndex);
+  buffer_pool_manager->UnpinPage(parent->GetPageId(), moved);
+  return moved;
+}
+
+INDEX_TEMPLATE_ARGUMENTS
+bool B_PLUS_TREE_COMPRESSED_LEAF_PAGE_TYPE::MoveLastToFrontOf(
+    BPlusTreeCompressedLeafPage *recipient,
+    BPlusTreeCompressedInternalPage<KeyType, page_id_t, KeyComparator> *parent,
+    int parentIndex) {
+  assert(recipient != nullptr && this->GetSize() > 1);
+  int last = this->GetSize() - 1;
+  KeyType separator = this->KeyAt(last);
+  if (parent->GetSize() > parent->MaxEntriesWith(separator)) {
+    return false;
+  }
+  std::vector<MappingType> items{{separator, this->ValueAt(last)}};
+  std::vector<MappingType> theirs = recipient->Entries(0, recipient->GetSize());
+  items.insert(items.end(), theirs.begin(), theirs.end());
+  if (!recipient->Assign(items)) {
+    return false;
+  }
+  this->RemoveAt(last);
+  bool fits = parent->SetKeyAt(parentIndex, separator);
+  assert(fits);
+  (void)fits;
+  return true;
+}
+
+template class BPlusTreeCompressedLeafPage<GenericKey<4>, RID, GenericComparator<4>>;
+template class BPlusTreeCompressedLeafPage<GenericKey<8>, RID, GenericComparator<8>>;
+template class BPlusTreeCompressedLeafPage<GenericKey<16>, RID, GenericComparator<16>>;
+template class BPlusTreeCompressedLeafPage<GenericKey<32>, RID, GenericComparator<32>>;
+template class BPlusTreeCompressedLeafPage<GenericKey<64>, RID, GenericComparator<64>>;
+template class BPlusTreeCompressedLeafPage<NormalizedKey<4>, RID, NormalizedComparator<4>>;
+template class BPlusTreeCompressedLeafPage<NormalizedKey<8>, RID, NormalizedComparator<8>>;
+template class BPlusTreeCompressedLeafPage<NormalizedKey<16>, RID, NormalizedComparator<16>>;
+template class BPlusTreeCompressedLeafPage<NormalizedKey<32>, RID, NormalizedComparator<32>>;
+template class BPlusTreeCompressedLeafPage<NormalizedKey<64>, RID, NormalizedComparator<64>>;
+
+} // namespace scudb
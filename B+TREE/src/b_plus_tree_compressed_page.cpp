@@ -0,0 +1,274 @@
+/**
+ * b_plus_tree_compressed_page.cpp
+ */
+#include <algorithm>
+#include <cstring>
+
+#include "common/rid.h"
+#include "page/b_plus_tree_compressed_page.h"
+
+namespace scudb {
+
+namespace {
+int CommonPrefix(const char *a, const char *b, int size) {
+  int i = 0;
+  while (i < size && a[i] == b[i]) i++;
+  return i;
+}
+
+int TrailingZeros(const char *a, int size) {
+  int i = 0;
+  while (i < size && a[size - 1 - i] == 0) i++;
+  return i;
+}
+} // namespace
+
+/*****************************************************************************
+ * HELPER METHODS AND UTILITIES
+ *****************************************************************************/
+
+// an empty page admits its first key as a whole prefix, see Admit
+INDEX_TEMPLATE_ARGUMENTS
+void B_PLUS_TREE_COMPRESSED_PAGE_TYPE::InitCompression() {
+  next_page_id_ = INVALID_PAGE_ID;
+  prefix_size_ = sizeof(KeyType);
+  suffix_zeros_ = 0;
+  memset(&template_, 0, sizeof(KeyType));
+  UpdateMaxSize();
+}
+
+INDEX_TEMPLATE_ARGUMENTS
+int B_PLUS_TREE_COMPRESSED_PAGE_TYPE::EntrySize() const {
+  return static_cast<int>(sizeof(KeyType) + sizeof(ValueType)) - prefix_size_ -
+         suffix_zeros_;
+}
+
+INDEX_TEMPLATE_ARGUMENTS
+int B_PLUS_TREE_COMPRESSED_PAGE_TYPE::MaxEntries(int prefix_size,
+                                                 int suffix_zeros) const {
+  int entry_size = static_cast<int>(sizeof(KeyType) + sizeof(ValueType)) -
+                   prefix_size - suffix_zeros;
+  return static_cast<int>((PAGE_SIZE - sizeof(BPlusTreeCompressedPage)) / entry_size);
+}
+
+//minus 1 for insert first then split, as in the uncompressed pages
+INDEX_TEMPLATE_ARGUMENTS
+void B_PLUS_TREE_COMPRESSED_PAGE_TYPE::UpdateMaxSize() {
+  SetMaxSize(MaxEntries(prefix_size_, suffix_zeros_) - 1);
+}
+
+INDEX_TEMPLATE_ARGUMENTS
+KeyType B_PLUS_TREE_COMPRESSED_PAGE_TYPE::KeyAt(int index) const {
+  assert(index >= 0 && index < GetSize());
+  KeyType key = template_;
+  memcpy(reinterpret_cast<char *>(&key) + prefix_size_, EntryAt(index),
+         sizeof(KeyType) - prefix_size_ - suffix_zeros_);
+  return key;
+}
+
+INDEX_TEMPLATE_ARGUMENTS
+ValueType B_PLUS_TREE_COMPRESSED_PAGE_TYPE::ValueAt(int index) const {
+  assert(index >= 0 && index < GetSize());
+  ValueType value;
+  memcpy(&value, EntryAt(index) + sizeof(KeyType) - prefix_size_ - suffix_zeros_,
+         sizeof(ValueType));
+  return value;
+}
+
+INDEX_TEMPLATE_ARGUMENTS
+void B_PLUS_TREE_COMPRESSED_PAGE_TYPE::SetValueAt(int index,
+                                                  const ValueType &value) {
+  assert(index >= 0 && index < GetSize());
+  memcpy(EntryAt(index) + sizeof(KeyType) - prefix_size_ - suffix_zeros_, &value,
+         sizeof(ValueType));
+}
+
+INDEX_TEMPLATE_ARGUMENTS
+void B_PLUS_TREE_COMPRESSED_PAGE_TYPE::Encode(char *entry, const KeyType &key,
+                                              const ValueType &value) const {
+  int middle = static_cast<int>(sizeof(KeyType)) - prefix_size_ - suffix_zeros_;
+  memcpy(entry, reinterpret_cast<const char *>(&key) + prefix_size_, middle);
+  memcpy(entry + middle, &value, sizeof(ValueType));
+}
+
+/*
+ * Truncate right to its first len bytes for growing len, until the result is
+ * still above left. Checked with the comparator, so any key format works;
+ * formats that do not order by bytes just get longer separators.
+ */
+INDEX_TEMPLATE_ARGUMENTS
+KeyType B_PLUS_TREE_COMPRESSED_PAGE_TYPE::ShortestSeparator(
+    const KeyType &left, const KeyType &right, const KeyComparator &comparator) {
+  assert(comparator(left, right) < 0);
+  KeyType separator;
+  memset(&separator, 0, sizeof(KeyType));
+  for (size_t len = 1; len < sizeof(KeyType); len++) {
+    reinterpret_cast<char *>(&separator)[len - 1] =
+        reinterpret_cast<const char *>(&right)[len - 1];
+    if (comparator(left, separator) < 0 && comparator(separator, right) <= 0) {
+      return separator;
+    }
+  }
+  return right;
+}
+
+/*****************************************************************************
+ * ENCODING
+ *****************************************************************************/
+
+// the encoding that also covers key; a page without keys takes the whole
+// key as its prefix
+INDEX_TEMPLATE_ARGUMENTS
+void B_PLUS_TREE_COMPRESSED_PAGE_TYPE::WidenFor(const KeyType &key,
+                                                int &prefix_size,
+                                                int &suffix_zeros) const {
+  const char *bytes = reinterpret_cast<const char *>(&key);
+  const int key_size = static_cast<int>(sizeof(KeyType));
+  if (GetSize() <= FirstKeyIndex()) {
+    prefix_size = key_size;
+    suffix_zeros = 0;
+    return;
+  }
+  prefix_size = CommonPrefix(reinterpret_cast<const char *>(&template_), bytes,
+                             prefix_size_);
+  suffix_zeros = std::min<int>(suffix_zeros_, TrailingZeros(bytes, key_size));
+  suffix_zeros = std::min(suffix_zeros, key_size - prefix_size);
+}
+
+INDEX_TEMPLATE_ARGUMENTS
+int B_PLUS_TREE_COMPRESSED_PAGE_TYPE::MaxEntriesWith(const KeyType &key) const {
+  int prefix_size, suffix_zeros;
+  WidenFor(key, prefix_size, suffix_zeros);
+  return MaxEntries(prefix_size, suffix_zeros);
+}
+
+INDEX_TEMPLATE_ARGUMENTS
+bool B_PLUS_TREE_COMPRESSED_PAGE_TYPE::Admit(const KeyType &key, int extra) {
+  int prefix_size, suffix_zeros;
+  WidenFor(key, prefix_size, suffix_zeros);
+  if (GetSize() + extra > MaxEntries(prefix_size, suffix_zeros)) {
+    return false;
+  }
+  bool empty = GetSize() <= FirstKeyIndex();
+  if (empty || prefix_size != prefix_size_ || suffix_zeros != suffix_zeros_) {
+    if (empty) {
+      template_ = key;
+    }
+    Reencode(prefix_size, suffix_zeros);
+  }
+  return true;
+}
+
+/*
+ * Rewrite every entry for a new prefix size and zero tail. template_ must
+ * already hold the new prefix; when the encoding widens, the bytes between
+ * the new and the old prefix come from the old prefix, and the bytes between
+ * the old and the new zero tail are zeros.
+ */
+INDEX_TEMPLATE_ARGUMENTS
+void B_PLUS_TREE_COMPRESSED_PAGE_TYPE::Reencode(int prefix_size,
+                                                int suffix_zeros) {
+  std::vector<MappingType> items = Entries(0, GetSize());
+  prefix_size_ = static_cast<uint16_t>(prefix_size);
+  suffix_zeros_ = static_cast<uint16_t>(suffix_zeros);
+  for (int i = 0; i < static_cast<int>(items.size()); i++) {
+    Encode(EntryAt(i), items[i].first, items[i].second);
+  }
+  UpdateMaxSize();
+}
+
+INDEX_TEMPLATE_ARGUMENTS
+std::vector<MappingType> B_PLUS_TREE_COMPRESSED_PAGE_TYPE::Entries(int begin,
+                                                                   int end) const {
+  std::vector<MappingType> items;
+  items.reserve(end - begin);
+  for (int i = begin; i < end; i++) {
+    items.emplace_back(KeyAt(i), ValueAt(i));
+  }
+  return items;
+}
+
+INDEX_TEMPLATE_ARGUMENTS
+bool B_PLUS_TREE_COMPRESSED_PAGE_TYPE::Assign(
+    const std::vector<MappingType> &items) {
+  const int key_size = static_cast<int>(sizeof(KeyType));
+  int first = FirstKeyIndex();
+  int prefix_size = key_size, suffix_zeros = 0;
+  if (static_cast<int>(items.size()) > first) {
+    const char *base = reinterpret_cast<const char *>(&items[first].first);
+    suffix_zeros = key_size;
+    for (int i = first; i < static_cast<int>(items.size()); i++) {
+      const char *bytes = reinterpret_cast<const char *>(&items[i].first);
+      prefix_size = std::min(prefix_size, CommonPrefix(base, bytes, prefix_size));
+      suffix_zeros = std::min(suffix_zeros, TrailingZeros(bytes, key_size));
+    }
+    suffix_zeros = std::min(suffix_zeros, key_size - prefix_size);
+  }
+  if (static_cast<int>(items.size()) > MaxEntries(prefix_size, suffix_zeros)) {
+    return false;
+  }
+  if (static_cast<int>(items.size()) > first) {
+    template_ = items[first].first;
+  }
+  prefix_size_ = static_cast<uint16_t>(prefix_size);
+  suffix_zeros_ = static_cast<uint16_t>(suffix_zeros);
+  for (int i = 0; i < static_cast<int>(items.size()); i++) {
+    Encode(EntryAt(i), items[i].first, items[i].second);
+  }
+  SetSize(static_cast<int>(items.size()));
+  UpdateMaxSize();
+  return true;
+}
+
+INDEX_TEMPLATE_ARGUMENTS
+void B_PLUS_TREE_COMPRESSED_PAGE_TYPE::Recompress() {
+  bool fits = Assign(Entries(0, GetSize()));
+  assert(fits);
+  (void)fits;
+}
+
+/*****************************************************************************
+ * INSERTION AND REMOVAL
+ *****************************************************************************/
+
+INDEX_TEMPLATE_ARGUMENTS
+void B_PLUS_TREE_COMPRESSED_PAGE_TYPE::InsertAt(int index, const KeyType &key,
+                                                const ValueType &value) {
+  assert(index >= 0 && index <= GetSize());
+  assert(GetSize() < MaxEntries(prefix_size_, suffix_zeros_));
+  memmove(EntryAt(index + 1), EntryAt(index),
+          static_cast<size_t>((GetSize() - index) * EntrySize()));
+  Encode(EntryAt(index), key, value);
+  IncreaseSize(1);
+}
+
+INDEX_TEMPLATE_ARGUMENTS
+void B_PLUS_TREE_COMPRESSED_PAGE_TYPE::RemoveAt(int index) {
+  assert(index >= 0 && index < GetSize());
+  memmove(EntryAt(index), EntryAt(index + 1),
+          static_cast<size_t>((GetSize() - index - 1) * EntrySize()));
+  IncreaseSize(-1);
+}
+
+template class BPlusTreeCompressedPage<GenericKey<4>, RID, GenericComparator<4>>;
+template class BPlusTreeCompressedPage<GenericKey<8>, RID, GenericComparator<8>>;
+template class BPlusTreeCompressedPage<GenericKey<16>, RID, GenericComparator<16>>;
+template class BPlusTreeCompressedPage<GenericKey<32>, RID, GenericComparator<32>>;
+template class BPlusTreeCompressedPage<GenericKey<64>, RID, GenericComparator<64>>;
+template class BPlusTreeCompressedPage<GenericKey<4>, page_id_t, GenericComparator<4>>;
+template class BPlusTreeCompressedPage<GenericKey<8>, page_id_t, GenericComparator<8>>;
+template class BPlusTreeCompressedPage<GenericKey<16>, page_id_t, GenericComparator<16>>;
+template class BPlusTreeCompressedPage<GenericKey<32>, page_id_t, GenericComparator<32>>;
+template class BPlusTreeCompressedPage<GenericKey<64>, page_id_t, GenericComparator<64>>;
+template class BPlusTreeCompressedPage<NormalizedKey<4>, RID, NormalizedComparator<4>>;
+template class BPlusTreeCompressedPage<NormalizedKey<8>, RID, NormalizedComparator<8>>;
+template class BPlusTreeCompressedPage<NormalizedKey<16>, RID, NormalizedComparator<16>>;
+template class BPlusTreeCompressedPage<NormalizedKey<32>, RID, NormalizedComparator<32>>;
+template class BPlusTreeCompressedPage<NormalizedKey<64>, RID, NormalizedComparator<64>>;
+template class BPlusTreeCompressedPage<NormalizedKey<4>, page_id_t, NormalizedComparator<4>>;
+template class BPlusTreeCompressedPage<NormalizedKey<8>, page_id_t, NormalizedComparator<8>>;
+template class BPlusTreeCompressedPage<NormalizedKey<16>, page_id_t, NormalizedComparator<16>>;
+template class BPlusTreeCompressedPage<NormalizedKey<32>, page_id_t, NormalizedComparator<32>>;
+template class BPlusTreeCompressedPage<NormalizedKey<64>, page_id_t, NormalizedComparator<64>>;
+
+} // namespace scudb
@@ -19,6 +19,7 @@ void B_PLUS_TREE_INTERNAL_PAGE_TYPE::Init(page_id_t page_id,
   SetSize(0);
   SetPageId(page_id);
   SetParentPageId(parent_id);
+  ResetVersion();
   SetMaxSize((PAGE_SIZE- sizeof(BPlusTreeInternalPage))/sizeof(MappingType) - 1); //minus 1 for first invalid key
 }
 
@@ -47,6 +48,15 @@ int B_PLUS_TREE_INTERNAL_PAGE_TYPE::ValueIndex(const ValueType &value) const {
   return -1;
 }
 
+INDEX_TEMPLATE_ARGUMENTS
+int B_PLUS_TREE_INTERNAL_PAGE_TYPE::ValueIndex(const ValueType &value,
+                                               int hint) const {
+  if (hint >= 0 && hint < GetSize() && array[hint].second == value) {
+    return hint;
+  }
+  return ValueIndex(value);
+}
+
 
 INDEX_TEMPLATE_ARGUMENTS
 ValueType B_PLUS_TREE_INTERNAL_PAGE_TYPE::ValueAt(int index) const {
@@ -63,6 +73,12 @@ INDEX_TEMPLATE_ARGUMENTS
 ValueType
 B_PLUS_TREE_INTERNAL_PAGE_TYPE::Lookup(const KeyType &key,
                                        const KeyComparator &comparator) const {
+  return array[LookupIndex(key, comparator)].second;
+}
+
+INDEX_TEMPLATE_ARGUMENTS
+int B_PLUS_TREE_INTERNAL_PAGE_TYPE::LookupIndex(
+    const KeyType &key, const KeyComparator &comparator) const {
   assert(GetSize() > 1);
   int st = 1, ed = GetSize() - 1;
   while (st <= ed) { //find the last key in array <= input
@@ -70,7 +86,7 @@ B_PLUS_TREE_INTERNAL_PAGE_TYPE::Lookup(const KeyType &key,
     if (comparator(array[mid].first,key) <= 0) st = mid + 1;
     else ed = mid - 1;
   }
-  return array[st - 1].second;
+  return st - 1;
 }
 
 /*****************************************************************************
@@ -97,15 +113,29 @@ int B_PLUS_TREE_INTERNAL_PAGE_TYPE::InsertNodeAfter(
     const ValueType &new_value) {
   int idx = ValueIndex(old_value) + 1;
   assert(idx > 0);
+  return InsertNodeAt(idx, new_key, new_value);
+}
+
+INDEX_TEMPLATE_ARGUMENTS
+int B_PLUS_TREE_INTERNAL_PAGE_TYPE::InsertNodeAt(int idx, const KeyType &new_key,
+                                                 const ValueType &new_value) {
+  assert(idx > 0 && idx <= GetSize());
+  memmove(array + idx + 1, array + idx,
+          static_cast<size_t>((GetSize() - idx)*sizeof(MappingType)));
   IncreaseSize(1);
-  int curSize = GetSize();
-  for (int i = curSize - 1; i > idx; i--) {
-    array[i].first = array[i - 1].first;
-    array[i].second = array[i - 1].second;
-  }
   array[idx].first = new_key;
   array[idx].second = new_value;
-  return curSize;
+  return GetSize();
+}
+
+INDEX_TEMPLATE_ARGUMENTS
+int B_PLUS_TREE_INTERNAL_PAGE_TYPE::Append(const KeyType &key,
+                                           const ValueType &value) {
+  assert(GetSize() <= GetMaxSize());
+  array[GetSize()].first = key;
+  array[GetSize()].second = value;
+  IncreaseSize(1);
+  return GetSize();
 }
 
 /*****************************************************************************
@@ -116,20 +146,21 @@ INDEX_TEMPLATE_ARGUMENTS
 void B_PLUS_TREE_INTERNAL_PAGE_TYPE::MoveHalfTo(
     BPlusTreeInternalPage *recipient,
     BufferPoolManager *buffer_pool_manager) {
+  MoveHalfTo(recipient);
+  recipient->AdoptChildren(0, recipient->GetSize(), buffer_pool_manager);
+}
+
+INDEX_TEMPLATE_ARGUMENTS
+void B_PLUS_TREE_INTERNAL_PAGE_TYPE::MoveHalfTo(
+    BPlusTreeInternalPage *recipient) {
   assert(recipient != nullptr);
   int total = GetMaxSize() + 1;
   assert(GetSize() == total);
   //copy last half
   int copyIdx = (total)/2;//max:4 x,1,2,3,4 -> 2,3,4
-  page_id_t recipPageId = recipient->GetPageId();
   for (int i = copyIdx; i < total; i++) {
     recipient->array[i - copyIdx].first = array[i].first;
     recipient->array[i - copyIdx].second = array[i].second;
-    //update children's parent page
-    auto childRawPage = buffer_pool_manager->FetchPage(array[i].second);
-    BPlusTreePage *childTreePage = reinterpret_cast<BPlusTreePage *>(childRawPage->GetData());
-    childTreePage->SetParentPageId(recipPageId);
-    buffer_pool_manager->UnpinPage(array[i].second,true);
   }
   //set size,is odd, bigger is last part
   SetSize(copyIdx);
@@ -140,6 +171,20 @@ INDEX_TEMPLATE_ARGUMENTS
 void B_PLUS_TREE_INTERNAL_PAGE_TYPE::CopyHalfFrom(
     MappingType *items, int size, BufferPoolManager *buffer_pool_manager) {}
 
+//update children's parent page
+INDEX_TEMPLATE_ARGUMENTS
+void B_PLUS_TREE_INTERNAL_PAGE_TYPE::AdoptChildren(
+    int begin, int end, BufferPoolManager *buffer_pool_manager) {
+  for (int i = begin; i < end; i++) {
+    auto childRawPage = buffer_pool_manager->FetchPage(array[i].second);
+    if (childRawPage == nullptr)
+      throw Exception(EXCEPTION_TYPE_INDEX, "all page are pinned while moving children");
+    BPlusTreePage *childTreePage = reinterpret_cast<BPlusTreePage *>(childRawPage->GetData());
+    childTreePage->SetParentPageId(GetPageId());
+    buffer_pool_manager->UnpinPage(array[i].second,true);
+  }
+}
+
 /*****************************************************************************
  * REMOVE
  *****************************************************************************/
@@ -147,9 +192,8 @@ void B_PLUS_TREE_INTERNAL_PAGE_TYPE::CopyHalfFrom(
 INDEX_TEMPLATE_ARGUMENTS
 void B_PLUS_TREE_INTERNAL_PAGE_TYPE::Remove(int index) {
   assert(index >= 0 && index < GetSize());
-  for (int i = index + 1; i < GetSize(); i++) {
-    array[i - 1] = array[i];
-  }
+  memmove(array + index, array + index + 1,
+          static_cast<size_t>((GetSize() - index - 1)*sizeof(MappingType)));
   IncreaseSize(-1);
 }
 
@@ -169,26 +213,27 @@ INDEX_TEMPLATE_ARGUMENTS
 void B_PLUS_TREE_INTERNAL_PAGE_TYPE::MoveAllTo(
     BPlusTreeInternalPage *recipient, int index_in_parent,
     BufferPoolManager *buffer_pool_manager) {
-  int start = recipient->GetSize();
-  page_id_t recipPageId = recipient->GetPageId();
   // first find parent
   Page *page = buffer_pool_manager->FetchPage(GetParentPageId());
   assert(page != nullptr);
   BPlusTreeInternalPage *parent = reinterpret_cast<BPlusTreeInternalPage *>(page->GetData());
-
   // the separation key from parent
-  SetKeyAt(0, parent->KeyAt(index_in_parent));
+  KeyType middle_key = parent->KeyAt(index_in_parent);
   buffer_pool_manager->UnpinPage(parent->GetPageId(), false);
+  int start = recipient->GetSize();
+  MoveAllTo(recipient, middle_key);
+  recipient->AdoptChildren(start, recipient->GetSize(), buffer_pool_manager);
+}
+
+INDEX_TEMPLATE_ARGUMENTS
+void B_PLUS_TREE_INTERNAL_PAGE_TYPE::MoveAllTo(BPlusTreeInternalPage *recipient,
+                                               const KeyType &middle_key) {
+  int start = recipient->GetSize();
+  SetKeyAt(0, middle_key);
   for (int i = 0; i < GetSize(); ++i) {
     recipient->array[start + i].first = array[i].first;
     recipient->array[start + i].second = array[i].second;
-    //update children's parent page
-    auto childRawPage = buffer_pool_manager->FetchPage(array[i].second);
-    BPlusTreePage *childTreePage = reinterpret_cast<BPlusTreePage *>(childRawPage->GetData());
-    childTreePage->SetParentPageId(recipPageId);
-    buffer_pool_manager->UnpinPage(array[i].second,true);
   }
-  //update relavent key & value pair in its parent page.
   recipient->SetSize(start + GetSize());
   assert(recipient->GetSize() <= GetMaxSize());
   SetSize(0);
@@ -208,23 +253,34 @@ INDEX_TEMPLATE_ARGUMENTS
 void B_PLUS_TREE_INTERNAL_PAGE_TYPE::MoveFirstToEndOf(
     BPlusTreeInternalPage *recipient,
     BufferPoolManager *buffer_pool_manager) {
-  MappingType pair{KeyAt(0), ValueAt(0)};
+  MoveFirstToEndOf(recipient, -1, buffer_pool_manager);
+}
+
+INDEX_TEMPLATE_ARGUMENTS
+void B_PLUS_TREE_INTERNAL_PAGE_TYPE::MoveFirstToEndOf(
+    BPlusTreeInternalPage *recipient, int index_in_parent,
+    BufferPoolManager *buffer_pool_manager) {
+  Page *page = buffer_pool_manager->FetchPage(GetParentPageId());
+  B_PLUS_TREE_INTERNAL_PAGE *parent = reinterpret_cast<B_PLUS_TREE_INTERNAL_PAGE *>(page->GetData());
+  MoveFirstToEndOf(recipient, parent,
+                   parent->ValueIndex(GetPageId(), index_in_parent));
+  buffer_pool_manager->UnpinPage(parent->GetPageId(), true);
+  // update child parent page id
+  recipient->AdoptChildren(recipient->GetSize() - 1, recipient->GetSize(),
+                           buffer_pool_manager);
+}
+
+INDEX_TEMPLATE_ARGUMENTS
+void B_PLUS_TREE_INTERNAL_PAGE_TYPE::MoveFirstToEndOf(
+    BPlusTreeInternalPage *recipient, BPlusTreeInternalPage *parent,
+    int index_in_parent) {
+  // the separation key comes down with the first child
+  MappingType pair{parent->KeyAt(index_in_parent), ValueAt(0)};
   IncreaseSize(-1);
   memmove(array, array + 1, static_cast<size_t>(GetSize()*sizeof(MappingType)));
-  recipient->CopyLastFrom(pair, buffer_pool_manager);
-  // update child parent page id
-  page_id_t childPageId = pair.second;
-  Page *page = buffer_pool_manager->FetchPage(childPageId);
-  assert (page != nullptr);
-  BPlusTreePage *child = reinterpret_cast<BPlusTreePage *>(page->GetData());
-  child->SetParentPageId(recipient->GetPageId());
-  assert(child->GetParentPageId() == recipient->GetPageId());
-  buffer_pool_manager->UnpinPage(child->GetPageId(), true);
+  recipient->CopyLastFrom(pair, nullptr);
   //update relavent key & value pair in its parent page.
-  page = buffer_pool_manager->FetchPage(GetParentPageId());
-  B_PLUS_TREE_INTERNAL_PAGE *parent = reinterpret_cast<B_PLUS_TREE_INTERNAL_PAGE *>(page->GetData());
-  parent->SetKeyAt(parent->ValueIndex(GetPageId()), array[0].first);
-  buffer_pool_manager->UnpinPage(GetParentPageId(), true);
+  parent->SetKeyAt(index_in_parent, array[0].first);
 }
 
 INDEX_TEMPLATE_ARGUMENTS
@@ -240,32 +296,33 @@ INDEX_TEMPLATE_ARGUMENTS
 void B_PLUS_TREE_INTERNAL_PAGE_TYPE::MoveLastToFrontOf(
     BPlusTreeInternalPage *recipient, int parent_index,
     BufferPoolManager *buffer_pool_manager) {
+  Page *page = buffer_pool_manager->FetchPage(recipient->GetParentPageId());
+  B_PLUS_TREE_INTERNAL_PAGE *parent = reinterpret_cast<B_PLUS_TREE_INTERNAL_PAGE *>(page->GetData());
+  MoveLastToFrontOf(recipient, parent, parent_index);
+  buffer_pool_manager->UnpinPage(parent->GetPageId(), true);
+  // update child parent page id
+  recipient->AdoptChildren(0, 1, buffer_pool_manager);
+}
+
+INDEX_TEMPLATE_ARGUMENTS
+void B_PLUS_TREE_INTERNAL_PAGE_TYPE::MoveLastToFrontOf(
+    BPlusTreeInternalPage *recipient, BPlusTreeInternalPage *parent,
+    int parent_index) {
   MappingType pair {KeyAt(GetSize() - 1),ValueAt(GetSize() - 1)};
   IncreaseSize(-1);
-  recipient->CopyFirstFrom(pair, parent_index, buffer_pool_manager);
+  recipient->CopyFirstFrom(pair);
+  // the separation key goes down to the recipient's former first child
+  recipient->SetKeyAt(1, parent->KeyAt(parent_index));
+  //update relavent key & value pair in its parent page.
+  parent->SetKeyAt(parent_index, pair.first);
 }
 
 INDEX_TEMPLATE_ARGUMENTS
-void B_PLUS_TREE_INTERNAL_PAGE_TYPE::CopyFirstFrom(
-    const MappingType &pair, int parent_index,
-    BufferPoolManager *buffer_pool_manager) {
+void B_PLUS_TREE_INTERNAL_PAGE_TYPE::CopyFirstFrom(const MappingType &pair) {
   assert(GetSize() + 1 < GetMaxSize());
   memmove(array + 1, array, GetSize()*sizeof(MappingType));
   IncreaseSize(1);
   array[0] = pair;
-  // update child parent page id
-  page_id_t childPageId = pair.second;
-  Page *page = buffer_pool_manager->FetchPage(childPageId);
-  assert (page != nullptr);
-  BPlusTreePage *child = reinterpret_cast<BPlusTreePage *>(page->GetData());
-  child->SetParentPageId(GetPageId());
-  assert(child->GetParentPageId() == GetPageId());
-  buffer_pool_manager->UnpinPage(child->GetPageId(), true);
-  //update relavent key & value pair in its parent page.
-  page = buffer_pool_manager->FetchPage(GetParentPageId());
-  B_PLUS_TREE_INTERNAL_PAGE *parent = reinterpret_cast<B_PLUS_TREE_INTERNAL_PAGE *>(page->GetData());
-  parent->SetKeyAt(parent_index, array[0].first);
-  buffer_pool_manager->UnpinPage(GetParentPageId(), true);
 }
 
 /*****************************************************************************
@@ -326,4 +383,14 @@ template class BPlusTreeInternalPage<GenericKey<32>, page_id_t,
                                            GenericComparator<32>>;
 template class BPlusTreeInternalPage<GenericKey<64>, page_id_t,
                                            GenericComparator<64>>;
+template class BPlusTreeInternalPage<NormalizedKey<4>, page_id_t,
+                                              NormalizedComparator<4>>;
+template class BPlusTreeInternalPage<NormalizedKey<8>, page_id_t,
+                                              NormalizedComparator<8>>;
+template class BPlusTreeInternalPage<NormalizedKey<16>, page_id_t,
+                                              NormalizedComparator<16>>;
+template class BPlusTreeInternalPage<NormalizedKey<32>, page_id_t,
+                                              NormalizedComparator<32>>;
+template class BPlusTreeInternalPage<NormalizedKey<64>, page_id_t,
+                                              NormalizedComparator<64>>;
 } // namespace scudb
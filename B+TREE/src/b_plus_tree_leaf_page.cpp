@@ -20,9 +20,10 @@ INDEX_TEMPLATE_ARGUMENTS
 void B_PLUS_TREE_LEAF_PAGE_TYPE::Init(page_id_t page_id, page_id_t parent_id) {
   SetPageType(IndexPageType::LEAF_PAGE);
   SetSize(0);
-  assert(sizeof(BPlusTreeLeafPage) == 28);
+  assert(sizeof(BPlusTreeLeafPage) == 32);
   SetPageId(page_id);
   SetParentPageId(parent_id);
+  ResetVersion();
   SetNextPageId(INVALID_PAGE_ID);
   SetMaxSize((PAGE_SIZE - sizeof(BPlusTreeLeafPage))/sizeof(MappingType) - 1); //minus 1 for insert first then split
 }
@@ -73,15 +74,42 @@ int B_PLUS_TREE_LEAF_PAGE_TYPE::Insert(const KeyType &key,
                                        const KeyComparator &comparator) {
   int idx = KeyIndex(key,comparator); //first larger than key
   assert(idx >= 0);
+  memmove(array + idx + 1, array + idx,
+          static_cast<size_t>((GetSize() - idx)*sizeof(MappingType)));
   IncreaseSize(1);
-  int curSize = GetSize();
-  for (int i = curSize - 1; i > idx; i--) {
-    array[i].first = array[i - 1].first;
-    array[i].second = array[i - 1].second;
-  }
   array[idx].first = key;
   array[idx].second = value;
-  return curSize;
+  return GetSize();
+}
+
+/*
+ * Merge count items, sorted by key and none of them already in the page, in
+ * a single pass from the back: every entry is shifted at most once, straight
+ * to its final slot, instead of once per inserted key. Like Insert, the page
+ * may end up one over max size and then has to be split.
+ */
+INDEX_TEMPLATE_ARGUMENTS
+int B_PLUS_TREE_LEAF_PAGE_TYPE::InsertMany(const MappingType *items, int count,
+                                           const KeyComparator &comparator) {
+  assert(count >= 0 && GetSize() + count <= GetMaxSize() + 1);
+  int hi = GetSize(); // entries [0, hi) have not been moved yet
+  for (int j = count - 1; j >= 0; j--) {
+    assert(j == 0 || comparator(items[j - 1].first, items[j].first) < 0);
+    int st = 0, ed = hi - 1;
+    while (st <= ed) { //first key in array[0, hi) >= items[j]
+      int mid = (ed - st) / 2 + st;
+      if (comparator(array[mid].first, items[j].first) >= 0) ed = mid - 1;
+      else st = mid + 1;
+    }
+    assert(st == hi || comparator(array[st].first, items[j].first) != 0);
+    // entries after items[j] make room for it and the j items before it
+    memmove(array + st + j + 1, array + st,
+            static_cast<size_t>((hi - st)*sizeof(MappingType)));
+    array[st + j] = items[j];
+    hi = st;
+  }
+  IncreaseSize(count);
+  return GetSize();
 }
 
 
@@ -182,15 +210,30 @@ INDEX_TEMPLATE_ARGUMENTS
 void B_PLUS_TREE_LEAF_PAGE_TYPE::MoveFirstToEndOf(
     BPlusTreeLeafPage *recipient,
     BufferPoolManager *buffer_pool_manager) {
+  MoveFirstToEndOf(recipient, -1, buffer_pool_manager);
+}
+
+INDEX_TEMPLATE_ARGUMENTS
+void B_PLUS_TREE_LEAF_PAGE_TYPE::MoveFirstToEndOf(
+    BPlusTreeLeafPage *recipient, int index_in_parent,
+    BufferPoolManager *buffer_pool_manager) {
+  Page *page = buffer_pool_manager->FetchPage(GetParentPageId());
+  B_PLUS_TREE_INTERNAL_PAGE *parent = reinterpret_cast<B_PLUS_TREE_INTERNAL_PAGE *>(page->GetData());
+  MoveFirstToEndOf(recipient, parent,
+                   parent->ValueIndex(GetPageId(), index_in_parent));
+  buffer_pool_manager->UnpinPage(parent->GetPageId(), true);
+}
+
+INDEX_TEMPLATE_ARGUMENTS
+void B_PLUS_TREE_LEAF_PAGE_TYPE::MoveFirstToEndOf(
+    BPlusTreeLeafPage *recipient, B_PLUS_TREE_INTERNAL_PAGE *parent,
+    int index_in_parent) {
   MappingType pair = GetItem(0);
   IncreaseSize(-1);
   memmove(array, array + 1, static_cast<size_t>(GetSize()*sizeof(MappingType)));
   recipient->CopyLastFrom(pair);
   //update relavent key & value pair in its parent page.
-  Page *page = buffer_pool_manager->FetchPage(GetParentPageId());
-  B_PLUS_TREE_INTERNAL_PAGE *parent = reinterpret_cast<B_PLUS_TREE_INTERNAL_PAGE *>(page->GetData());
-  parent->SetKeyAt(parent->ValueIndex(GetPageId()), array[0].first);
-  buffer_pool_manager->UnpinPage(GetParentPageId(), true);
+  parent->SetKeyAt(index_in_parent, array[0].first);
 }
 
 INDEX_TEMPLATE_ARGUMENTS
@@ -205,24 +248,29 @@ INDEX_TEMPLATE_ARGUMENTS
 void B_PLUS_TREE_LEAF_PAGE_TYPE::MoveLastToFrontOf(
     BPlusTreeLeafPage *recipient, int parentIndex,
     BufferPoolManager *buffer_pool_manager) {
+  Page *page = buffer_pool_manager->FetchPage(recipient->GetParentPageId());
+  B_PLUS_TREE_INTERNAL_PAGE *parent = reinterpret_cast<B_PLUS_TREE_INTERNAL_PAGE *>(page->GetData());
+  MoveLastToFrontOf(recipient, parent, parentIndex);
+  buffer_pool_manager->UnpinPage(parent->GetPageId(), true);
+}
+
+INDEX_TEMPLATE_ARGUMENTS
+void B_PLUS_TREE_LEAF_PAGE_TYPE::MoveLastToFrontOf(
+    BPlusTreeLeafPage *recipient, B_PLUS_TREE_INTERNAL_PAGE *parent,
+    int parentIndex) {
   MappingType pair = GetItem(GetSize() - 1);
   IncreaseSize(-1);
-  recipient->CopyFirstFrom(pair, parentIndex, buffer_pool_manager);
+  recipient->CopyFirstFrom(pair);
+  //update relavent key & value pair in its parent page.
+  parent->SetKeyAt(parentIndex, pair.first);
 }
 
 INDEX_TEMPLATE_ARGUMENTS
-void B_PLUS_TREE_LEAF_PAGE_TYPE::CopyFirstFrom(
-    const MappingType &item, int parentIndex,
-    BufferPoolManager *buffer_pool_manager) {
+void B_PLUS_TREE_LEAF_PAGE_TYPE::CopyFirstFrom(const MappingType &item) {
   assert(GetSize() + 1 < GetMaxSize());
   memmove(array + 1, array, GetSize()*sizeof(MappingType));
   IncreaseSize(1);
   array[0] = item;
-
-  Page *page = buffer_pool_manager->FetchPage(GetParentPageId());
-  B_PLUS_TREE_INTERNAL_PAGE *parent = reinterpret_cast<B_PLUS_TREE_INTERNAL_PAGE *>(page->GetData());
-  parent->SetKeyAt(parentIndex, array[0].first);
-  buffer_pool_manager->UnpinPage(GetParentPageId(), true);
 }
 
 /*****************************************************************************
@@ -267,4 +315,14 @@ template class BPlusTreeLeafPage<GenericKey<32>, RID,
                                        GenericComparator<32>>;
 template class BPlusTreeLeafPage<GenericKey<64>, RID,
                                        GenericComparator<64>>;
+template class BPlusTreeLeafPage<NormalizedKey<4>, RID,
+                                          NormalizedComparator<4>>;
+template class BPlusTreeLeafPage<NormalizedKey<8>, RID,
+                                          NormalizedComparator<8>>;
+template class BPlusTreeLeafPage<NormalizedKey<16>, RID,
+                                          NormalizedComparator<16>>;
+template class BPlusTreeLeafPage<NormalizedKey<32>, RID,
+                                          NormalizedComparator<32>>;
+template class BPlusTreeLeafPage<NormalizedKey<64>, RID,
+                                          NormalizedComparator<64>>;
 } // namespace scudb
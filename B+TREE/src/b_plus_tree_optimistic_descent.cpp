@@ -0,0 +1,195 @@
+/**
+ * b_plus_tree_optimistic_descent.cpp
+ */
+#include "common/exception.h"
+#include "common/rid.h"
+#include "index/b_plus_tree_optimistic_descent.h"
+
+namespace scudb {
+
+INDEX_TEMPLATE_ARGUMENTS
+B_PLUS_TREE_OPTIMISTIC_DESCENT_TYPE::BPlusTreeOptimisticDescent(
+    BufferPoolManager *buffer_pool_manager, const KeyComparator &comparator,
+    int max_restarts)
+    : buffer_pool_manager_(buffer_pool_manager), comparator_(comparator),
+      max_restarts_(max_restarts), restarts_(0), fallbacks_(0) {}
+
+INDEX_TEMPLATE_ARGUMENTS
+Page *B_PLUS_TREE_OPTIMISTIC_DESCENT_TYPE::FindLeaf(page_id_t root_page_id,
+                                                    const KeyType &key,
+                                                    OpType op,
+                                                    BPlusTreePath *path) {
+  for (int attempt = 0; attempt <= max_restarts_; attempt++) {
+    Page *leaf = nullptr;
+    Result result = Descend(root_page_id, key, op, leaf, path);
+    if (result == Result::FOUND) {
+      return leaf;
+    }
+    if (result == Result::FALLBACK) {
+      break;
+    }
+    restarts_.fetch_add(1, std::memory_order_relaxed);
+  }
+  fallbacks_.fetch_add(1, std::memory_order_relaxed);
+  return nullptr;
+}
+
+INDEX_TEMPLATE_ARGUMENTS
+void B_PLUS_TREE_OPTIMISTIC_DESCENT_TYPE::ReleaseLeaf(Page *page, OpType op,
+                                                      bool is_dirty) {
+  Unlatch(page, op);
+  buffer_pool_manager_->UnpinPage(page->GetPageId(), is_dirty);
+}
+
+/*
+ * One attempt from the root. Every page on the way is pinned (the pin is all
+ * that keeps the frame from being reused) and everything read from an
+ * unlatched page is used only once its version has been validated.
+ */
+INDEX_TEMPLATE_ARGUMENTS
+typename B_PLUS_TREE_OPTIMISTIC_DESCENT_TYPE::Result
+B_PLUS_TREE_OPTIMISTIC_DESCENT_TYPE::Descend(page_id_t root_page_id,
+                                             const KeyType &key, OpType op,
+                                             Page *&leaf, BPlusTreePath *path) {
+  if (path != nullptr) {
+    path->Clear();
+  }
+  Page *page = buffer_pool_manager_->FetchPage(root_page_id);
+  if (page == nullptr) {
+    throw Exception(EXCEPTION_TYPE_INDEX, "all page are pinned while descending");
+  }
+  BPlusTreePage *node = reinterpret_cast<BPlusTreePage *>(page->GetData());
+  uint32_t version = ReadVersion(page);
+  bool latched = false;
+  if (node->IsLeafPage()) {
+    Latch(page, op);
+    latched = true;
+  }
+  // not the root any more: the caller read root_page_id before a root split
+  // or collapse, and restarting from it would not help
+  bool is_root = node->IsRootPage();
+  // a latched leaf is consistent as it is, and write-latching it made its
+  // version odd, so only an internal root is validated
+  bool valid = latched || node->ValidateVersion(version);
+  if (!valid || !is_root) {
+    if (latched) {
+      Unlatch(page, op);
+    }
+    buffer_pool_manager_->UnpinPage(root_page_id, false);
+    return valid ? Result::FALLBACK : Result::RESTART;
+  }
+
+  while (!node->IsLeafPage()) {
+    if (!IsSearchable(node)) {
+      bool valid = node->ValidateVersion(version);
+      buffer_pool_manager_->UnpinPage(page->GetPageId(), false);
+      return valid ? Result::FALLBACK : Result::RESTART;
+    }
+    InternalPage *internal = reinterpret_cast<InternalPage *>(node);
+    int slot = internal->LookupIndex(key, comparator_);
+    page_id_t child_id = internal->ValueAt(slot);
+    if (!node->ValidateVersion(version)) {
+      buffer_pool_manager_->UnpinPage(page->GetPageId(), false);
+      return Result::RESTART;
+    }
+    Page *child_page = buffer_pool_manager_->FetchPage(child_id);
+    if (child_page == nullptr) {
+      buffer_pool_manager_->UnpinPage(page->GetPageId(), false);
+      throw Exception(EXCEPTION_TYPE_INDEX, "all page are pinned while descending");
+    }
+    BPlusTreePage *child = reinterpret_cast<BPlusTreePage *>(child_page->GetData());
+    uint32_t child_version = ReadVersion(child_page);
+    // a page never changes type while its parent points to it, and the
+    // parent is validated below
+    if (child->IsLeafPage()) {
+      Latch(child_page, op);
+      latched = true;
+    }
+    // the child is still the one for key only if the parent did not change
+    // while the child was being entered, e.g. by a split moving key right
+    if (!node->ValidateVersion(version)) {
+      if (latched) {
+        Unlatch(child_page, op);
+      }
+      buffer_pool_manager_->UnpinPage(child_id, false);
+      buffer_pool_manager_->UnpinPage(page->GetPageId(), false);
+      return Result::RESTART;
+    }
+    if (path != nullptr) {
+      path->Push(page->GetPageId(), slot);
+    }
+    buffer_pool_manager_->UnpinPage(page->GetPageId(), false);
+    page = child_page;
+    node = child;
+    version = child_version;
+  }
+
+  // the leaf is latched, so it is consistent; a write that splits or merges
+  // it needs latches on its ancestors too
+  if (op != OpType::READ && !node->IsSafe(op)) {
+    Unlatch(page, op);
+    buffer_pool_manager_->UnpinPage(page->GetPageId(), false);
+    return Result::FALLBACK;
+  }
+  leaf = page;
+  return Result::FOUND;
+}
+
+INDEX_TEMPLATE_ARGUMENTS
+bool B_PLUS_TREE_OPTIMISTIC_DESCENT_TYPE::IsSearchable(
+    const BPlusTreePage *node) const {
+  // max size as set by InternalPage::Init
+  int max_size = static_cast<int>((PAGE_SIZE - sizeof(InternalPage)) /
+                                  sizeof(std::pair<KeyType, page_id_t>)) - 1;
+  return node->GetSize() > 1 && node->GetSize() <= max_size + 1;
+}
+
+/*
+ * An odd version is either a writer at work or a page that was flushed in
+ * the middle of a write and read back; the shared latch waits out the first
+ * and recovers the second. No other latch is held here, as the leaf is
+ * latched only after its version is read.
+ */
+INDEX_TEMPLATE_ARGUMENTS
+uint32_t B_PLUS_TREE_OPTIMISTIC_DESCENT_TYPE::ReadVersion(Page *page) {
+  BPlusTreePage *node = reinterpret_cast<BPlusTreePage *>(page->GetData());
+  uint32_t version = node->ReadVersion();
+  if (version & 1) {
+    page->RLatch();
+    node->RecoverVersion();
+    version = node->ReadVersion();
+    page->RUnlatch();
+  }
+  return version;
+}
+
+INDEX_TEMPLATE_ARGUMENTS
+void B_PLUS_TREE_OPTIMISTIC_DESCENT_TYPE::Latch(Page *page, OpType op) {
+  if (op == OpType::READ) {
+    page->RLatch();
+  } else {
+    BPlusTreePage::WLatch(page);
+  }
+}
+
+INDEX_TEMPLATE_ARGUMENTS
+void B_PLUS_TREE_OPTIMISTIC_DESCENT_TYPE::Unlatch(Page *page, OpType op) {
+  if (op == OpType::READ) {
+    page->RUnlatch();
+  } else {
+    BPlusTreePage::WUnlatch(page);
+  }
+}
+
+template class BPlusTreeOptimisticDescent<GenericKey<4>, RID, GenericComparator<4>>;
+template class BPlusTreeOptimisticDescent<GenericKey<8>, RID, GenericComparator<8>>;
+template class BPlusTreeOptimisticDescent<GenericKey<16>, RID, GenericComparator<16>>;
+template class BPlusTreeOptimisticDescent<GenericKey<32>, RID, GenericComparator<32>>;
+template class BPlusTreeOptimisticDescent<GenericKey<64>, RID, GenericComparator<64>>;
+template class BPlusTreeOptimisticDescent<NormalizedKey<4>, RID, NormalizedComparator<4>>;
+template class BPlusTreeOptimisticDescent<NormalizedKey<8>, RID, NormalizedComparator<8>>;
+template class BPlusTreeOptimisticDescent<NormalizedKey<16>, RID, NormalizedComparator<16>>;
+template class BPlusTreeOptimisticDescent<NormalizedKey<32>, RID, NormalizedComparator<32>>;
+template class BPlusTreeOptimisticDescent<NormalizedKey<64>, RID, NormalizedComparator<64>>;
+
+} // namespace scudb
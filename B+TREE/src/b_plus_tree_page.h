@@ -59,4 +59,46 @@ bool BPlusTreePage::IsSafe(OpType op) {
   assert(false);//invalid area
 }
 
+
+uint32_t BPlusTreePage::ReadVersion() const { return __atomic_load_n(&version_, __ATOMIC_ACQUIRE); }
+
+bool BPlusTreePage::ValidateVersion(uint32_t version) const {
+  // order the unlatched reads of the page before the second version load
+  __atomic_thread_fence(__ATOMIC_ACQUIRE);
+  return (version & 1) == 0 && __atomic_load_n(&version_, __ATOMIC_RELAXED) == version;
+}
+
+// version | 1 rather than version + 1: a page flushed in the middle of a
+// write can come back from disk odd, and a writer can latch it before any
+// reader has recovered it
+void BPlusTreePage::BeginWrite() {
+  __atomic_store_n(&version_, version_ | 1, __ATOMIC_RELAXED);
+  __atomic_thread_fence(__ATOMIC_RELEASE);
+}
+
+void BPlusTreePage::EndWrite() { __atomic_store_n(&version_, version_ + 1, __ATOMIC_RELEASE); }
+
+void BPlusTreePage::ResetVersion() { __atomic_store_n(&version_, 0, __ATOMIC_RELEASE); }
+
+// a writer keeps the page write-latched while the version is odd, so an odd
+// version seen under a shared latch was read from disk; several readers can
+// get here at once and only one of them moves it on
+void BPlusTreePage::RecoverVersion() {
+  uint32_t version = ReadVersion();
+  if (version & 1) {
+    __atomic_compare_exchange_n(&version_, &version, version + 1, false, __ATOMIC_RELEASE,
+                                __ATOMIC_RELAXED);
+  }
+}
+
+void BPlusTreePage::WLatch(Page *page) {
+  page->WLatch();
+  reinterpret_cast<BPlusTreePage *>(page->GetData())->BeginWrite();
+}
+
+void BPlusTreePage::WUnlatch(Page *page) {
+  reinterpret_cast<BPlusTreePage *>(page->GetData())->EndWrite();
+  page->WUnlatch();
+}
+
 } // namespace scudb
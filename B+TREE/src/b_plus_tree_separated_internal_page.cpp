@@ -0,0 +1,296 @@
+/**
+ * b_plus_tree_separated_internal_page.cpp
+ */
+#include <sstream>
+
+#include "common/exception.h"
+#include "page/b_plus_tree_separated_internal_page.h"
+
+namespace scudb {
+
+INDEX_TEMPLATE_ARGUMENTS
+void B_PLUS_TREE_SEPARATED_INTERNAL_PAGE_TYPE::Init(page_id_t page_id,
+                                                    page_id_t parent_id) {
+  this->SetPageType(IndexPageType::INTERNAL_PAGE);
+  this->SetSize(0);
+  this->SetPageId(page_id);
+  this->SetParentPageId(parent_id);
+  this->ResetVersion();
+  this->InitLayout();
+}
+
+INDEX_TEMPLATE_ARGUMENTS
+void B_PLUS_TREE_SEPARATED_INTERNAL_PAGE_TYPE::SetKeyAt(int index,
+                                                        const KeyType &key) {
+  assert(index >= 0 && index < this->GetSize());
+  this->Keys()[index] = key;
+}
+
+INDEX_TEMPLATE_ARGUMENTS
+int B_PLUS_TREE_SEPARATED_INTERNAL_PAGE_TYPE::ValueIndex(
+    const ValueType &value) const {
+  for (int i = 0; i < this->GetSize(); i++) {
+    if (value == this->Values()[i]) return i;
+  }
+  return -1;
+}
+
+INDEX_TEMPLATE_ARGUMENTS
+int B_PLUS_TREE_SEPARATED_INTERNAL_PAGE_TYPE::ValueIndex(const ValueType &value,
+                                                         int hint) const {
+  if (hint >= 0 && hint < this->GetSize() && this->Values()[hint] == value) {
+    return hint;
+  }
+  return ValueIndex(value);
+}
+
+/*****************************************************************************
+ * LOOKUP
+ *****************************************************************************/
+
+// the child left of the first key > key; the first key is invalid
+INDEX_TEMPLATE_ARGUMENTS
+ValueType B_PLUS_TREE_SEPARATED_INTERNAL_PAGE_TYPE::Lookup(
+    const KeyType &key, const KeyComparator &comparator) const {
+  return this->Values()[LookupIndex(key, comparator)];
+}
+
+INDEX_TEMPLATE_ARGUMENTS
+int B_PLUS_TREE_SEPARATED_INTERNAL_PAGE_TYPE::LookupIndex(
+    const KeyType &key, const KeyComparator &comparator) const {
+  assert(this->GetSize() > 1);
+  return this->UpperBound(key, comparator, 1) - 1;
+}
+
+/*****************************************************************************
+ * INSERTION
+ *****************************************************************************/
+
+INDEX_TEMPLATE_ARGUMENTS
+void B_PLUS_TREE_SEPARATED_INTERNAL_PAGE_TYPE::PopulateNewRoot(
+    const ValueType &old_value, const KeyType &new_key,
+    const ValueType &new_value) {
+  this->Values()[0] = old_value;
+  this->Keys()[1] = new_key;
+  this->Values()[1] = new_value;
+  this->SetSize(2);
+}
+
+INDEX_TEMPLATE_ARGUMENTS
+int B_PLUS_TREE_SEPARATED_INTERNAL_PAGE_TYPE::InsertNodeAfter(
+    const ValueType &old_value, const KeyType &new_key,
+    const ValueType &new_value) {
+  int idx = ValueIndex(old_value) + 1;
+  assert(idx > 0);
+  return InsertNodeAt(idx, new_key, new_value);
+}
+
+INDEX_TEMPLATE_ARGUMENTS
+int B_PLUS_TREE_SEPARATED_INTERNAL_PAGE_TYPE::InsertNodeAt(
+    int index, const KeyType &new_key, const ValueType &new_value) {
+  assert(index > 0 && index <= this->GetSize());
+  this->InsertAt(index, new_key, new_value);
+  return this->GetSize();
+}
+
+/*****************************************************************************
+ * SPLIT
+ *****************************************************************************/
+
+INDEX_TEMPLATE_ARGUMENTS
+void B_PLUS_TREE_SEPARATED_INTERNAL_PAGE_TYPE::MoveHalfTo(
+    BPlusTreeSeparatedInternalPage *recipient,
+    BufferPoolManager *buffer_pool_manager) {
+  MoveHalfTo(recipient);
+  recipient->AdoptChildren(0, recipient->GetSize(), buffer_pool_manager);
+}
+
+INDEX_TEMPLATE_ARGUMENTS
+void B_PLUS_TREE_SEPARATED_INTERNAL_PAGE_TYPE::MoveHalfTo(
+    BPlusTreeSeparatedInternalPage *recipient) {
+  assert(recipient != nullptr);
+  int total = this->GetMaxSize() + 1;
+  assert(this->GetSize() == total);
+  int copyIdx = total / 2;
+  recipient->CopyFrom(this, copyIdx, total - copyIdx);
+  this->SetSize(copyIdx);
+}
+
+INDEX_TEMPLATE_ARGUMENTS
+void B_PLUS_TREE_SEPARATED_INTERNAL_PAGE_TYPE::AdoptChildren(
+    int begin, int end, BufferPoolManager *buffer_pool_manager) {
+  for (int i = begin; i < end; i++) {
+    page_id_t child_id = this->Values()[i];
+    Page *page = buffer_pool_manager->FetchPage(child_id);
+    if (page == nullptr)
+      throw Exception(EXCEPTION_TYPE_INDEX, "all page are pinned while moving children");
+    reinterpret_cast<BPlusTreePage *>(page->GetData())->SetParentPageId(this->GetPageId());
+    buffer_pool_manager->UnpinPage(child_id, true);
+  }
+}
+
+/*****************************************************************************
+ * REMOVE
+ *****************************************************************************/
+
+INDEX_TEMPLATE_ARGUMENTS
+void B_PLUS_TREE_SEPARATED_INTERNAL_PAGE_TYPE::Remove(int index) {
+  this->RemoveAt(index);
+}
+
+INDEX_TEMPLATE_ARGUMENTS
+ValueType B_PLUS_TREE_SEPARATED_INTERNAL_PAGE_TYPE::RemoveAndReturnOnlyChild() {
+  assert(this->GetSize() == 1);
+  ValueType ret = this->Values()[0];
+  this->RemoveAt(0);
+  return ret;
+}
+
+/*****************************************************************************
+ * MERGE
+ *****************************************************************************/
+
+INDEX_TEMPLATE_ARGUMENTS
+void B_PLUS_TREE_SEPARATED_INTERNAL_PAGE_TYPE::MoveAllTo(
+    BPlusTreeSeparatedInternalPage *recipient, int index_in_parent,
+    BufferPoolManager *buffer_pool_manager) {
+  assert(recipient != nullptr);
+  Page *page = buffer_pool_manager->FetchPage(this->GetParentPageId());
+  if (page == nullptr)
+    throw Exception(EXCEPTION_TYPE_INDEX, "all page are pinned while merging");
+  auto *parent = reinterpret_cast<BPlusTreeSeparatedInternalPage *>(page->GetData());
+  // the separation key from parent
+  KeyType middle_key = parent->KeyAt(index_in_parent);
+  buffer_pool_manager->UnpinPage(parent->GetPageId(), false);
+
+  int start = recipient->GetSize();
+  MoveAllTo(recipient, middle_key);
+  recipient->AdoptChildren(start, recipient->GetSize(), buffer_pool_manager);
+}
+
+INDEX_TEMPLATE_ARGUMENTS
+void B_PLUS_TREE_SEPARATED_INTERNAL_PAGE_TYPE::MoveAllTo(
+    BPlusTreeSeparatedInternalPage *recipient, const KeyType &middle_key) {
+  assert(recipient != nullptr);
+  SetKeyAt(0, middle_key);
+  recipient->CopyFrom(this, 0, this->GetSize());
+  this->SetSize(0);
+}
+
+/*****************************************************************************
+ * REDISTRIBUTE
+ *****************************************************************************/
+
+INDEX_TEMPLATE_ARGUMENTS
+void B_PLUS_TREE_SEPARATED_INTERNAL_PAGE_TYPE::MoveFirstToEndOf(
+    BPlusTreeSeparatedInternalPage *recipient,
+    BufferPoolManager *buffer_pool_manager) {
+  MoveFirstToEndOf(recipient, -1, buffer_pool_manager);
+}
+
+INDEX_TEMPLATE_ARGUMENTS
+void B_PLUS_TREE_SEPARATED_INTERNAL_PAGE_TYPE::MoveFirstToEndOf(
+    BPlusTreeSeparatedInternalPage *recipient, int index_in_parent,
+    BufferPoolManager *buffer_pool_manager) {
+  Page *page = buffer_pool_manager->FetchPage(this->GetParentPageId());
+  if (page == nullptr)
+    throw Exception(EXCEPTION_TYPE_INDEX, "all page are pinned while redistributing");
+  auto *parent = reinterpret_cast<BPlusTreeSeparatedInternalPage *>(page->GetData());
+  MoveFirstToEndOf(recipient, parent,
+                   parent->ValueIndex(this->GetPageId(), index_in_parent));
+  buffer_pool_manager->UnpinPage(parent->GetPageId(), true);
+  // update child parent page id
+  recipient->AdoptChildren(recipient->GetSize() - 1, recipient->GetSize(),
+                           buffer_pool_manager);
+}
+
+INDEX_TEMPLATE_ARGUMENTS
+void B_PLUS_TREE_SEPARATED_INTERNAL_PAGE_TYPE::MoveFirstToEndOf(
+    BPlusTreeSeparatedInternalPage *recipient,
+    BPlusTreeSeparatedInternalPage *parent, int index_in_parent) {
+  assert(recipient != nullptr && this->GetSize() > 1);
+  // the separation key comes down with the first child
+  KeyType key = parent->KeyAt(index_in_parent);
+  ValueType value = this->Values()[0];
+  this->RemoveAt(0);
+  recipient->InsertAt(recipient->GetSize(), key, value);
+  //update relavent key & value pair in its parent page.
+  parent->SetKeyAt(index_in_parent, this->Keys()[0]);
+}
+
+INDEX_TEMPLATE_ARGUMENTS
+void B_PLUS_TREE_SEPARATED_INTERNAL_PAGE_TYPE::MoveLastToFrontOf(
+    BPlusTreeSeparatedInternalPage *recipient, int parent_index,
+    BufferPoolManager *buffer_pool_manager) {
+  Page *page = buffer_pool_manager->FetchPage(recipient->GetParentPageId());
+  if (page == nullptr)
+    throw Exception(EXCEPTION_TYPE_INDEX, "all page are pinned while redistributing");
+  auto *parent = reinterpret_cast<BPlusTreeSeparatedInternalPage *>(page->GetData());
+  MoveLastToFrontOf(recipient, parent, parent_index);
+  buffer_pool_manager->UnpinPage(parent->GetPageId(), true);
+  // update child parent page id
+  recipient->AdoptChildren(0, 1, buffer_pool_manager);
+}
+
+INDEX_TEMPLATE_ARGUMENTS
+void B_PLUS_TREE_SEPARATED_INTERNAL_PAGE_TYPE::MoveLastToFrontOf(
+    BPlusTreeSeparatedInternalPage *recipient,
+    BPlusTreeSeparatedInternalPage *parent, int parent_index) {
+  assert(recipient != nullptr && this->GetSize() > 1);
+  int last = this->GetSize() - 1;
+  KeyType key = this->Keys()[last];
+  ValueType value = this->Values()[last];
+  this->RemoveAt(last);
+  recipient->InsertAt(0, key, value);
+  // the separation key goes down to the recipient's former first child
+  recipient->SetKeyAt(1, parent->KeyAt(parent_index));
+  //update relavent key & value pair in its parent page.
+  parent->SetKeyAt(parent_index, key);
+}
+
+/*****************************************************************************
+ * DEBUG
+ *****************************************************************************/
+INDEX_TEMPLATE_ARGUMENTS
+void B_PLUS_TREE_SEPARATED_INTERNAL_PAGE_TYPE::QueueUpChildren(
+    std::queue<BPlusTreePage *> *queue,
+    BufferPoolManager *buffer_pool_manager) {
+  for (int i = 0; i < this->GetSize(); i++) {
+    auto *page = buffer_pool_manager->FetchPage(this->Values()[i]);
+    if (page == nullptr)
+      throw Exception(EXCEPTION_TYPE_INDEX,
+                      "all page are pinned while printing");
+    queue->push(reinterpret_cast<BPlusTreePage *>(page->GetData()));
+  }
+}
+
+INDEX_TEMPLATE_ARGUMENTS
+std::string B_PLUS_TREE_SEPARATED_INTERNAL_PAGE_TYPE::ToString(bool verbose) const {
+  if (this->GetSize() == 0) {
+    return "";
+  }
+  std::ostringstream os;
+  if (verbose) {
+    os << "[pageId: " << this->GetPageId()
+       << " parentId: " << this->GetParentPageId() << "]<"
+       << this->GetSize() << "> ";
+  }
+  // the first key is invalid
+  for (int entry = verbose ? 0 : 1; entry < this->GetSize(); ++entry) {
+    if (entry > (verbose ? 0 : 1)) {
+      os << " ";
+    }
+    os << std::dec << this->Keys()[entry].ToString();
+    if (verbose) {
+      os << "(" << this->Values()[entry] << ")";
+    }
+  }
+  return os.str();
+}
+
+template class BPlusTreeSeparatedInternalPage<GenericKey<4>, page_id_t, GenericComparator<4>>;
+template class BPlusTreeSeparatedInternalPage<GenericKey<8>, page_id_t, GenericComparator<8>>;
+template class BPlusTreeSeparatedInternalPage<NormalizedKey<4>, page_id_t, NormalizedComparator<4>>;
+template class BPlusTreeSeparatedInternalPage<NormalizedKey<8>, page_id_t, NormalizedComparator<8>>;
+
+} // namespace scudb
@@ -0,0 +1,192 @@
+/**
+ * b_plus_tree_separated_leaf_page.cpp
+ */
+#include <sstream>
+
+#include "common/exception.h"
+#include "common/rid.h"
+#include "page/b_plus_tree_separated_internal_page.h"
+#include "page/b_plus_tree_separated_leaf_page.h"
+
+namespace scudb {
+
+INDEX_TEMPLATE_ARGUMENTS
+void B_PLUS_TREE_SEPARATED_LEAF_PAGE_TYPE::Init(page_id_t page_id,
+                                                page_id_t parent_id) {
+  this->SetPageType(IndexPageType::LEAF_PAGE);
+  this->SetSize(0);
+  this->SetPageId(page_id);
+  this->SetParentPageId(parent_id);
+  this->ResetVersion();
+  this->InitLayout();
+}
+
+INDEX_TEMPLATE_ARGUMENTS
+MappingType B_PLUS_TREE_SEPARATED_LEAF_PAGE_TYPE::GetItem(int index) const {
+  return MappingType(this->KeyAt(index), this->ValueAt(index));
+}
+
+/*****************************************************************************
+ * INSERTION
+ *****************************************************************************/
+
+INDEX_TEMPLATE_ARGUMENTS
+int B_PLUS_TREE_SEPARATED_LEAF_PAGE_TYPE::Insert(const KeyType &key,
+                                                 const ValueType &value,
+                                                 const KeyComparator &comparator) {
+  this->InsertAt(KeyIndex(key, comparator), key, value);
+  return this->GetSize();
+}
+
+INDEX_TEMPLATE_ARGUMENTS
+void B_PLUS_TREE_SEPARATED_LEAF_PAGE_TYPE::MoveHalfTo(
+    BPlusTreeSeparatedLeafPage *recipient,
+    __attribute__((unused)) BufferPoolManager *buffer_pool_manager) {
+  assert(recipient != nullptr);
+  int total = this->GetMaxSize() + 1;
+  assert(this->GetSize() == total);
+  int copyIdx = total / 2;
+  recipient->CopyFrom(this, copyIdx, total - copyIdx);
+  recipient->SetNextPageId(GetNextPageId());
+  SetNextPageId(recipient->GetPageId());
+  this->SetSize(copyIdx);
+}
+
+/*****************************************************************************
+ * LOOKUP
+ *****************************************************************************/
+
+INDEX_TEMPLATE_ARGUMENTS
+bool B_PLUS_TREE_SEPARATED_LEAF_PAGE_TYPE::Lookup(
+    const KeyType &key, ValueType &value, const KeyComparator &comparator) const {
+  int idx = KeyIndex(key, comparator);
+  if (idx < this->GetSize() && comparator(this->Keys()[idx], key) == 0) {
+    value = this->Values()[idx];
+    return true;
+  }
+  return false;
+}
+
+/*****************************************************************************
+ * REMOVE
+ *****************************************************************************/
+
+INDEX_TEMPLATE_ARGUMENTS
+int B_PLUS_TREE_SEPARATED_LEAF_PAGE_TYPE::RemoveAndDeleteRecord(
+    const KeyType &key, const KeyComparator &comparator) {
+  int idx = KeyIndex(key, comparator);
+  if (idx < this->GetSize() && comparator(this->Keys()[idx], key) == 0) {
+    this->RemoveAt(idx);
+  }
+  return this->GetSize();
+}
+
+/*****************************************************************************
+ * MERGE
+ *****************************************************************************/
+
+INDEX_TEMPLATE_ARGUMENTS
+void B_PLUS_TREE_SEPARATED_LEAF_PAGE_TYPE::MoveAllTo(
+    BPlusTreeSeparatedLeafPage *recipient, int, BufferPoolManager *) {
+  assert(recipient != nullptr);
+  recipient->CopyFrom(this, 0, this->GetSize());
+  recipient->SetNextPageId(GetNextPageId());
+  this->SetSize(0);
+}
+
+/*****************************************************************************
+ * REDISTRIBUTE
+ *****************************************************************************/
+
+INDEX_TEMPLATE_ARGUMENTS
+void B_PLUS_TREE_SEPARATED_LEAF_PAGE_TYPE::MoveFirstToEndOf(
+    BPlusTreeSeparatedLeafPage *recipient,
+    BufferPoolManager *buffer_pool_manager) {
+  MoveFirstToEndOf(recipient, -1, buffer_pool_manager);
+}
+
+INDEX_TEMPLATE_ARGUMENTS
+void B_PLUS_TREE_SEPARATED_LEAF_PAGE_TYPE::MoveFirstToEndOf(
+    BPlusTreeSeparatedLeafPage *recipient, int index_in_parent,
+    BufferPoolManager *buffer_pool_manager) {
+  Page *page = buffer_pool_manager->FetchPage(this->GetParentPageId());
+  if (page == nullptr)
+    throw Exception(EXCEPTION_TYPE_INDEX, "all page are pinned while redistributing");
+  auto *parent = reinterpret_cast<
+      BPlusTreeSeparatedInternalPage<KeyType, page_id_t, KeyComparator> *>(page->GetData());
+  MoveFirstToEndOf(recipient, parent,
+                   parent->ValueIndex(this->GetPageId(), index_in_parent));
+  buffer_pool_manager->UnpinPage(parent->GetPageId(), true);
+}
+
+INDEX_TEMPLATE_ARGUMENTS
+void B_PLUS_TREE_SEPARATED_LEAF_PAGE_TYPE::MoveFirstToEndOf(
+    BPlusTreeSeparatedLeafPage *recipient,
+    BPlusTreeSeparatedInternalPage<KeyType, page_id_t, KeyComparator> *parent,
+    int index_in_parent) {
+  assert(recipient != nullptr && this->GetSize() > 1);
+  MappingType item = GetItem(0);
+  this->RemoveAt(0);
+  recipient->InsertAt(recipient->GetSize(), item.first, item.second);
+  //update relavent key & value pair in its parent page.
+  parent->SetKeyAt(index_in_parent, this->Keys()[0]);
+}
+
+INDEX_TEMPLATE_ARGUMENTS
+void B_PLUS_TREE_SEPARATED_LEAF_PAGE_TYPE::MoveLastToFrontOf(
+    BPlusTreeSeparatedLeafPage *recipient, int parentIndex,
+    BufferPoolManager *buffer_pool_manager) {
+  Page *page = buffer_pool_manager->FetchPage(recipient->GetParentPageId());
+  if (page == nullptr)
+    throw Exception(EXCEPTION_TYPE_INDEX, "all page are pinned while redistributing");
+  auto *parent = reinterpret_cast<
+      BPlusTreeSeparatedInternalPage<KeyType, page_id_t, KeyComparator> *>(page->GetData());
+  MoveLastToFrontOf(recipient, parent, parentIndex);
+  buffer_pool_manager->UnpinPage(parent->GetPageId(), true);
+}
+
+INDEX_TEMPLATE_ARGUMENTS
+void B_PLUS_TREE_SEPARATED_LEAF_PAGE_TYPE::MoveLastToFrontOf(
+    BPlusTreeSeparatedLeafPage *recipient,
+    BPlusTreeSeparatedInternalPage<KeyType, page_id_t, KeyComparator> *parent,
+    int parentIndex) {
+  assert(recipient != nullptr && this->GetSize() > 1);
+  MappingType item = GetItem(this->GetSize() - 1);
+  this->RemoveAt(this->GetSize() - 1);
+  recipient->InsertAt(0, item.first, item.second);
+  //update relavent key & value pair in its parent page.
+  parent->SetKeyAt(parentIndex, item.first);
+}
+
+/*****************************************************************************
+ * DEBUG
+ *****************************************************************************/
+INDEX_TEMPLATE_ARGUMENTS
+std::string B_PLUS_TREE_SEPARATED_LEAF_PAGE_TYPE::ToString(bool verbose) const {
+  if (this->GetSize() == 0) {
+    return "";
+  }
+  std::ostringstream stream;
+  if (verbose) {
+    stream << "[pageId: " << this->GetPageId()
+           << " parentId: " << this->GetParentPageId() << "]<"
+           << this->GetSize() << "> ";
+  }
+  for (int entry = 0; entry < this->GetSize(); ++entry) {
+    if (entry > 0) {
+      stream << " ";
+    }
+    stream << std::dec << this->Keys()[entry];
+    if (verbose) {
+      stream << "(" << this->Values()[entry] << ")";
+    }
+  }
+  return stream.str();
+}
+
+template class BPlusTreeSeparatedLeafPage<GenericKey<4>, RID, GenericComparator<4>>;
+template class BPlusTreeSeparatedLeafPage<GenericKey<8>, RID, GenericComparator<8>>;
+template class BPlusTreeSeparatedLeafPage<NormalizedKey<4>, RID, NormalizedComparator<4>>;
+template class BPlusTreeSeparatedLeafPage<NormalizedKey<8>, RID, NormalizedComparator<8>>;
+
+} // namespace scudb
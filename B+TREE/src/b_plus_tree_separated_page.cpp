@@ -0,0 +1,122 @@
+/**
+ * b_plus_tree_separated_page.cpp
+ */
+#include <cstring>
+
+#include "common/rid.h"
+#include "page/b_plus_tree_separated_page.h"
+
+namespace scudb {
+
+/*****************************************************************************
+ * HELPER METHODS AND UTILITIES
+ *****************************************************************************/
+
+INDEX_TEMPLATE_ARGUMENTS
+void B_PLUS_TREE_SEPARATED_PAGE_TYPE::InitLayout() {
+  next_page_id_ = INVALID_PAGE_ID;
+  SetMaxSize(Capacity() - 1); //minus 1 for insert first then split
+}
+
+INDEX_TEMPLATE_ARGUMENTS
+KeyType B_PLUS_TREE_SEPARATED_PAGE_TYPE::KeyAt(int index) const {
+  assert(index >= 0 && index < GetSize());
+  return Keys()[index];
+}
+
+INDEX_TEMPLATE_ARGUMENTS
+ValueType B_PLUS_TREE_SEPARATED_PAGE_TYPE::ValueAt(int index) const {
+  assert(index >= 0 && index < GetSize());
+  return Values()[index];
+}
+
+/*****************************************************************************
+ * SEARCH
+ *****************************************************************************/
+
+/*
+ * While more than LINEAR_SEARCH_THRESHOLD candidates are left, drop the
+ * lower half if its last key is below key, else the upper half; the select
+ * compiles to a conditional move. Keys dropped from the top are all >= key,
+ * so the final count of candidates below key gives the index.
+ */
+INDEX_TEMPLATE_ARGUMENTS
+int B_PLUS_TREE_SEPARATED_PAGE_TYPE::LowerBound(const KeyType &key,
+                                                const KeyComparator &comparator,
+                                                int begin) const {
+  const KeyType *base = Keys() + begin;
+  int n = GetSize() - begin;
+  while (n > LINEAR_SEARCH_THRESHOLD) {
+    int half = n / 2;
+    base += (comparator(base[half - 1], key) < 0) ? half : 0;
+    n -= half;
+  }
+  int idx = static_cast<int>(base - Keys());
+  for (int i = 0; i < n; i++) {
+    idx += comparator(base[i], key) < 0;
+  }
+  return idx;
+}
+
+INDEX_TEMPLATE_ARGUMENTS
+int B_PLUS_TREE_SEPARATED_PAGE_TYPE::UpperBound(const KeyType &key,
+                                                const KeyComparator &comparator,
+                                                int begin) const {
+  const KeyType *base = Keys() + begin;
+  int n = GetSize() - begin;
+  while (n > LINEAR_SEARCH_THRESHOLD) {
+    int half = n / 2;
+    base += (comparator(base[half - 1], key) <= 0) ? half : 0;
+    n -= half;
+  }
+  int idx = static_cast<int>(base - Keys());
+  for (int i = 0; i < n; i++) {
+    idx += comparator(base[i], key) <= 0;
+  }
+  return idx;
+}
+
+/*****************************************************************************
+ * INSERTION AND REMOVAL
+ *****************************************************************************/
+
+INDEX_TEMPLATE_ARGUMENTS
+void B_PLUS_TREE_SEPARATED_PAGE_TYPE::InsertAt(int index, const KeyType &key,
+                                               const ValueType &value) {
+  assert(index >= 0 && index <= GetSize() && GetSize() < Capacity());
+  int tail = GetSize() - index;
+  memmove(Keys() + index + 1, Keys() + index, tail * sizeof(KeyType));
+  memmove(Values() + index + 1, Values() + index, tail * sizeof(ValueType));
+  Keys()[index] = key;
+  Values()[index] = value;
+  IncreaseSize(1);
+}
+
+INDEX_TEMPLATE_ARGUMENTS
+void B_PLUS_TREE_SEPARATED_PAGE_TYPE::RemoveAt(int index) {
+  assert(index >= 0 && index < GetSize());
+  int tail = GetSize() - index - 1;
+  memmove(Keys() + index, Keys() + index + 1, tail * sizeof(KeyType));
+  memmove(Values() + index, Values() + index + 1, tail * sizeof(ValueType));
+  IncreaseSize(-1);
+}
+
+INDEX_TEMPLATE_ARGUMENTS
+void B_PLUS_TREE_SEPARATED_PAGE_TYPE::CopyFrom(
+    const BPlusTreeSeparatedPage *source, int index, int count) {
+  assert(GetSize() + count <= Capacity());
+  memcpy(Keys() + GetSize(), source->Keys() + index, count * sizeof(KeyType));
+  memcpy(Values() + GetSize(), source->Values() + index, count * sizeof(ValueType));
+  IncreaseSize(count);
+}
+
+template class BPlusTreeSeparatedPage<GenericKey<4>, RID, GenericComparator<4>>;
+template class BPlusTreeSeparatedPage<GenericKey<8>, RID, GenericComparator<8>>;
+template class BPlusTreeSeparatedPage<GenericKey<4>, page_id_t, GenericComparator<4>>;
+template class BPlusTreeSeparatedPage<GenericKey<8>, page_id_t, GenericComparator<8>>;
+template class BPlusTreeSeparatedPage<NormalizedKey<4>, RID, NormalizedComparator<4>>;
+template class BPlusTreeSeparatedPage<NormalizedKey<8>, RID, NormalizedComparator<8>>;
+template class BPlusTreeSeparatedPage<NormalizedKey<4>, page_id_t, NormalizedComparator<4>>;
+template class BPlusTreeSeparatedPage<NormalizedKey<8>, page_id_t, NormalizedComparator<8>>;
+
+} // namespace scudb
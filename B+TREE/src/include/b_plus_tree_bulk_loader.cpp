@@ -0,0 +1,74 @@
+/**
+ * b_plus_tree_bulk_loader.h
+ *
+ * Build a B+ tree bottom-up from (key, value) pairs that arrive in strictly
+ * increasing key order, instead of inserting them one by one.
+ *
+ * The number of pairs is given up front, so the size of every page on every
+ * level is planned before the first page is written: each level holds as few
+ * pages as the fill factor allows, and its entries are spread evenly so that
+ * no page ends up below its min size. Leaves are packed left to right and
+ * chained with SetNextPageId; whenever a page is opened on some level, its
+ * first key is pushed into the open page one level up. All levels are thus
+ * built in a single pass, and only the rightmost open page of each level is
+ * pinned at any time.
+ */
+#pragma once
+
+#include <string>
+#include <vector>
+
+#include "page/b_plus_tree_internal_page.h"
+#include "page/b_plus_tree_leaf_page.h"
+
+namespace scudb {
+
+#define B_PLUS_TREE_BULK_LOADER_TYPE                                           \
+  BPlusTreeBulkLoader<KeyType, ValueType, KeyComparator>
+
+INDEX_TEMPLATE_ARGUMENTS
+class BPlusTreeBulkLoader {
+public:
+  // fill_factor is the fraction of a page's max size to pack each page to;
+  // it is raised as needed so that every page stays at or above min size
+  BPlusTreeBulkLoader(BufferPoolManager *buffer_pool_manager,
+                      const KeyComparator &comparator, size_t num_entries,
+                      double fill_factor = 1.0);
+  ~BPlusTreeBulkLoader();
+
+  // keys must be unique and strictly increasing
+  void Append(const KeyType &key, const ValueType &value);
+
+  // unpin the open pages and return the root page id (INVALID_PAGE_ID for an
+  // empty input). With a non-empty index_name the root is also recorded in
+  // the header page, like BPlusTree::UpdateRootPageId
+  page_id_t Finish(const std::string &index_name = "");
+
+  int GetHeight() const { return static_cast<int>(levels_.size()); }
+
+private:
+  // one level of the tree being built, level 0 is the leaves
+  struct Level {
+    size_t num_entries; // entries (leaf pairs or children) on this level
+    size_t num_pages;
+    size_t page_index;  // index of the open page on this level
+    BPlusTreePage *page; // open page, pinned; nullptr before the first one
+  };
+  typedef BPlusTreeLeafPage<KeyType, ValueType, KeyComparator> LeafPage;
+  typedef BPlusTreeInternalPage<KeyType, page_id_t, KeyComparator> InternalPage;
+
+  static size_t PlanPages(size_t num_entries, int max_size, int min_size,
+                          double fill_factor);
+  int PageCapacity(const Level &level) const;
+  BPlusTreePage *OpenPage(size_t level, const KeyType &first_key);
+  page_id_t AppendChild(size_t level, const KeyType &key, page_id_t child);
+
+  BufferPoolManager *buffer_pool_manager_;
+  KeyComparator comparator_;
+  size_t num_entries_;
+  size_t appended_;
+  KeyType last_key_;
+  std::vector<Level> levels_;
+};
+
+} // namespace scudb
@@ -0,0 +1,74 @@
+/**
+ * b_plus_tree_compressed_internal_page.h
+ *
+ * Internal page in the compressed layout (see b_plus_tree_compressed_page.h).
+ * The first key is invalid as in BPlusTreeInternalPage and is not stored
+ * faithfully, so MoveHalfTo returns the key to push up instead of leaving it
+ * in the recipient. InsertNodeAfter fails with -1, and SetKeyAt, MoveAllTo,
+ * MoveFirstToEndOf and MoveLastToFrontOf with false, when the keys do not
+ * fit; the pages are then unchanged.
+ */
+#pragma once
+
+#include "page/b_plus_tree_compressed_page.h"
+
+namespace scudb {
+
+#define B_PLUS_TREE_COMPRESSED_INTERNAL_PAGE_TYPE                              \
+  BPlusTreeCompressedInternalPage<KeyType, ValueType, KeyComparator>
+
+INDEX_TEMPLATE_ARGUMENTS
+class BPlusTreeCompressedInternalPage
+    : public BPlusTreeCompressedPage<KeyType, ValueType, KeyComparator> {
+public:
+  void Init(page_id_t page_id, page_id_t parent_id = INVALID_PAGE_ID);
+  bool SetKeyAt(int index, const KeyType &key);
+  int ValueIndex(const ValueType &value) const;
+  // hint first, e.g. a slot from BPlusTreePath
+  int ValueIndex(const ValueType &value, int hint) const;
+
+  // insertion related
+  ValueType Lookup(const KeyType &key, const KeyComparator &comparator) const;
+  int LookupIndex(const KeyType &key, const KeyComparator &comparator) const;
+  void PopulateNewRoot(const ValueType &old_value, const KeyType &new_key,
+                       const ValueType &new_value);
+  int InsertNodeAfter(const ValueType &old_value, const KeyType &new_key,
+                      const ValueType &new_value);
+  int InsertNodeAt(int index, const KeyType &new_key,
+                   const ValueType &new_value);
+
+  // remove related
+  void Remove(int index);
+  ValueType RemoveAndReturnOnlyChild();
+
+  // Split and Merge utility methods
+  KeyType MoveHalfTo(BPlusTreeCompressedInternalPage *recipient,
+                     BufferPoolManager *buffer_pool_manager);
+  bool MoveAllTo(BPlusTreeCompressedInternalPage *recipient,
+                 int index_in_parent, BufferPoolManager *buffer_pool_manager);
+  bool MoveFirstToEndOf(BPlusTreeCompressedInternalPage *recipient,
+                        BufferPoolManager *buffer_pool_manager);
+  // index_in_parent is this page's index in the parent, or -1 to look it up
+  bool MoveFirstToEndOf(BPlusTreeCompressedInternalPage *recipient,
+                        int index_in_parent,
+                        BufferPoolManager *buffer_pool_manager);
+  bool MoveLastToFrontOf(BPlusTreeCompressedInternalPage *recipient,
+                         int parent_index,
+                         BufferPoolManager *buffer_pool_manager);
+  // for parent links from a BPlusTreePath, as in BPlusTreeInternalPage
+  KeyType MoveHalfTo(BPlusTreeCompressedInternalPage *recipient);
+  bool MoveAllTo(BPlusTreeCompressedInternalPage *recipient,
+                 const KeyType &middle_key);
+  bool MoveFirstToEndOf(BPlusTreeCompressedInternalPage *recipient,
+                        BPlusTreeCompressedInternalPage *parent,
+                        int index_in_parent);
+  bool MoveLastToFrontOf(BPlusTreeCompressedInternalPage *recipient,
+                         BPlusTreeCompressedInternalPage *parent,
+                         int parent_index);
+
+private:
+  void AdoptChildren(int begin, int end, page_id_t parent_id,
+                     BufferPoolManager *buffer_pool_manager);
+};
+
+} // namespace scudb
@@ -0,0 +1,71 @@
+/**
+ * b_plus_tree_compressed_leaf_page.h
+ *
+ * Leaf page in the compressed layout (see b_plus_tree_compressed_page.h).
+ * Same operations as BPlusTreeLeafPage, except that Insert can fail with -1
+ * when the key widens the encoding past what the page can hold (split and
+ * retry on the half the key belongs to, which may have to be split again),
+ * and that MoveAllTo fails when the merged keys do not fit. A split should push
+ * ShortestSeparator(last key of this page, first key of recipient) up to the
+ * parent instead of the first key of recipient.
+ *
+ * MoveFirstToEndOf and MoveLastToFrontOf return false, with all three pages
+ * unchanged, when the moved key does not fit in recipient or the new
+ * separator does not fit in the parent. A tree whose merge fails
+ * redistributes instead, and leaves the page underfull if that fails too.
+ */
+#pragma once
+
+#include "page/b_plus_tree_compressed_page.h"
+
+namespace scudb {
+
+INDEX_TEMPLATE_ARGUMENTS class BPlusTreeCompressedInternalPage;
+
+#define B_PLUS_TREE_COMPRESSED_LEAF_PAGE_TYPE                                  \
+  BPlusTreeCompressedLeafPage<KeyType, ValueType, KeyComparator>
+
+INDEX_TEMPLATE_ARGUMENTS
+class BPlusTreeCompressedLeafPage
+    : public BPlusTreeCompressedPage<KeyType, ValueType, KeyComparator> {
+public:
+  void Init(page_id_t page_id, page_id_t parent_id = INVALID_PAGE_ID);
+  page_id_t GetNextPageId() const { return this->next_page_id_; }
+  void SetNextPageId(page_id_t next_page_id) { this->next_page_id_ = next_page_id; }
+  int KeyIndex(const KeyType &key, const KeyComparator &comparator) const;
+
+  // whether key can be inserted without a split, the compressed version of
+  // IsSafe(OpType::INSERT)
+  bool IsSafeToInsert(const KeyType &key);
+
+  // insert and delete methods
+  int Insert(const KeyType &key, const ValueType &value,
+             const KeyComparator &comparator);
+  bool Lookup(const KeyType &key, ValueType &value,
+              const KeyComparator &comparator) const;
+  int RemoveAndDeleteRecord(const KeyType &key,
+                            const KeyComparator &comparator);
+  // Split and Merge utility methods
+  void MoveHalfTo(BPlusTreeCompressedLeafPage *recipient,
+                  BufferPoolManager *buffer_pool_manager /* Unused */);
+  bool MoveAllTo(BPlusTreeCompressedLeafPage *recipient, int /* Unused */,
+                 BufferPoolManager * /* Unused */);
+  bool MoveFirstToEndOf(BPlusTreeCompressedLeafPage *recipient,
+                        BufferPoolManager *buffer_pool_manager);
+  // index_in_parent is this page's index in the parent, or -1 to look it up
+  bool MoveFirstToEndOf(BPlusTreeCompressedLeafPage *recipient, int index_in_parent,
+                        BufferPoolManager *buffer_pool_manager);
+  bool MoveLastToFrontOf(BPlusTreeCompressedLeafPage *recipient, int parentIndex,
+                         BufferPoolManager *buffer_pool_manager);
+  // with the parent passed in, e.g. from a BPlusTreePath, instead of fetched
+  bool MoveFirstToEndOf(
+      BPlusTreeCompressedLeafPage *recipient,
+      BPlusTreeCompressedInternalPage<KeyType, page_id_t, KeyComparator> *parent,
+      int index_in_parent);
+  bool MoveLastToFrontOf(
+      BPlusTreeCompressedLeafPage *recipient,
+      BPlusTreeCompressedInternalPage<KeyType, page_id_t, KeyComparator> *parent,
+      int parentIndex);
+};
+
+} // namespace scudb
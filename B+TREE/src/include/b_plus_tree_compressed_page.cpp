@@ -0,0 +1,98 @@
+/**
+ * b_plus_tree_compressed_page.h
+ *
+ * Alternative page layout for wide keys, shared by compressed leaf and
+ * internal pages. Instead of whole keys, each entry stores only the middle
+ * bytes of its key: the bytes before prefix_size are common to every key in
+ * the page and are kept once in template_, and the last suffix_zeros bytes
+ * are zero in every key in the page and are not kept at all. Internal pages
+ * get long zero tails from splits, whose separators are truncated by
+ * ShortestSeparator. Fanout is computed from the stored entry size, so it
+ * grows with compression.
+ *
+ * Compressed page format (keys are stored in order):
+ *  ----------------------------------------------------------------------------
+ * | HEADER | MIDDLE(1) + VALUE(1) | MIDDLE(2) + VALUE(2) | ... | MIDDLE(n) + VALUE(n)
+ *  ----------------------------------------------------------------------------
+ *
+ *  Header format (size in byte, 36 bytes + sizeof(KeyType) in total):
+ *  ----------------------------------------------------------------------------
+ * | BPlusTreePage header (28) | NextPageId (4) | PrefixSize (2) | SuffixZeros (2) |
+ *  ----------------------------------------------------------------------------
+ *  -----------------------------
+ * | Template (sizeof(KeyType)) |
+ *  -----------------------------
+ *
+ * The encoding only removes bytes that are the same in all keys, so it works
+ * with any comparator. A key that does not share them widens the encoding
+ * and re-encodes the page, which may then not have room for it; inserts
+ * return -1 in that case and the page has to be split first.
+ */
+#pragma once
+
+#include <vector>
+
+#include "page/b_plus_tree_page.h"
+
+namespace scudb {
+
+#define B_PLUS_TREE_COMPRESSED_PAGE_TYPE                                       \
+  BPlusTreeCompressedPage<KeyType, ValueType, KeyComparator>
+
+INDEX_TEMPLATE_ARGUMENTS
+class BPlusTreeCompressedPage : public BPlusTreePage {
+public:
+  KeyType KeyAt(int index) const;
+  ValueType ValueAt(int index) const;
+  int GetPrefixSize() const { return prefix_size_; }
+  int GetSuffixZeros() const { return suffix_zeros_; }
+  // entries the page can hold once key is admitted
+  int MaxEntriesWith(const KeyType &key) const;
+
+  // the shortest key s with left < s <= right that is right with a zeroed
+  // tail, to separate two pages after a split
+  static KeyType ShortestSeparator(const KeyType &left, const KeyType &right,
+                                   const KeyComparator &comparator);
+
+protected:
+  void InitCompression();
+  int EntrySize() const;
+  int MaxEntries(int prefix_size, int suffix_zeros) const;
+  // 0 for leaves; the first key of an internal page is invalid and is not
+  // taken into account by the encoding
+  int FirstKeyIndex() const { return IsLeafPage() ? 0 : 1; }
+
+  // widen the encoding so that key can be stored; false, with the page
+  // unchanged, if extra more entries would then not fit
+  bool Admit(const KeyType &key, int extra);
+  // replace all entries by items, in the narrowest encoding for them; false,
+  // with the page unchanged, if they do not fit
+  bool Assign(const std::vector<MappingType> &items);
+  std::vector<MappingType> Entries(int begin, int end) const;
+  // narrowest encoding for the keys in the page
+  void Recompress();
+
+  // the key must already be admitted
+  void InsertAt(int index, const KeyType &key, const ValueType &value);
+  void RemoveAt(int index);
+  void SetValueAt(int index, const ValueType &value);
+
+private:
+  char *EntryAt(int index) { return entries_ + index * EntrySize(); }
+  const char *EntryAt(int index) const { return entries_ + index * EntrySize(); }
+  void Encode(char *entry, const KeyType &key, const ValueType &value) const;
+  void WidenFor(const KeyType &key, int &prefix_size, int &suffix_zeros) const;
+  void Reencode(int prefix_size, int suffix_zeros);
+  void UpdateMaxSize();
+
+protected:
+  page_id_t next_page_id_; // leaf pages only
+
+private:
+  uint16_t prefix_size_;
+  uint16_t suffix_zeros_;
+  KeyType template_; // the common prefix, then anything, then zeros
+  char entries_[0];
+};
+
+} // namespace scudb
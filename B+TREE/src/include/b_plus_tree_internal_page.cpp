@@ -36,13 +36,22 @@ public:
   KeyType KeyAt(int index) const;
   void SetKeyAt(int index, const KeyType &key);
   int ValueIndex(const ValueType &value) const;
+  // hint first, e.g. a slot from BPlusTreePath; a scan only if it is stale
+  int ValueIndex(const ValueType &value, int hint) const;
   ValueType ValueAt(int index) const;
 
   ValueType Lookup(const KeyType &key, const KeyComparator &comparator) const;
+  // index of the child Lookup returns, for BPlusTreePath
+  int LookupIndex(const KeyType &key, const KeyComparator &comparator) const;
   void PopulateNewRoot(const ValueType &old_value, const KeyType &new_key,
                        const ValueType &new_value);
   int InsertNodeAfter(const ValueType &old_value, const KeyType &new_key,
                       const ValueType &new_value);
+  // insert at index, one after the split child's index in this page
+  int InsertNodeAt(int index, const KeyType &new_key,
+                   const ValueType &new_value);
+  // append after the last entry, for pages filled left to right
+  int Append(const KeyType &key, const ValueType &value);
   void Remove(int index);
   ValueType RemoveAndReturnOnlyChild();
 
@@ -50,11 +59,28 @@ public:
                   BufferPoolManager *buffer_pool_manager);
   void MoveAllTo(BPlusTreeInternalPage *recipient, int index_in_parent,
                  BufferPoolManager *buffer_pool_manager);
+  // Redistribution rotates a child through the parent: the separator in the
+  // parent comes down with the moved child (to the key of the recipient's
+  // former first child when moving to its front) and the new boundary key
+  // goes up. The unused first key of the page is not read.
   void MoveFirstToEndOf(BPlusTreeInternalPage *recipient,
                         BufferPoolManager *buffer_pool_manager);
+  // index_in_parent is this page's index in the parent, or -1 to look it up
+  void MoveFirstToEndOf(BPlusTreeInternalPage *recipient, int index_in_parent,
+                        BufferPoolManager *buffer_pool_manager);
   void MoveLastToFrontOf(BPlusTreeInternalPage *recipient,
                          int parent_index,
                          BufferPoolManager *buffer_pool_manager);
+
+  // For parent links taken from a BPlusTreePath: the moved children are not
+  // fetched and keep their old parent_page_id_, and the parent is passed in
+  // instead of being fetched (see b_plus_tree_page.h)
+  void MoveHalfTo(BPlusTreeInternalPage *recipient);
+  void MoveAllTo(BPlusTreeInternalPage *recipient, const KeyType &middle_key);
+  void MoveFirstToEndOf(BPlusTreeInternalPage *recipient,
+                        BPlusTreeInternalPage *parent, int index_in_parent);
+  void MoveLastToFrontOf(BPlusTreeInternalPage *recipient,
+                         BPlusTreeInternalPage *parent, int parent_index);
   // DEUBG and PRINT
   std::string ToString(bool verbose) const;
   void QueueUpChildren(std::queue<BPlusTreePage *> *queue,
@@ -67,8 +93,8 @@ private:
                    BufferPoolManager *buffer_pool_manager);
   void CopyLastFrom(const MappingType &pair,
                     BufferPoolManager *buffer_pool_manager);
-  void CopyFirstFrom(const MappingType &pair, int parent_index,
-                     BufferPoolManager *buffer_pool_manager);
+  void CopyFirstFrom(const MappingType &pair);
+  void AdoptChildren(int begin, int end, BufferPoolManager *buffer_pool_manager);
   MappingType array[0];
 };
 } // namespace scudb
@@ -10,13 +10,13 @@
  * | HEADER | KEY(1) + RID(1) | KEY(2) + RID(2) | ... | KEY(n) + RID(n)
  *  ----------------------------------------------------------------------
  *
- *  Header format (size in byte, 24 bytes in total):
+ *  Header format (size in byte, 32 bytes in total):
  *  ---------------------------------------------------------------------
- * | PageType (4) | CurrentSize (4) | MaxSize (4) | ParentPageId (4) |
+ * | PageType (4) | LSN (4) | CurrentSize (4) | MaxSize (4) |
  *  ---------------------------------------------------------------------
- *  ------------------------------
- * | PageId (4) | NextPageId (4)
- *  ------------------------------
+ *  -----------------------------------------------------------------
+ * | ParentPageId (4) | PageId (4) | Version (4) | NextPageId (4)
+ *  -----------------------------------------------------------------
  */
 #pragma once
 #include <utility>
@@ -28,6 +28,8 @@ namespace scudb {
 #define B_PLUS_TREE_LEAF_PAGE_TYPE                                             \
   BPlusTreeLeafPage<KeyType, ValueType, KeyComparator>
 
+INDEX_TEMPLATE_ARGUMENTS class BPlusTreeInternalPage;
+
 INDEX_TEMPLATE_ARGUMENTS
 class BPlusTreeLeafPage : public BPlusTreePage {
 
@@ -45,6 +47,8 @@ public:
   // insert and delete methods
   int Insert(const KeyType &key, const ValueType &value,
              const KeyComparator &comparator);
+  int InsertMany(const MappingType *items, int count,
+                 const KeyComparator &comparator);
   bool Lookup(const KeyType &key, ValueType &value,
               const KeyComparator &comparator) const;
   int RemoveAndDeleteRecord(const KeyType &key,
@@ -56,8 +60,18 @@ public:
                  BufferPoolManager * /* Unused */);
   void MoveFirstToEndOf(BPlusTreeLeafPage *recipient,
                         BufferPoolManager *buffer_pool_manager);
+  // index_in_parent is this page's index in the parent, or -1 to look it up
+  void MoveFirstToEndOf(BPlusTreeLeafPage *recipient, int index_in_parent,
+                        BufferPoolManager *buffer_pool_manager);
   void MoveLastToFrontOf(BPlusTreeLeafPage *recipient, int parentIndex,
                          BufferPoolManager *buffer_pool_manager);
+  // with the parent passed in, e.g. from a BPlusTreePath, instead of fetched
+  void MoveFirstToEndOf(BPlusTreeLeafPage *recipient,
+                        BPlusTreeInternalPage<KeyType, page_id_t, KeyComparator> *parent,
+                        int index_in_parent);
+  void MoveLastToFrontOf(BPlusTreeLeafPage *recipient,
+                         BPlusTreeInternalPage<KeyType, page_id_t, KeyComparator> *parent,
+                         int parentIndex);
   // Debug
   std::string ToString(bool verbose = false) const;
 
@@ -65,8 +79,7 @@ private:
   void CopyHalfFrom(MappingType *items, int size);
   void CopyAllFrom(MappingType *items, int size);
   void CopyLastFrom(const MappingType &item);
-  void CopyFirstFrom(const MappingType &item, int parentIndex,
-                     BufferPoolManager *buffer_pool_manager);
+  void CopyFirstFrom(const MappingType &item);
   page_id_t next_page_id_;
   MappingType array[0];
 };
@@ -0,0 +1,75 @@
+/**
+ * b_plus_tree_optimistic_descent.h
+ *
+ * Find the leaf for a key with optimistic lock coupling: internal pages are
+ * pinned but never latched, and are read between two loads of their version
+ * (see b_plus_tree_page.h). A child id is used only after the parent's
+ * version is validated, and a child is entered only after the parent is
+ * validated again, so a descent that reaches the leaf followed a path that
+ * was consistent at every step. Only the leaf is latched, shared for READ and
+ * exclusive for INSERT and DELETE; writers have to latch tree pages with
+ * BPlusTreePage::WLatch, which keeps a page odd for the whole latch.
+ *
+ * A version mismatch restarts the descent from the root. After max_restarts
+ * restarts, or when a write would split or merge the leaf, FindLeaf returns
+ * nullptr and the caller falls back to latch crabbing from the root.
+ */
+#pragma once
+
+#include <atomic>
+
+#include "buffer/buffer_pool_manager.h"
+#include "index/b_plus_tree_path.h"
+#include "page/b_plus_tree_internal_page.h"
+#include "page/b_plus_tree_leaf_page.h"
+
+namespace scudb {
+
+#define B_PLUS_TREE_OPTIMISTIC_DESCENT_TYPE                                    \
+  BPlusTreeOptimisticDescent<KeyType, ValueType, KeyComparator>
+
+INDEX_TEMPLATE_ARGUMENTS
+class BPlusTreeOptimisticDescent {
+public:
+  BPlusTreeOptimisticDescent(BufferPoolManager *buffer_pool_manager,
+                             const KeyComparator &comparator,
+                             int max_restarts = 4);
+
+  // the leaf page that should hold key, pinned and latched, or nullptr if the
+  // caller has to crab: too many restarts, root_page_id is no longer the
+  // root, or the leaf is not safe for op. If path is given, it is filled with
+  // the internal pages of the descent that found the leaf; they are not
+  // latched, so use its slots as hints (see b_plus_tree_path.h)
+  Page *FindLeaf(page_id_t root_page_id, const KeyType &key, OpType op,
+                 BPlusTreePath *path = nullptr);
+
+  // unlatch and unpin a page returned by FindLeaf
+  void ReleaseLeaf(Page *page, OpType op, bool is_dirty);
+
+  // descents restarted on a version mismatch, since construction
+  size_t GetRestarts() const { return restarts_.load(std::memory_order_relaxed); }
+  // FindLeaf calls that returned nullptr
+  size_t GetFallbacks() const { return fallbacks_.load(std::memory_order_relaxed); }
+
+private:
+  enum class Result { FOUND = 0, RESTART, FALLBACK };
+  typedef BPlusTreeInternalPage<KeyType, page_id_t, KeyComparator> InternalPage;
+
+  Result Descend(page_id_t root_page_id, const KeyType &key, OpType op,
+                 Page *&leaf, BPlusTreePath *path);
+  // whether an unlatched internal page can be searched without reading past
+  // the end of the page; its contents still have to be validated
+  bool IsSearchable(const BPlusTreePage *node) const;
+  // the page's version once it is even, recovering one read from disk
+  uint32_t ReadVersion(Page *page);
+  void Latch(Page *page, OpType op);
+  void Unlatch(Page *page, OpType op);
+
+  BufferPoolManager *buffer_pool_manager_;
+  KeyComparator comparator_;
+  int max_restarts_;
+  std::atomic<size_t> restarts_;
+  std::atomic<size_t> fallbacks_;
+};
+
+} // namespace scudb
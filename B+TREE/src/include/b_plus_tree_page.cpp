@@ -6,24 +6,48 @@
  * It actually serves as a header part for each B+ tree page and
  * contains information shared by both leaf page and internal page.
  *
- * Header format (size in byte, 20 bytes in total):
+ * Header format (size in byte, 28 bytes in total):
  * ----------------------------------------------------------------------------
  * | PageType (4) | LSN (4) | CurrentSize (4) | MaxSize (4) |
  * ----------------------------------------------------------------------------
- * | ParentPageId (4) | PageId(4) |
+ * | ParentPageId (4) | PageId(4) | Version (4) |
  * ----------------------------------------------------------------------------
+ *
+ * Version is for optimistic lock coupling: it is odd while a writer is
+ * changing the page and moves to the next even value when it is done, so a
+ * reader that saw the same even version before and after reading the page
+ * without a latch read a consistent page. Writers latch tree pages with
+ * BPlusTreePage::WLatch and WUnlatch, which keep the version odd for as long
+ * as the page is write-latched, so a change that takes several page methods
+ * (a split, a merge, a new parent id) is never seen half done. Page methods
+ * themselves do not touch the version: a page being built before it is
+ * reachable, like a new sibling or a bulk-loaded page, needs no latch.
+ *
+ * Init resets the version, so initialize a page before latching it. A page
+ * flushed while write-latched comes back from disk with an odd version and
+ * no writer; RecoverVersion, called with the page latched shared, moves it on
+ * to the next even value.
+ *
+ * ParentPageId is kept up to date by the split, merge and redistribute
+ * methods that take a BufferPoolManager, which fetch and dirty every child
+ * they move to another page. A tree that finds parents with BPlusTreePath
+ * uses the overloads without one instead, which touch only the pages passed
+ * in. Its ParentPageId is then only meaningful as INVALID_PAGE_ID for the
+ * root, which the tree sets itself when it adds or removes a root.
  */
 
 #pragma once
 
 #include <cassert>
 #include <climits>
+#include <cstdint>
 #include <cstdlib>
 #include <string>
 
 
 #include "buffer/buffer_pool_manager.h"
 #include "index/generic_key.h"
+#include "index/normalized_key.h"
 
 namespace scudb {
 
@@ -59,6 +83,21 @@ public:
   void SetLSN(lsn_t lsn = INVALID_LSN);
 
   bool IsSafe(OpType op);
+
+  // optimistic readers
+  uint32_t ReadVersion() const;
+  bool ValidateVersion(uint32_t version) const;
+  // writers, with the page write-latched
+  void BeginWrite();
+  void EndWrite();
+  // a new page, which no one can be reading yet
+  void ResetVersion();
+  // an odd version under a shared latch has no writer behind it
+  void RecoverVersion();
+
+  // write latch a tree page, with its version odd until WUnlatch
+  static void WLatch(Page *page);
+  static void WUnlatch(Page *page);
 private:
   // member variable, attributes that both internal and leaf page share
   IndexPageType page_type_;
@@ -67,7 +106,7 @@ private:
   int max_size_;
   page_id_t parent_page_id_;
   page_id_t page_id_;
-
+  uint32_t version_;
 };
 
 } // namespace scudb
@@ -0,0 +1,66 @@
+/**
+ * b_plus_tree_path.h
+ *
+ * The internal pages a descent went through, root first, each with the slot
+ * of the child it took. A split, merge or redistribution of a page then finds
+ * its parent and its own index there from the path, instead of reading
+ * parent_page_id_ and scanning the parent with ValueIndex:
+ *
+ *  - a split of the page below the path inserts the new sibling at
+ *    GetIndexInParent() + 1 of GetParentPageId(), then Pop()s to continue
+ *    upwards with the parent
+ *  - the left sibling of a page is at GetIndexInParent() - 1 and the right
+ *    one at GetIndexInParent() + 1, which is also the index of the key that
+ *    separates the two
+ *
+ * With the page methods that take the parent instead of fetching it, the
+ * path replaces parent_page_id_ altogether (see b_plus_tree_page.h).
+ *
+ * The leaf is not on the path. Slots stay valid while the pages on the path
+ * are latched; for a path from an unlatched descent, pass the slot as the
+ * hint of ValueIndex(value, hint), which checks it before scanning.
+ */
+#pragma once
+
+#include <vector>
+
+#include "page/b_plus_tree_page.h"
+
+namespace scudb {
+
+class BPlusTreePath {
+public:
+  struct Entry {
+    page_id_t page_id;
+    int slot;
+  };
+
+  void Clear() { entries_.clear(); }
+  void Push(page_id_t page_id, int slot) { entries_.push_back({page_id, slot}); }
+  void Pop() {
+    assert(!entries_.empty());
+    entries_.pop_back();
+  }
+  bool IsEmpty() const { return entries_.empty(); }
+  // number of internal pages on the path
+  int GetDepth() const { return static_cast<int>(entries_.size()); }
+
+  page_id_t PageAt(int depth) const { return At(depth).page_id; }
+  int SlotAt(int depth) const { return At(depth).slot; }
+
+  // the parent of the page below the path and that page's index in it
+  page_id_t GetParentPageId() const {
+    return entries_.empty() ? INVALID_PAGE_ID : entries_.back().page_id;
+  }
+  int GetIndexInParent() const { return At(GetDepth() - 1).slot; }
+
+private:
+  const Entry &At(int depth) const {
+    assert(depth >= 0 && depth < GetDepth());
+    return entries_[depth];
+  }
+
+  std::vector<Entry> entries_;
+};
+
+} // namespace scudb
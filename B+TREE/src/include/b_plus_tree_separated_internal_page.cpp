@@ -0,0 +1,78 @@
+/**
+ * b_plus_tree_separated_internal_page.h
+ *
+ * Internal page in the separated layout (see b_plus_tree_separated_page.h),
+ * with the same operations as BPlusTreeInternalPage. The first key is
+ * invalid and is skipped by searches.
+ */
+#pragma once
+
+#include <queue>
+#include <string>
+
+#include "page/b_plus_tree_separated_page.h"
+
+namespace scudb {
+
+#define B_PLUS_TREE_SEPARATED_INTERNAL_PAGE_TYPE                               \
+  BPlusTreeSeparatedInternalPage<KeyType, ValueType, KeyComparator>
+
+INDEX_TEMPLATE_ARGUMENTS
+class BPlusTreeSeparatedInternalPage
+    : public BPlusTreeSeparatedPage<KeyType, ValueType, KeyComparator> {
+public:
+  void Init(page_id_t page_id, page_id_t parent_id = INVALID_PAGE_ID);
+  void SetKeyAt(int index, const KeyType &key);
+  int ValueIndex(const ValueType &value) const;
+  // hint first, e.g. a slot from BPlusTreePath
+  int ValueIndex(const ValueType &value, int hint) const;
+
+  // insertion related
+  ValueType Lookup(const KeyType &key, const KeyComparator &comparator) const;
+  int LookupIndex(const KeyType &key, const KeyComparator &comparator) const;
+  void PopulateNewRoot(const ValueType &old_value, const KeyType &new_key,
+                       const ValueType &new_value);
+  int InsertNodeAfter(const ValueType &old_value, const KeyType &new_key,
+                      const ValueType &new_value);
+  int InsertNodeAt(int index, const KeyType &new_key,
+                   const ValueType &new_value);
+
+  // remove related
+  void Remove(int index);
+  ValueType RemoveAndReturnOnlyChild();
+
+  // Split and Merge utility methods
+  void MoveHalfTo(BPlusTreeSeparatedInternalPage *recipient,
+                  BufferPoolManager *buffer_pool_manager);
+  void MoveAllTo(BPlusTreeSeparatedInternalPage *recipient, int index_in_parent,
+                 BufferPoolManager *buffer_pool_manager);
+  void MoveFirstToEndOf(BPlusTreeSeparatedInternalPage *recipient,
+                        BufferPoolManager *buffer_pool_manager);
+  // index_in_parent is this page's index in the parent, or -1 to look it up
+  void MoveFirstToEndOf(BPlusTreeSeparatedInternalPage *recipient,
+                        int index_in_parent,
+                        BufferPoolManager *buffer_pool_manager);
+  void MoveLastToFrontOf(BPlusTreeSeparatedInternalPage *recipient,
+                         int parent_index,
+                         BufferPoolManager *buffer_pool_manager);
+  // for parent links from a BPlusTreePath, as in BPlusTreeInternalPage
+  void MoveHalfTo(BPlusTreeSeparatedInternalPage *recipient);
+  void MoveAllTo(BPlusTreeSeparatedInternalPage *recipient,
+                 const KeyType &middle_key);
+  void MoveFirstToEndOf(BPlusTreeSeparatedInternalPage *recipient,
+                        BPlusTreeSeparatedInternalPage *parent,
+                        int index_in_parent);
+  void MoveLastToFrontOf(BPlusTreeSeparatedInternalPage *recipient,
+                         BPlusTreeSeparatedInternalPage *parent,
+                         int parent_index);
+
+  // DEUBG and PRINT
+  std::string ToString(bool verbose) const;
+  void QueueUpChildren(std::queue<BPlusTreePage *> *queue,
+                       BufferPoolManager *buffer_pool_manager);
+
+private:
+  void AdoptChildren(int begin, int end, BufferPoolManager *buffer_pool_manager);
+};
+
+} // namespace scudb
@@ -0,0 +1,66 @@
+/**
+ * b_plus_tree_separated_leaf_page.h
+ *
+ * Leaf page in the separated layout (see b_plus_tree_separated_page.h), with
+ * the same operations as BPlusTreeLeafPage. GetItem returns a copy, since a
+ * key and its value are not stored next to each other.
+ */
+#pragma once
+
+#include <string>
+#include <utility>
+
+#include "page/b_plus_tree_separated_page.h"
+
+namespace scudb {
+
+INDEX_TEMPLATE_ARGUMENTS class BPlusTreeSeparatedInternalPage;
+
+#define B_PLUS_TREE_SEPARATED_LEAF_PAGE_TYPE                                   \
+  BPlusTreeSeparatedLeafPage<KeyType, ValueType, KeyComparator>
+
+INDEX_TEMPLATE_ARGUMENTS
+class BPlusTreeSeparatedLeafPage
+    : public BPlusTreeSeparatedPage<KeyType, ValueType, KeyComparator> {
+public:
+  void Init(page_id_t page_id, page_id_t parent_id = INVALID_PAGE_ID);
+  page_id_t GetNextPageId() const { return this->next_page_id_; }
+  void SetNextPageId(page_id_t next_page_id) { this->next_page_id_ = next_page_id; }
+  int KeyIndex(const KeyType &key, const KeyComparator &comparator) const {
+    return this->LowerBound(key, comparator, 0);
+  }
+  MappingType GetItem(int index) const;
+
+  // insert and delete methods
+  int Insert(const KeyType &key, const ValueType &value,
+             const KeyComparator &comparator);
+  bool Lookup(const KeyType &key, ValueType &value,
+              const KeyComparator &comparator) const;
+  int RemoveAndDeleteRecord(const KeyType &key,
+                            const KeyComparator &comparator);
+  // Split and Merge utility methods
+  void MoveHalfTo(BPlusTreeSeparatedLeafPage *recipient,
+                  BufferPoolManager *buffer_pool_manager /* Unused */);
+  void MoveAllTo(BPlusTreeSeparatedLeafPage *recipient, int /* Unused */,
+                 BufferPoolManager * /* Unused */);
+  void MoveFirstToEndOf(BPlusTreeSeparatedLeafPage *recipient,
+                        BufferPoolManager *buffer_pool_manager);
+  // index_in_parent is this page's index in the parent, or -1 to look it up
+  void MoveFirstToEndOf(BPlusTreeSeparatedLeafPage *recipient, int index_in_parent,
+                        BufferPoolManager *buffer_pool_manager);
+  void MoveLastToFrontOf(BPlusTreeSeparatedLeafPage *recipient, int parentIndex,
+                         BufferPoolManager *buffer_pool_manager);
+  // with the parent passed in, e.g. from a BPlusTreePath, instead of fetched
+  void MoveFirstToEndOf(
+      BPlusTreeSeparatedLeafPage *recipient,
+      BPlusTreeSeparatedInternalPage<KeyType, page_id_t, KeyComparator> *parent,
+      int index_in_parent);
+  void MoveLastToFrontOf(
+      BPlusTreeSeparatedLeafPage *recipient,
+      BPlusTreeSeparatedInternalPage<KeyType, page_id_t, KeyComparator> *parent,
+      int parentIndex);
+  // Debug
+  std::string ToString(bool verbose = false) const;
+};
+
+} // namespace scudb
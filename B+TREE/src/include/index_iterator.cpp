@@ -3,6 +3,8 @@
  * For range scan of b+ tree
  */
 #pragma once
+#include <algorithm>
+
 #include "page/b_plus_tree_leaf_page.h"
 
 namespace scudb {
@@ -33,7 +35,16 @@ public:
       if (next == INVALID_PAGE_ID) {
         leaf_ = nullptr;
       } else {
+        AdaptReadAhead(bufferPoolManager_->PrefetchPage(next));
         Page *page = bufferPoolManager_->FetchPage(next);
+        if (ahead_ > 0) {
+          ahead_--;
+        } else {
+          tail_ = next;
+        }
+        // no latch is held here, so peeking at the leaves ahead cannot
+        // deadlock with a writer that latches a left sibling
+        ReadAhead();
         page->RLatch();
         leaf_ = reinterpret_cast<B_PLUS_TREE_LEAF_PAGE_TYPE *>(page->GetData());
         index_ = 0;
@@ -44,6 +55,21 @@ public:
 
 private:
   // add your own private member variables here
+  static const int MAX_READ_AHEAD = 32;
+
+  // a leaf that was not resident on arrival means the scan outruns the
+  // prefetches: double the window. depth_ hits in a row mean the window is
+  // more than enough: shrink it by one.
+  void AdaptReadAhead(bool resident) {
+    if (!resident) {
+      depth_ = std::min(depth_ * 2, MAX_READ_AHEAD);
+      hits_ = 0;
+    } else if (++hits_ >= depth_) {
+      depth_ = std::max(depth_ - 1, 1);
+      hits_ = 0;
+    }
+  }
+  void ReadAhead();
   void UnlockAndUnPin() {
     bufferPoolManager_->FetchPage(leaf_->GetPageId())->RUnlatch();
     bufferPoolManager_->UnpinPage(leaf_->GetPageId(), false);
@@ -52,6 +78,12 @@ private:
   int index_;
   B_PLUS_TREE_LEAF_PAGE_TYPE *leaf_;
   BufferPoolManager *bufferPoolManager_;
+  // read-ahead window: tail_ is the last leaf handed to PrefetchPage (or the
+  // current leaf), ahead_ how many leaves past the current one were requested
+  page_id_t tail_;
+  int ahead_;
+  int depth_;
+  int hits_;
 };
 
 } // namespace scudb
@@ -0,0 +1,163 @@
+/**
+ * normalized_key.h
+ *
+ * Index key kept in a normalized, memcmp-orderable encoding, as an
+ * alternative to GenericKey. Two keys compare like their bytes do, so
+ * NormalizedComparator does not need the key schema and does not decode the
+ * key column by column the way GenericComparator does; 4 and 8 byte keys
+ * compare as a single integer each.
+ *
+ * Columns are appended in key order with NormalizedKeyBuilder:
+ *  - integers: big endian with the sign bit flipped
+ *  - doubles: big endian with the sign bit flipped for positive values and
+ *    all bits flipped for negative ones
+ *  - strings: bytes padded with zeros to a fixed width; they must not
+ *    contain '\0', and longer strings are truncated
+ *
+ * Because byte order is key order, the keys also suit prefix compression
+ * (b_plus_tree_compressed_page.h), whose separators are then as short as
+ * the keys allow.
+ */
+#pragma once
+
+#include <cassert>
+#include <cstdint>
+#include <cstring>
+#include <ostream>
+
+namespace scudb {
+
+class Schema;
+
+template <size_t KeySize> class NormalizedKey;
+
+template <size_t KeySize> class NormalizedKeyBuilder {
+public:
+  explicit NormalizedKeyBuilder(NormalizedKey<KeySize> *key)
+      : key_(key), offset_(0) {
+    memset(key_->data, 0, KeySize);
+  }
+
+  // width is 1, 2, 4 or 8 bytes
+  NormalizedKeyBuilder &AppendInteger(int64_t value, size_t width) {
+    assert(width == 1 || width == 2 || width == 4 || width == 8);
+    uint64_t bits = static_cast<uint64_t>(value) ^ (1ULL << (width * 8 - 1));
+    return Put(bits, width);
+  }
+
+  NormalizedKeyBuilder &AppendDouble(double value) {
+    if (value == 0) {
+      value = 0; // -0.0 and 0.0 compare equal
+    }
+    uint64_t bits;
+    memcpy(&bits, &value, sizeof(bits));
+    bits = (bits >> 63) ? ~bits : bits ^ (1ULL << 63);
+    return Put(bits, sizeof(bits));
+  }
+
+  NormalizedKeyBuilder &AppendString(const char *str, size_t length,
+                                     size_t width) {
+    assert(offset_ + width <= KeySize);
+    memcpy(key_->data + offset_, str, length < width ? length : width);
+    offset_ += width;
+    return *this;
+  }
+
+private:
+  // the low width bytes of bits, most significant first
+  NormalizedKeyBuilder &Put(uint64_t bits, size_t width) {
+    assert(offset_ + width <= KeySize);
+    for (size_t i = 0; i < width; i++) {
+      key_->data[offset_ + i] = static_cast<char>(bits >> ((width - 1 - i) * 8));
+    }
+    offset_ += width;
+    return *this;
+  }
+
+  NormalizedKey<KeySize> *key_;
+  size_t offset_;
+};
+
+template <size_t KeySize> class NormalizedKey {
+public:
+  // a single integer column as wide as the key, up to 8 bytes
+  inline void SetFromInteger(int64_t key) {
+    NormalizedKeyBuilder<KeySize>(this).AppendInteger(key, Width());
+  }
+
+  // inverse of SetFromInteger
+  inline int64_t ToInteger() const {
+    uint64_t bits = 0;
+    for (size_t i = 0; i < Width(); i++) {
+      bits = (bits << 8) | static_cast<unsigned char>(data[i]);
+    }
+    bits ^= 1ULL << (Width() * 8 - 1);
+    // sign extend
+    int shift = static_cast<int>(64 - Width() * 8);
+    return static_cast<int64_t>(bits << shift) >> shift;
+  }
+
+  // named after GenericKey::ToString, for debug output
+  inline int64_t ToString() const { return ToInteger(); }
+
+  friend std::ostream &operator<<(std::ostream &os, const NormalizedKey &key) {
+    os << key.ToString();
+    return os;
+  }
+
+  char data[KeySize];
+
+private:
+  static size_t Width() { return KeySize < 8 ? (KeySize < 4 ? 1 : 4) : 8; }
+};
+
+// keys that fit in an integer load as one, most significant byte first
+template <size_t KeySize> struct NormalizedCompare {
+  static int Compare(const char *lhs, const char *rhs) {
+    return memcmp(lhs, rhs, KeySize);
+  }
+};
+
+template <> struct NormalizedCompare<4> {
+  static int Compare(const char *lhs, const char *rhs) {
+    uint32_t a = Load(lhs), b = Load(rhs);
+    return (a > b) - (a < b);
+  }
+  static uint32_t Load(const char *p) {
+    uint32_t v;
+    memcpy(&v, p, sizeof(v));
+#if __BYTE_ORDER__ == __ORDER_LITTLE_ENDIAN__
+    v = __builtin_bswap32(v);
+#endif
+    return v;
+  }
+};
+
+template <> struct NormalizedCompare<8> {
+  static int Compare(const char *lhs, const char *rhs) {
+    uint64_t a = Load(lhs), b = Load(rhs);
+    return (a > b) - (a < b);
+  }
+  static uint64_t Load(const char *p) {
+    uint64_t v;
+    memcpy(&v, p, sizeof(v));
+#if __BYTE_ORDER__ == __ORDER_LITTLE_ENDIAN__
+    v = __builtin_bswap64(v);
+#endif
+    return v;
+  }
+};
+
+template <size_t KeySize> class NormalizedComparator {
+public:
+  inline int operator()(const NormalizedKey<KeySize> &lhs,
+                        const NormalizedKey<KeySize> &rhs) const {
+    return NormalizedCompare<KeySize>::Compare(lhs.data, rhs.data);
+  }
+
+  NormalizedComparator() = default;
+  // for use in place of GenericComparator; the schema is not needed
+  explicit NormalizedComparator(Schema *) {}
+};
+
+} // namespace scudb
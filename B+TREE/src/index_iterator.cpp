@@ -13,7 +13,18 @@ namespace scudb {
  */
 INDEX_TEMPLATE_ARGUMENTS
 INDEXITERATOR_TYPE::IndexIterator(B_PLUS_TREE_LEAF_PAGE_TYPE *leaf, int index, BufferPoolManager *bufferPoolManager)
-: index_(index),leaf_(leaf), bufferPoolManager_(bufferPoolManager){}
+: index_(index),leaf_(leaf), bufferPoolManager_(bufferPoolManager),
+  tail_(INVALID_PAGE_ID), ahead_(0), depth_(1), hits_(0) {
+  // the caller holds the leaf latch, so only the next leaf is requested here;
+  // the window grows on later page crossings
+  if (leaf_ != nullptr) {
+    tail_ = leaf_->GetNextPageId();
+    if (tail_ != INVALID_PAGE_ID) {
+      bufferPoolManager_->PrefetchPage(tail_);
+      ahead_ = 1;
+    }
+  }
+}
 
 INDEX_TEMPLATE_ARGUMENTS
 INDEXITERATOR_TYPE::~IndexIterator() {
@@ -22,11 +33,45 @@ INDEXITERATOR_TYPE::~IndexIterator() {
   }
 }
 
+/*
+ * Extend the read-ahead window to depth_ leaves past the current one. The
+ * next pointer of tail_ is only read once tail_ is resident, so a slow
+ * prefetch stops the walk instead of blocking the scan. Called without any
+ * page latch held; each peeked leaf is latched on its own.
+ */
+INDEX_TEMPLATE_ARGUMENTS
+void INDEXITERATOR_TYPE::ReadAhead() {
+  while (ahead_ < depth_ && tail_ != INVALID_PAGE_ID) {
+    if (!bufferPoolManager_->PrefetchPage(tail_)) {
+      return;
+    }
+    Page *page = bufferPoolManager_->FetchPage(tail_);
+    if (page == nullptr) {
+      return;
+    }
+    page->RLatch();
+    page_id_t next =
+        reinterpret_cast<B_PLUS_TREE_LEAF_PAGE_TYPE *>(page->GetData())->GetNextPageId();
+    page->RUnlatch();
+    bufferPoolManager_->UnpinPage(tail_, false);
+    tail_ = next;
+    if (tail_ == INVALID_PAGE_ID) {
+      return;
+    }
+    bufferPoolManager_->PrefetchPage(tail_);
+    ahead_++;
+  }
+}
 
 template class IndexIterator<GenericKey<4>, RID, GenericComparator<4>>;
 template class IndexIterator<GenericKey<8>, RID, GenericComparator<8>>;
 template class IndexIterator<GenericKey<16>, RID, GenericComparator<16>>;
 template class IndexIterator<GenericKey<32>, RID, GenericComparator<32>>;
 template class IndexIterator<GenericKey<64>, RID, GenericComparator<64>>;
+template class IndexIterator<NormalizedKey<4>, RID, NormalizedComparator<4>>;
+template class IndexIterator<NormalizedKey<8>, RID, NormalizedComparator<8>>;
+template class IndexIterator<NormalizedKey<16>, RID, NormalizedComparator<16>>;
+template class IndexIterator<NormalizedKey<32>, RID, NormalizedComparator<32>>;
+template class IndexIterator<NormalizedKey<64>, RID, NormalizedComparator<64>>;
 
 } // namespace scudb
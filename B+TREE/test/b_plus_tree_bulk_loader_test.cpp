@@ -0,0 +1,237 @@
+/**
+ * b_plus_tree_bulk_loader_test.cpp
+ */
+
+#include <cstdio>
+#include <vector>
+
+#include "buffer/buffer_pool_manager.h"
+#include "common/exception.h"
+#include "common/rid.h"
+#include "index/b_plus_tree_bulk_loader.h"
+#include "page/header_page.h"
+#include "vtable/virtual_table.h"
+#include "gtest/gtest.h"
+
+namespace cmudb {
+
+typedef GenericKey<8> KeyType;
+typedef GenericComparator<8> ComparatorType;
+typedef BPlusTreeLeafPage<KeyType, RID, ComparatorType> LeafPage;
+typedef BPlusTreeInternalPage<KeyType, page_id_t, ComparatorType> InternalPage;
+typedef BPlusTreeBulkLoader<KeyType, RID, ComparatorType> BulkLoader;
+
+static KeyType MakeKey(int64_t value) {
+  KeyType key;
+  key.SetFromInteger(value);
+  return key;
+}
+
+static int64_t KeyValue(const KeyType &key) { return key.ToString(); }
+
+/*
+ * Checks the subtree under page_id, whose keys must be in [low, high), and
+ * returns the number of entries in it. Every page names parent_id as its
+ * parent and holds [min size, max size] entries, except that the root only
+ * needs one; all leaves are at the same depth; the separator of each child
+ * is the first key under it.
+ */
+static size_t CheckSubtree(BufferPoolManager *bpm, page_id_t page_id, page_id_t parent_id,
+                           int64_t low, int64_t high, int depth, int *leaf_depth,
+                           int64_t *first_key) {
+  auto *page = reinterpret_cast<BPlusTreePage *>(bpm->FetchPage(page_id)->GetData());
+  EXPECT_EQ(parent_id, page->GetParentPageId());
+  EXPECT_LE(page->GetSize(), page->GetMaxSize());
+  if (parent_id != INVALID_PAGE_ID) {
+    EXPECT_LE(page->GetMinSize(), page->GetSize());
+  } else {
+    EXPECT_LT(0, page->GetSize());
+  }
+  size_t count = 0;
+  if (page->IsLeafPage()) {
+    if (*leaf_depth < 0) {
+      *leaf_depth = depth;
+    }
+    EXPECT_EQ(*leaf_depth, depth);
+    auto *leaf = reinterpret_cast<LeafPage *>(page);
+    for (int i = 0; i < leaf->GetSize(); i++) {
+      int64_t key = KeyValue(leaf->KeyAt(i));
+      EXPECT_LE(low, key);
+      EXPECT_LT(key, high);
+    }
+    *first_key = KeyValue(leaf->KeyAt(0));
+    count = leaf->GetSize();
+  } else {
+    auto *internal = reinterpret_cast<InternalPage *>(page);
+    for (int i = 0; i < internal->GetSize(); i++) {
+      int64_t child_low = i == 0 ? low : KeyValue(internal->KeyAt(i));
+      int64_t child_high = i + 1 < internal->GetSize() ? KeyValue(internal->KeyAt(i + 1)) : high;
+      int64_t child_first;
+      count += CheckSubtree(bpm, internal->ValueAt(i), page_id, child_low, child_high, depth + 1,
+                            leaf_depth, &child_first);
+      if (i == 0) {
+        *first_key = child_first;
+      } else {
+        EXPECT_EQ(child_low, child_first);
+      }
+    }
+  }
+  bpm->UnpinPage(page_id, false);
+  return count;
+}
+
+// follows the leaf chain from the leftmost leaf, checks that keys increase
+// and returns them
+static std::vector<int64_t> ScanLeaves(BufferPoolManager *bpm, page_id_t root_id) {
+  page_id_t page_id = root_id;
+  auto *page = reinterpret_cast<BPlusTreePage *>(bpm->FetchPage(page_id)->GetData());
+  while (!page->IsLeafPage()) {
+    page_id_t child_id = reinterpret_cast<InternalPage *>(page)->ValueAt(0);
+    bpm->UnpinPage(page_id, false);
+    page_id = child_id;
+    page = reinterpret_cast<BPlusTreePage *>(bpm->FetchPage(page_id)->GetData());
+  }
+  std::vector<int64_t> keys;
+  while (true) {
+    auto *leaf = reinterpret_cast<LeafPage *>(page);
+    for (int i = 0; i < leaf->GetSize(); i++) {
+      keys.push_back(KeyValue(leaf->KeyAt(i)));
+      if (keys.size() > 1) {
+        EXPECT_LT(keys[keys.size() - 2], keys.back());
+      }
+    }
+    page_id_t next_id = leaf->GetNextPageId();
+    bpm->UnpinPage(page_id, false);
+    if (next_id == INVALID_PAGE_ID) {
+      break;
+    }
+    page_id = next_id;
+    page = reinterpret_cast<BPlusTreePage *>(bpm->FetchPage(page_id)->GetData());
+  }
+  return keys;
+}
+
+TEST(BPlusTreeBulkLoaderTest, LoadTest) {
+  Schema *key_schema = ParseCreateStatement("a bigint");
+  ComparatorType comparator(key_schema);
+  // max sizes as set by Init
+  const size_t leaf_max = (PAGE_SIZE - sizeof(LeafPage)) / sizeof(std::pair<KeyType, RID>) - 1;
+  const size_t internal_max =
+      (PAGE_SIZE - sizeof(InternalPage)) / sizeof(std::pair<KeyType, page_id_t>) - 1;
+  // empty, one entry, one full leaf, one over, and enough for three levels
+  std::vector<size_t> sizes{0, 1, leaf_max, leaf_max + 1, leaf_max * internal_max + 1};
+
+  for (double fill_factor : {1.0, 0.7, 0.5, 0.1}) {
+    for (size_t num_entries : sizes) {
+      DiskManager *disk_manager = new DiskManager("test.db");
+      BufferPoolManager *bpm = new BufferPoolManager(50, disk_manager);
+      page_id_t header_id;
+      static_cast<HeaderPage *>(bpm->NewPage(header_id))->Init();
+      EXPECT_EQ(HEADER_PAGE_ID, header_id);
+      bpm->UnpinPage(header_id, true);
+
+      BulkLoader loader(bpm, comparator, num_entries, fill_factor);
+      for (size_t i = 0; i < num_entries; i++) {
+        loader.Append(MakeKey(2 * i), RID(0, static_cast<int32_t>(i)));
+      }
+      page_id_t root_id = loader.Finish("index");
+
+      auto *header = static_cast<HeaderPage *>(bpm->FetchPage(HEADER_PAGE_ID));
+      page_id_t recorded_id;
+      EXPECT_EQ(true, header->GetRootId("index", recorded_id));
+      EXPECT_EQ(root_id, recorded_id);
+      bpm->UnpinPage(HEADER_PAGE_ID, false);
+
+      if (num_entries == 0) {
+        EXPECT_EQ(INVALID_PAGE_ID, root_id);
+        EXPECT_EQ(0, loader.GetHeight());
+      } else {
+        int leaf_depth = -1;
+        int64_t first_key;
+        EXPECT_EQ(num_entries, CheckSubtree(bpm, root_id, INVALID_PAGE_ID, 0, 2 * num_entries,
+                                            0, &leaf_depth, &first_key));
+        EXPECT_EQ(0, first_key);
+        EXPECT_EQ(loader.GetHeight(), leaf_depth + 1);
+        // below a fill factor of 1 even a full leaf's worth is spread over two
+        if (num_entries == 1 || (fill_factor == 1.0 && num_entries <= leaf_max)) {
+          EXPECT_EQ(1, loader.GetHeight());
+        }
+        if (num_entries > leaf_max) {
+          EXPECT_LE(2, loader.GetHeight());
+        }
+        if (num_entries > leaf_max * internal_max) {
+          EXPECT_LE(3, loader.GetHeight());
+        }
+        std::vector<int64_t> keys = ScanLeaves(bpm, root_id);
+        ASSERT_EQ(num_entries, keys.size());
+        for (size_t i = 0; i < num_entries; i++) {
+          EXPECT_EQ(static_cast<int64_t>(2 * i), keys[i]);
+        }
+      }
+      delete bpm;
+      delete disk_manager;
+      remove("test.db");
+    }
+  }
+  delete key_schema;
+}
+
+TEST(BPlusTreeBulkLoaderTest, BadInputTest) {
+  Schema *key_schema = ParseCreateStatement("a bigint");
+  ComparatorType comparator(key_schema);
+  DiskManager *disk_manager = new DiskManager("test.db");
+  BufferPoolManager *bpm = new BufferPoolManager(50, disk_manager);
+
+  // out of order and duplicate keys
+  for (int64_t second : {5, 4}) {
+    BulkLoader loader(bpm, comparator, 3);
+    loader.Append(MakeKey(5), RID(0, 0));
+    bool threw = false;
+    try {
+      loader.Append(MakeKey(second), RID(0, 1));
+    } catch (Exception &e) {
+      threw = true;
+    }
+    EXPECT_EQ(true, threw);
+  }
+
+  // more entries than planned
+  {
+    BulkLoader loader(bpm, comparator, 2);
+    loader.Append(MakeKey(1), RID(0, 1));
+    loader.Append(MakeKey(2), RID(0, 2));
+    bool threw = false;
+    try {
+      loader.Append(MakeKey(3), RID(0, 3));
+    } catch (Exception &e) {
+      threw = true;
+    }
+    EXPECT_EQ(true, threw);
+  }
+
+  // fewer entries than planned
+  {
+    BulkLoader loader(bpm, comparator, 3);
+    loader.Append(MakeKey(1), RID(0, 1));
+    bool threw = false;
+    try {
+      loader.Finish();
+    } catch (Exception &e) {
+      threw = true;
+    }
+    EXPECT_EQ(true, threw);
+  }
+
+  // the failed loaders unpinned their pages
+  page_id_t page_id;
+  for (int i = 0; i < 50; i++) {
+    ASSERT_NE(nullptr, bpm->NewPage(page_id));
+  }
+
+  delete bpm;
+  delete disk_manager;
+  delete key_schema;
+  remove("test.db");
+}
+
+} // namespace cmudb
@@ -0,0 +1,517 @@
+/**
+ * b_plus_tree_compressed_page_test.cpp
+ */
+
+#include <algorithm>
+#include <cstdio>
+#include <cstring>
+#include <map>
+#include <random>
+#include <set>
+#include <string>
+#include <vector>
+
+#include "buffer/buffer_pool_manager.h"
+#include "common/rid.h"
+#include "page/b_plus_tree_compressed_internal_page.h"
+#include "page/b_plus_tree_compressed_leaf_page.h"
+#include "page/b_plus_tree_internal_page.h"
+#include "page/b_plus_tree_leaf_page.h"
+#include "gtest/gtest.h"
+
+namespace cmudb {
+
+typedef NormalizedKey<64> KeyType;
+typedef NormalizedComparator<64> ComparatorType;
+typedef BPlusTreeCompressedLeafPage<KeyType, RID, ComparatorType> LeafPage;
+typedef BPlusTreeCompressedInternalPage<KeyType, page_id_t, ComparatorType> InternalPage;
+
+// prefix_size bytes of fill, then value as an 8 byte integer, then zeros
+static KeyType MakeKey(int64_t value, int prefix_size, char fill = 'a') {
+  std::string prefix(prefix_size, fill);
+  KeyType key;
+  NormalizedKeyBuilder<64>(&key)
+      .AppendString(prefix.data(), prefix.size(), prefix.size())
+      .AppendInteger(value, 8);
+  return key;
+}
+
+static bool SameKey(const KeyType &lhs, const KeyType &rhs) {
+  return memcmp(lhs.data, rhs.data, sizeof(KeyType)) == 0;
+}
+
+// the separator is after left, at most right, and right with a zeroed tail
+TEST(BPlusTreeCompressedPageTest, ShortestSeparatorTest) {
+  ComparatorType comparator;
+  KeyType left = MakeKey(0x0100, 20), right = MakeKey(0x0200, 20);
+  KeyType separator = LeafPage::ShortestSeparator(left, right, comparator);
+  EXPECT_LT(comparator(left, separator), 0);
+  EXPECT_LE(comparator(separator, right), 0);
+  // 20 bytes of prefix, then the integer up to its differing byte
+  for (size_t i = 27; i < sizeof(KeyType); i++) {
+    EXPECT_EQ(0, separator.data[i]);
+  }
+  EXPECT_EQ(0, memcmp(separator.data, right.data, 27));
+
+  // keys that only differ in their last byte give right itself
+  KeyType last_left = MakeKey(0, 0), last_right = MakeKey(0, 0);
+  last_left.data[sizeof(KeyType) - 1] = 1;
+  last_right.data[sizeof(KeyType) - 1] = 2;
+  EXPECT_EQ(true, SameKey(last_right, LeafPage::ShortestSeparator(last_left, last_right, comparator)));
+}
+
+// a common prefix raises the fanout over the pair layout, and a key
+// without it widens the encoding until the page no longer has room
+TEST(BPlusTreeCompressedPageTest, AdmitAndFanoutTest) {
+  ComparatorType comparator;
+  DiskManager *disk_manager = new DiskManager("test.db");
+  BufferPoolManager *bpm = new BufferPoolManager(10, disk_manager);
+
+  page_id_t leaf_id, plain_id;
+  auto *leaf = reinterpret_cast<LeafPage *>(bpm->NewPage(leaf_id)->GetData());
+  auto *plain = reinterpret_cast<BPlusTreeLeafPage<KeyType, RID, ComparatorType> *>(
+      bpm->NewPage(plain_id)->GetData());
+  leaf->Init(leaf_id);
+  plain->Init(plain_id);
+
+  leaf->Insert(MakeKey(1, 40), RID(0, 1), comparator);
+  leaf->Insert(MakeKey(2, 40), RID(0, 2), comparator);
+  // 40 bytes of prefix and 7 bytes of the integer are common; inserts only
+  // widen the encoding, so the zero tail is kept until the page is re-encoded
+  EXPECT_EQ(47, leaf->GetPrefixSize());
+  EXPECT_EQ(0, leaf->GetSuffixZeros());
+  EXPECT_LT(plain->GetMaxSize(), leaf->GetMaxSize());
+  int fanout = leaf->GetMaxSize();
+
+  int64_t n = 2;
+  while (leaf->GetSize() < leaf->GetMaxSize()) {
+    n++;
+    ASSERT_EQ(n, leaf->Insert(MakeKey(n, 40), RID(0, static_cast<int32_t>(n)), comparator));
+  }
+  EXPECT_EQ(fanout, leaf->GetMaxSize());
+  EXPECT_EQ(47, leaf->GetPrefixSize());
+
+  // a key with half the prefix widens and re-encodes the page when it fits...
+  KeyType shorter = MakeKey(0, 20);
+  int max_entries = leaf->MaxEntriesWith(shorter);
+  EXPECT_LT(max_entries, fanout + 1);
+  EXPECT_EQ(leaf->GetSize() + 1 < max_entries, leaf->IsSafeToInsert(shorter));
+  if (leaf->GetSize() + 1 <= max_entries) {
+    EXPECT_EQ(leaf->GetSize() + 1, leaf->Insert(shorter, RID(0, 0), comparator));
+    EXPECT_EQ(20, leaf->GetPrefixSize());
+    EXPECT_EQ(true, SameKey(shorter, leaf->KeyAt(0)));
+  } else {
+    // ...and otherwise fails with the page unchanged
+    EXPECT_EQ(-1, leaf->Insert(shorter, RID(0, 0), comparator));
+    EXPECT_EQ(47, leaf->GetPrefixSize());
+  }
+  // a key that shares nothing does not fit a full page in any case
+  int size = leaf->GetSize();
+  int prefix_size = leaf->GetPrefixSize();
+  KeyType other = MakeKey(1, 40, 'z');
+  EXPECT_EQ(false, leaf->IsSafeToInsert(other));
+  EXPECT_EQ(-1, leaf->Insert(other, RID(0, 0), comparator));
+  EXPECT_EQ(size, leaf->GetSize());
+  EXPECT_EQ(prefix_size, leaf->GetPrefixSize());
+  for (int64_t i = 1; i <= n; i++) {
+    RID rid;
+    EXPECT_EQ(true, leaf->Lookup(MakeKey(i, 40), rid, comparator));
+    EXPECT_EQ(i, rid.GetSlotNum());
+  }
+
+  bpm->UnpinPage(leaf_id, true);
+  bpm->UnpinPage(plain_id, true);
+  delete bpm;
+  delete disk_manager;
+  remove("test.db");
+}
+
+// random keys, some with a shorter prefix, through a chain of leaves that
+// split when full or when a key does not fit, then merged back pairwise
+// where the keys fit
+TEST(BPlusTreeCompressedPageTest, LeafRoundTripTest) {
+  ComparatorType comparator;
+  std::mt19937 rng(3);
+  for (int prefix_size : {0, 20, 50}) {
+    DiskManager *disk_manager = new DiskManager("test.db");
+    BufferPoolManager *bpm = new BufferPoolManager(400, disk_manager);
+    // first key of each leaf, the first leaf under the empty string
+    std::map<std::string, page_id_t> leaves;
+    std::set<int64_t> truth;
+    page_id_t page_id;
+    reinterpret_cast<LeafPage *>(bpm->NewPage(page_id)->GetData())->Init(page_id);
+    bpm->UnpinPage(page_id, true);
+    leaves[std::string()] = page_id;
+
+    auto leaf_for = [&](const KeyType &key) {
+      auto it = --leaves.upper_bound(std::string(key.data, sizeof(KeyType)));
+      return it->second;
+    };
+    for (int i = 0; i < 3000; i++) {
+      int64_t value = rng() % 100000;
+      if (truth.count(value) != 0) {
+        continue;
+      }
+      KeyType key = MakeKey(value, value % 7 == 0 ? prefix_size / 2 : prefix_size);
+      // retried after a split, as the half the key belongs to may not fit it either
+      while (true) {
+        page_id_t leaf_id = leaf_for(key);
+        auto *leaf = reinterpret_cast<LeafPage *>(bpm->FetchPage(leaf_id)->GetData());
+        int size = leaf->Insert(key, RID(0, static_cast<int32_t>(value)), comparator);
+        if (size >= 0 && size <= leaf->GetMaxSize()) {
+          bpm->UnpinPage(leaf_id, true);
+          break;
+        }
+        ASSERT_LT(1, leaf->GetSize());
+        page_id_t sibling_id;
+        auto *sibling = reinterpret_cast<LeafPage *>(bpm->NewPage(sibling_id)->GetData());
+        sibling->Init(sibling_id);
+        leaf->MoveHalfTo(sibling, bpm);
+        KeyType separator = LeafPage::ShortestSeparator(leaf->KeyAt(leaf->GetSize() - 1),
+                                                        sibling->KeyAt(0), comparator);
+        leaves[std::string(separator.data, sizeof(KeyType))] = sibling_id;
+        bpm->UnpinPage(sibling_id, true);
+        bpm->UnpinPage(leaf_id, true);
+        if (size >= 0) {
+          break;
+        }
+      }
+      truth.insert(value);
+    }
+
+    auto check = [&]() {
+      size_t count = 0;
+      page_id_t expected_next = INVALID_PAGE_ID;
+      for (auto it = leaves.rbegin(); it != leaves.rend(); ++it) {
+        auto *leaf = reinterpret_cast<LeafPage *>(bpm->FetchPage(it->second)->GetData());
+        EXPECT_EQ(expected_next, leaf->GetNextPageId());
+        expected_next = it->second;
+        count += leaf->GetSize();
+        for (int i = 0; i < leaf->GetSize(); i++) {
+          KeyType key = leaf->KeyAt(i);
+          RID rid;
+          EXPECT_EQ(true, leaf->Lookup(key, rid, comparator));
+          EXPECT_EQ(1u, truth.count(rid.GetSlotNum()));
+          if (i > 0) {
+            EXPECT_LT(comparator(leaf->KeyAt(i - 1), key), 0);
+          }
+        }
+        bpm->UnpinPage(it->second, false);
+      }
+      EXPECT_EQ(truth.size(), count);
+      for (int64_t value : truth) {
+        KeyType key = MakeKey(value, value % 7 == 0 ? prefix_size / 2 : prefix_size);
+        page_id_t leaf_id = leaf_for(key);
+        auto *leaf = reinterpret_cast<LeafPage *>(bpm->FetchPage(leaf_id)->GetData());
+        RID rid;
+        EXPECT_EQ(true, leaf->Lookup(key, rid, comparator));
+        EXPECT_EQ(value, rid.GetSlotNum());
+        bpm->UnpinPage(leaf_id, false);
+      }
+    };
+    check();
+    size_t num_leaves = leaves.size();
+    EXPECT_LT(1u, num_leaves);
+
+    // delete every other key, then merge each leaf into the one before it
+    // when they fit together
+    for (auto it = truth.begin(); it != truth.end();) {
+      int64_t value = *it;
+      KeyType key = MakeKey(value, value % 7 == 0 ? prefix_size / 2 : prefix_size);
+      page_id_t leaf_id = leaf_for(key);
+      auto *leaf = reinterpret_cast<LeafPage *>(bpm->FetchPage(leaf_id)->GetData());
+      if (value % 2 == 0 && leaf->GetSize() > 1) {
+        leaf->RemoveAndDeleteRecord(key, comparator);
+        it = truth.erase(it);
+      } else {
+        ++it;
+      }
+      bpm->UnpinPage(leaf_id, true);
+    }
+    int merges = 0;
+    for (auto it = std::next(leaves.begin()); it != leaves.end();) {
+      page_id_t left_id = std::prev(it)->second;
+      auto *left = reinterpret_cast<LeafPage *>(bpm->FetchPage(left_id)->GetData());
+      auto *right = reinterpret_cast<LeafPage *>(bpm->FetchPage(it->second)->GetData());
+      int total = left->GetSize() + right->GetSize();
+      bool merged = total <= left->GetMaxSize() && right->MoveAllTo(left, 0, bpm);
+      if (merged) {
+        EXPECT_EQ(total, left->GetSize());
+        EXPECT_EQ(0, right->GetSize());
+        merges++;
+      } else {
+        EXPECT_EQ(total, left->GetSize() + right->GetSize());
+      }
+      bpm->UnpinPage(left_id, true);
+      bpm->UnpinPage(it->second, true);
+      it = merged ? leaves.erase(it) : std::next(it);
+    }
+    EXPECT_LT(0, merges);
+    check();
+    EXPECT_EQ(num_leaves - merges, leaves.size());
+    delete bpm;
+    delete disk_manager;
+    remove("test.db");
+  }
+}
+
+// separators in an internal page share the prefix of the keys they came
+// from and have long zero tails; split, lookup and merge back
+TEST(BPlusTreeCompressedPageTest, InternalRoundTripTest) {
+  ComparatorType comparator;
+  DiskManager *disk_manager = new DiskManager("test.db");
+  BufferPoolManager *bpm = new BufferPoolManager(400, disk_manager);
+
+  std::vector<page_id_t> children;
+  for (int i = 0; i < 200; i++) {
+    page_id_t child_id;
+    reinterpret_cast<LeafPage *>(bpm->NewPage(child_id)->GetData())->Init(child_id);
+    bpm->UnpinPage(child_id, true);
+    children.push_back(child_id);
+  }
+  auto separator = [&](int i) {
+    return LeafPage::ShortestSeparator(MakeKey(i - 1, 40), MakeKey(i, 40), comparator);
+  };
+
+  page_id_t page_id, parent_id;
+  auto *page = reinterpret_cast<InternalPage *>(bpm->NewPage(page_id)->GetData());
+  page->Init(page_id);
+  page->PopulateNewRoot(children[0], separator(1), children[1]);
+  int fanout = 1;
+  while (page->GetSize() <= page->GetMaxSize()) {
+    int i = page->GetSize();
+    ASSERT_EQ(i + 1, page->InsertNodeAfter(children[i - 1], separator(i), children[i]));
+    fanout = page->GetSize();
+  }
+  auto *plain = reinterpret_cast<BPlusTreeInternalPage<KeyType, page_id_t, ComparatorType> *>(
+      bpm->NewPage(parent_id)->GetData());
+  plain->Init(parent_id);
+  EXPECT_LT(plain->GetMaxSize() + 1, fanout);
+  for (int i = 1; i < fanout; i++) {
+    EXPECT_EQ(children[i], page->Lookup(MakeKey(i, 40), comparator));
+    EXPECT_EQ(children[i - 1], page->Lookup(MakeKey(i - 1, 40), comparator));
+  }
+
+  // a separator that shares nothing with the others does not fit
+  EXPECT_EQ(-1, page->InsertNodeAfter(children[fanout - 1], MakeKey(0, 40, 'z'), children[fanout]));
+  EXPECT_EQ(false, page->SetKeyAt(1, MakeKey(0, 40, 'z')));
+  EXPECT_EQ(fanout, page->GetSize());
+  EXPECT_EQ(true, SameKey(separator(1), page->KeyAt(1)));
+
+  page_id_t sibling_id;
+  auto *sibling = reinterpret_cast<InternalPage *>(bpm->NewPage(sibling_id)->GetData());
+  sibling->Init(sibling_id);
+  KeyType middle = page->MoveHalfTo(sibling, bpm);
+  EXPECT_EQ(fanout, page->GetSize() + sibling->GetSize());
+  EXPECT_EQ(true, SameKey(separator(page->GetSize()), middle));
+  for (int i = 1; i < page->GetSize(); i++) {
+    EXPECT_EQ(children[i], page->Lookup(MakeKey(i, 40), comparator));
+  }
+  for (int i = page->GetSize() + 1; i < fanout; i++) {
+    EXPECT_EQ(children[i], sibling->Lookup(MakeKey(i, 40), comparator));
+  }
+  auto *child = reinterpret_cast<BPlusTreePage *>(bpm->FetchPage(sibling->ValueAt(0))->GetData());
+  EXPECT_EQ(sibling_id, child->GetParentPageId());
+  bpm->UnpinPage(child->GetPageId(), false);
+
+  // merge back through a parent
+  auto *parent = reinterpret_cast<InternalPage *>(plain);
+  parent->Init(parent_id);
+  parent->PopulateNewRoot(page_id, middle, sibling_id);
+  page->SetParentPageId(parent_id);
+  sibling->SetParentPageId(parent_id);
+  EXPECT_EQ(true, sibling->MoveAllTo(page, 1, bpm));
+  EXPECT_EQ(fanout, page->GetSize());
+  for (int i = 1; i < fanout; i++) {
+    EXPECT_EQ(children[i], page->Lookup(MakeKey(i, 40), comparator));
+  }
+
+  bpm->UnpinPage(page_id, true);
+  bpm->UnpinPage(sibling_id, true);
+  bpm->UnpinPage(parent_id, true);
+  delete bpm;
+  delete disk_manager;
+  remove("test.db");
+}
+
+// LookupIndex is the slot Lookup descends into, and a stale slot hint falls
+// back to the scan
+TEST(BPlusTreeCompressedPageTest, LookupIndexTest) {
+  ComparatorType comparator;
+  DiskManager *disk_manager = new DiskManager("test.db");
+  BufferPoolManager *bpm = new BufferPoolManager(10, disk_manager);
+
+  page_id_t page_id;
+  auto *page = reinterpret_cast<InternalPage *>(bpm->NewPage(page_id)->GetData());
+  page->Init(page_id);
+  page->PopulateNewRoot(100, MakeKey(10, 40), 101);
+  for (int i = 2; i < 8; i++) {
+    page->InsertNodeAfter(100 + i - 1, MakeKey(10 * i, 40), 100 + i);
+  }
+  for (int64_t key = 0; key < 90; key++) {
+    int slot = page->LookupIndex(MakeKey(key, 40), comparator);
+    EXPECT_EQ(std::min<int64_t>(key / 10, 7), slot);
+    EXPECT_EQ(page->Lookup(MakeKey(key, 40), comparator), page->ValueAt(slot));
+  }
+  // keys outside the common prefix still find their slot
+  EXPECT_EQ(0, page->LookupIndex(MakeKey(50, 40, 'A'), comparator));
+  EXPECT_EQ(7, page->LookupIndex(MakeKey(50, 20), comparator));
+  EXPECT_EQ(7, page->LookupIndex(MakeKey(0, 40, 'b'), comparator));
+  page->InsertNodeAt(3, MakeKey(25, 40), 200);
+  EXPECT_EQ(3, page->ValueIndex(200, 3));
+  EXPECT_EQ(4, page->ValueIndex(103, 3));
+  EXPECT_EQ(8, page->ValueIndex(107, -1));
+  EXPECT_EQ(-1, page->ValueIndex(300, 0));
+
+  bpm->UnpinPage(page_id, true);
+  delete bpm;
+  delete disk_manager;
+  remove("test.db");
+}
+
+// leaves shift one entry at a time through the parent, and refuse, with all
+// three pages unchanged, a key that does not fit in the recipient
+TEST(BPlusTreeCompressedPageTest, LeafRedistributeTest) {
+  ComparatorType comparator;
+  DiskManager *disk_manager = new DiskManager("test.db");
+  BufferPoolManager *bpm = new BufferPoolManager(10, disk_manager);
+
+  page_id_t parent_id, left_id, right_id;
+  auto *parent = reinterpret_cast<InternalPage *>(bpm->NewPage(parent_id)->GetData());
+  auto *left = reinterpret_cast<LeafPage *>(bpm->NewPage(left_id)->GetData());
+  auto *right = reinterpret_cast<LeafPage *>(bpm->NewPage(right_id)->GetData());
+  parent->Init(parent_id);
+  left->Init(left_id, parent_id);
+  right->Init(right_id, parent_id);
+  for (int64_t i = 1; i <= 4; i++) {
+    left->Insert(MakeKey(i, 40), RID(0, static_cast<int32_t>(i)), comparator);
+    right->Insert(MakeKey(i + 10, 40), RID(0, static_cast<int32_t>(i + 10)), comparator);
+  }
+  parent->PopulateNewRoot(left_id, MakeKey(11, 40), right_id);
+
+  EXPECT_EQ(true, right->MoveFirstToEndOf(left, parent, 1));
+  EXPECT_EQ(5, left->GetSize());
+  EXPECT_EQ(3, right->GetSize());
+  EXPECT_EQ(true, SameKey(MakeKey(11, 40), left->KeyAt(4)));
+  EXPECT_EQ(11, left->ValueAt(4).GetSlotNum());
+  EXPECT_EQ(true, SameKey(MakeKey(12, 40), parent->KeyAt(1)));
+
+  EXPECT_EQ(true, left->MoveLastToFrontOf(right, parent, 1));
+  EXPECT_EQ(4, left->GetSize());
+  EXPECT_EQ(true, SameKey(MakeKey(11, 40), right->KeyAt(0)));
+  EXPECT_EQ(true, SameKey(MakeKey(11, 40), parent->KeyAt(1)));
+
+  // the same through the overloads that fetch the parent
+  EXPECT_EQ(true, right->MoveFirstToEndOf(left, bpm));
+  EXPECT_EQ(true, SameKey(MakeKey(12, 40), parent->KeyAt(1)));
+  EXPECT_EQ(true, left->MoveLastToFrontOf(right, 1, bpm));
+  EXPECT_EQ(true, SameKey(MakeKey(11, 40), parent->KeyAt(1)));
+
+  // fill the left leaf, and give the right one keys that share nothing with it
+  for (int64_t i = 11; i <= 14; i++) {
+    right->RemoveAndDeleteRecord(MakeKey(i, 40), comparator);
+  }
+  for (int64_t i = 11; i <= 14; i++) {
+    right->Insert(MakeKey(i, 40, 'b'), RID(0, static_cast<int32_t>(i)), comparator);
+  }
+  EXPECT_EQ(true, parent->SetKeyAt(1, MakeKey(11, 40, 'b')));
+  int64_t n = 4;
+  while (left->GetSize() < left->GetMaxSize()) {
+    n++;
+    left->Insert(MakeKey(n, 40), RID(0, static_cast<int32_t>(n)), comparator);
+  }
+  int left_size = left->GetSize(), right_size = right->GetSize();
+  EXPECT_EQ(false, right->MoveFirstToEndOf(left, parent, 1));
+  EXPECT_EQ(false, right->MoveFirstToEndOf(left, bpm));
+  EXPECT_EQ(left_size, left->GetSize());
+  EXPECT_EQ(right_size, right->GetSize());
+  EXPECT_EQ(true, SameKey(MakeKey(11, 40, 'b'), right->KeyAt(0)));
+  EXPECT_EQ(true, SameKey(MakeKey(11, 40, 'b'), parent->KeyAt(1)));
+  // and the merge fails the same way
+  EXPECT_EQ(false, right->MoveAllTo(left, 1, bpm));
+  EXPECT_EQ(left_size, left->GetSize());
+  EXPECT_EQ(right_size, right->GetSize());
+
+  bpm->UnpinPage(parent_id, true);
+  bpm->UnpinPage(left_id, true);
+  bpm->UnpinPage(right_id, true);
+  delete bpm;
+  delete disk_manager;
+  remove("test.db");
+}
+
+// an internal page rotates a child through the parent: the separator comes
+// down with the moved child and the moved boundary key goes up
+TEST(BPlusTreeCompressedPageTest, InternalRedistributeTest) {
+  DiskManager *disk_manager = new DiskManager("test.db");
+  BufferPoolManager *bpm = new BufferPoolManager(20, disk_manager);
+
+  page_id_t parent_id, left_id, right_id;
+  auto *parent = reinterpret_cast<InternalPage *>(bpm->NewPage(parent_id)->GetData());
+  auto *left = reinterpret_cast<InternalPage *>(bpm->NewPage(left_id)->GetData());
+  auto *right = reinterpret_cast<InternalPage *>(bpm->NewPage(right_id)->GetData());
+  parent->Init(parent_id);
+  left->Init(left_id, parent_id);
+  right->Init(right_id, parent_id);
+  page_id_t children[6];
+  for (int i = 0; i < 6; i++) {
+    auto *child = reinterpret_cast<LeafPage *>(bpm->NewPage(children[i])->GetData());
+    child->Init(children[i], i < 3 ? left_id : right_id);
+    bpm->UnpinPage(children[i], true);
+  }
+  left->PopulateNewRoot(children[0], MakeKey(10, 40), children[1]);
+  left->InsertNodeAt(2, MakeKey(20, 40), children[2]);
+  right->PopulateNewRoot(children[3], MakeKey(40, 40), children[4]);
+  right->InsertNodeAt(2, MakeKey(50, 40), children[5]);
+  parent->PopulateNewRoot(left_id, MakeKey(30, 40), right_id);
+
+  EXPECT_EQ(true, right->MoveFirstToEndOf(left, bpm));
+  EXPECT_EQ(4, left->GetSize());
+  EXPECT_EQ(true, SameKey(MakeKey(30, 40), left->KeyAt(3)));
+  EXPECT_EQ(children[3], left->ValueAt(3));
+  EXPECT_EQ(2, right->GetSize());
+  EXPECT_EQ(children[4], right->ValueAt(0));
+  EXPECT_EQ(true, SameKey(MakeKey(50, 40), right->KeyAt(1)));
+  EXPECT_EQ(true, SameKey(MakeKey(40, 40), parent->KeyAt(1)));
+  auto *moved = reinterpret_cast<BPlusTreePage *>(bpm->FetchPage(children[3])->GetData());
+  EXPECT_EQ(left_id, moved->GetParentPageId());
+  bpm->UnpinPage(children[3], false);
+
+  EXPECT_EQ(true, left->MoveLastToFrontOf(right, 1, bpm));
+  EXPECT_EQ(3, left->GetSize());
+  EXPECT_EQ(3, right->GetSize());
+  EXPECT_EQ(children[3], right->ValueAt(0));
+  EXPECT_EQ(true, SameKey(MakeKey(40, 40), right->KeyAt(1)));
+  EXPECT_EQ(true, SameKey(MakeKey(50, 40), right->KeyAt(2)));
+  EXPECT_EQ(true, SameKey(MakeKey(30, 40), parent->KeyAt(1)));
+  moved = reinterpret_cast<BPlusTreePage *>(bpm->FetchPage(children[3])->GetData());
+  EXPECT_EQ(right_id, moved->GetParentPageId());
+  bpm->UnpinPage(children[3], false);
+
+  // a parent key that shares nothing with the keys of a full left page
+  // cannot come down; the keys right of it share nothing with them either
+  for (int i = 3; left->GetSize() < left->GetMaxSize() + 1; i++) {
+    page_id_t child_id;
+    reinterpret_cast<LeafPage *>(bpm->NewPage(child_id)->GetData())->Init(child_id, left_id);
+    bpm->UnpinPage(child_id, true);
+    ASSERT_EQ(i + 1, left->InsertNodeAt(i, MakeKey(20 + i, 40), child_id));
+  }
+  EXPECT_EQ(true, parent->SetKeyAt(1, MakeKey(30, 40, 'b')));
+  EXPECT_EQ(true, right->SetKeyAt(1, MakeKey(40, 40, 'b')));
+  EXPECT_EQ(true, right->SetKeyAt(2, MakeKey(50, 40, 'b')));
+  int left_size = left->GetSize();
+  EXPECT_EQ(false, right->MoveFirstToEndOf(left, parent, 1));
+  EXPECT_EQ(left_size, left->GetSize());
+  EXPECT_EQ(3, right->GetSize());
+  EXPECT_EQ(children[3], right->ValueAt(0));
+  EXPECT_EQ(true, SameKey(MakeKey(30, 40, 'b'), parent->KeyAt(1)));
+
+  bpm->UnpinPage(parent_id, true);
+  bpm->UnpinPage(left_id, true);
+  bpm->UnpinPage(right_id, true);
+  delete bpm;
+  delete disk_manager;
+  remove("test.db");
+}
+
+} // namespace cmudb
@@ -0,0 +1,255 @@
+/**
+ * b_plus_tree_internal_page_test.cpp
+ */
+
+#include <algorithm>
+#include <cstdio>
+#include <vector>
+
+#include "buffer/buffer_pool_manager.h"
+#include "common/exception.h"
+#include "page/b_plus_tree_internal_page.h"
+#include "page/b_plus_tree_path.h"
+#include "vtable/virtual_table.h"
+#include "gtest/gtest.h"
+
+namespace cmudb {
+
+typedef GenericKey<8> KeyType;
+typedef GenericComparator<8> ComparatorType;
+typedef BPlusTreeInternalPage<KeyType, page_id_t, ComparatorType> InternalPage;
+
+static KeyType MakeKey(int64_t value) {
+  KeyType key;
+  key.SetFromInteger(value);
+  return key;
+}
+
+static int64_t KeyValue(const KeyType &key) { return key.ToString(); }
+
+static page_id_t ParentOf(BufferPoolManager *bpm, page_id_t page_id) {
+  Page *page = bpm->FetchPage(page_id);
+  EXPECT_NE(nullptr, page);
+  page_id_t parent_id = reinterpret_cast<BPlusTreePage *>(page->GetData())->GetParentPageId();
+  bpm->UnpinPage(page_id, false);
+  return parent_id;
+}
+
+// pages under parent_id, unpinned
+static std::vector<page_id_t> MakeChildren(BufferPoolManager *bpm, int count, page_id_t parent_id) {
+  std::vector<page_id_t> children(count);
+  for (int i = 0; i < count; i++) {
+    auto *child = reinterpret_cast<InternalPage *>(bpm->NewPage(children[i])->GetData());
+    child->Init(children[i], parent_id);
+    bpm->UnpinPage(children[i], true);
+  }
+  return children;
+}
+
+// pins new pages until the pool is full, so that any fetch of a page not in
+// the pool fails
+static std::vector<page_id_t> FillPool(BufferPoolManager *bpm) {
+  std::vector<page_id_t> pinned;
+  page_id_t page_id;
+  while (bpm->NewPage(page_id) != nullptr) {
+    pinned.push_back(page_id);
+  }
+  return pinned;
+}
+
+// LookupIndex is the slot of the last key <= key, the first slot for keys
+// before all of them, and a slot hint is checked before the scan
+TEST(BPlusTreeInternalPageTest, LookupIndexTest) {
+  Schema *key_schema = ParseCreateStatement("a bigint");
+  ComparatorType comparator(key_schema);
+  DiskManager *disk_manager = new DiskManager("test.db");
+  BufferPoolManager *bpm = new BufferPoolManager(10, disk_manager);
+
+  page_id_t page_id;
+  auto *page = reinterpret_cast<InternalPage *>(bpm->NewPage(page_id)->GetData());
+  page->Init(page_id);
+  // children 100, 101, ... under keys 10, 20, ...
+  page->PopulateNewRoot(100, MakeKey(10), 101);
+  for (int i = 2; i < 8; i++) {
+    page->InsertNodeAfter(100 + i - 1, MakeKey(10 * i), 100 + i);
+  }
+  for (int64_t key = 0; key < 90; key++) {
+    int slot = page->LookupIndex(MakeKey(key), comparator);
+    EXPECT_EQ(std::min<int64_t>(key / 10, 7), slot);
+    EXPECT_EQ(page->Lookup(MakeKey(key), comparator), page->ValueAt(slot));
+  }
+
+  for (int i = 0; i < 8; i++) {
+    EXPECT_EQ(i, page->ValueIndex(100 + i, i));
+  }
+  // an insert before a child makes its slot stale
+  page->InsertNodeAt(3, MakeKey(25), 200);
+  EXPECT_EQ(4, page->ValueIndex(103, 3));
+  EXPECT_EQ(3, page->ValueIndex(200, 3));
+  EXPECT_EQ(8, page->ValueIndex(107, 7));
+  EXPECT_EQ(8, page->ValueIndex(107, -1));
+  EXPECT_EQ(8, page->ValueIndex(107, 100));
+  EXPECT_EQ(-1, page->ValueIndex(300, 0));
+  EXPECT_EQ(3, page->LookupIndex(MakeKey(25), comparator));
+  EXPECT_EQ(4, page->LookupIndex(MakeKey(30), comparator));
+
+  // a path records the slots taken on the way down
+  BPlusTreePath path;
+  EXPECT_EQ(INVALID_PAGE_ID, path.GetParentPageId());
+  path.Push(page_id, page->LookupIndex(MakeKey(45), comparator));
+  path.Push(page->Lookup(MakeKey(45), comparator), 0);
+  EXPECT_EQ(2, path.GetDepth());
+  EXPECT_EQ(104, path.GetParentPageId());
+  path.Pop();
+  EXPECT_EQ(page_id, path.GetParentPageId());
+  EXPECT_EQ(5, path.GetIndexInParent());
+  EXPECT_EQ(104, page->ValueAt(path.GetIndexInParent()));
+
+  bpm->UnpinPage(page_id, true);
+  delete bpm;
+  delete disk_manager;
+  delete key_schema;
+  remove("test.db");
+}
+
+/*
+ * The separator comes down from the parent with the moved child and the
+ * boundary key goes up, whatever is in the unused first key of the page;
+ * a child moved to the front of the recipient takes the old separator as
+ * the key of the recipient's former first child.
+ */
+TEST(BPlusTreeInternalPageTest, RedistributeTest) {
+  DiskManager *disk_manager = new DiskManager("test.db");
+  BufferPoolManager *bpm = new BufferPoolManager(20, disk_manager);
+
+  page_id_t parent_id, left_id, right_id;
+  auto *parent = reinterpret_cast<InternalPage *>(bpm->NewPage(parent_id)->GetData());
+  auto *left = reinterpret_cast<InternalPage *>(bpm->NewPage(left_id)->GetData());
+  auto *right = reinterpret_cast<InternalPage *>(bpm->NewPage(right_id)->GetData());
+  parent->Init(parent_id);
+  left->Init(left_id, parent_id);
+  right->Init(right_id, parent_id);
+  std::vector<page_id_t> children = MakeChildren(bpm, 3, left_id);
+  std::vector<page_id_t> right_children = MakeChildren(bpm, 3, right_id);
+  children.insert(children.end(), right_children.begin(), right_children.end());
+  left->PopulateNewRoot(children[0], MakeKey(10), children[1]);
+  left->InsertNodeAt(2, MakeKey(20), children[2]);
+  right->PopulateNewRoot(children[3], MakeKey(40), children[4]);
+  right->InsertNodeAt(2, MakeKey(50), children[5]);
+  parent->PopulateNewRoot(left_id, MakeKey(30), right_id);
+  right->SetKeyAt(0, MakeKey(999));
+
+  right->MoveFirstToEndOf(left, bpm);
+  EXPECT_EQ("10 20 30", left->ToString(false));
+  EXPECT_EQ(children[3], left->ValueAt(3));
+  EXPECT_EQ("50", right->ToString(false));
+  EXPECT_EQ(children[4], right->ValueAt(0));
+  EXPECT_EQ(40, KeyValue(parent->KeyAt(1)));
+  EXPECT_EQ(left_id, ParentOf(bpm, children[3]));
+
+  left->MoveLastToFrontOf(right, 1, bpm);
+  EXPECT_EQ("10 20", left->ToString(false));
+  EXPECT_EQ("40 50", right->ToString(false));
+  EXPECT_EQ(children[3], right->ValueAt(0));
+  EXPECT_EQ(children[4], right->ValueAt(1));
+  EXPECT_EQ(30, KeyValue(parent->KeyAt(1)));
+  EXPECT_EQ(right_id, ParentOf(bpm, children[3]));
+
+  // the same with this page's index in the parent given
+  right->MoveFirstToEndOf(left, 1, bpm);
+  EXPECT_EQ("10 20 30", left->ToString(false));
+  EXPECT_EQ(40, KeyValue(parent->KeyAt(1)));
+  EXPECT_EQ(left_id, ParentOf(bpm, children[3]));
+
+  bpm->UnpinPage(parent_id, true);
+  bpm->UnpinPage(left_id, true);
+  bpm->UnpinPage(right_id, true);
+  delete bpm;
+  delete disk_manager;
+  remove("test.db");
+}
+
+/*
+ * The overloads without a buffer pool leave the moved children alone: with
+ * every frame pinned and the children evicted, they still succeed and the
+ * children keep their old parent ids, where the buffer pool overloads fail
+ * to fetch the children.
+ */
+TEST(BPlusTreeInternalPageTest, NoBufferPoolTest) {
+  DiskManager *disk_manager = new DiskManager("test.db");
+  BufferPoolManager *bpm = new BufferPoolManager(10, disk_manager);
+
+  page_id_t parent_id, left_id, right_id;
+  auto *parent = reinterpret_cast<InternalPage *>(bpm->NewPage(parent_id)->GetData());
+  auto *left = reinterpret_cast<InternalPage *>(bpm->NewPage(left_id)->GetData());
+  auto *right = reinterpret_cast<InternalPage *>(bpm->NewPage(right_id)->GetData());
+  parent->Init(parent_id);
+  left->Init(left_id, parent_id);
+  right->Init(right_id, parent_id);
+  int total = left->GetMaxSize() + 1;
+  std::vector<page_id_t> children = MakeChildren(bpm, total, left_id);
+  left->PopulateNewRoot(children[0], MakeKey(10), children[1]);
+  for (int i = 2; i < total; i++) {
+    EXPECT_EQ(i + 1, left->InsertNodeAt(i, MakeKey(10 * i), children[i]));
+  }
+  parent->PopulateNewRoot(left_id, MakeKey(10 * total), right_id);
+  std::vector<page_id_t> pinned = FillPool(bpm);
+
+  // split: the recipient's first key is the one to push up
+  left->MoveHalfTo(right);
+  int half = left->GetSize();
+  EXPECT_EQ(total, half + right->GetSize());
+  EXPECT_EQ(children[half], right->ValueAt(0));
+  EXPECT_EQ(10 * half, KeyValue(right->KeyAt(0)));
+  parent->SetKeyAt(1, right->KeyAt(0));
+
+  right->MoveFirstToEndOf(left, parent, 1);
+  EXPECT_EQ(half + 1, left->GetSize());
+  EXPECT_EQ(children[half], left->ValueAt(half));
+  EXPECT_EQ(10 * half, KeyValue(left->KeyAt(half)));
+  EXPECT_EQ(10 * (half + 1), KeyValue(parent->KeyAt(1)));
+
+  left->MoveLastToFrontOf(right, parent, 1);
+  EXPECT_EQ(half, left->GetSize());
+  EXPECT_EQ(children[half], right->ValueAt(0));
+  EXPECT_EQ(10 * (half + 1), KeyValue(right->KeyAt(1)));
+  EXPECT_EQ(10 * half, KeyValue(parent->KeyAt(1)));
+
+  // merge, with one child less so that the children fit in one page
+  right->Remove(right->GetSize() - 1);
+  right->MoveAllTo(left, parent->KeyAt(1));
+  EXPECT_EQ(0, right->GetSize());
+  EXPECT_EQ(total - 1, left->GetSize());
+  for (int i = 0; i < total - 1; i++) {
+    EXPECT_EQ(children[i], left->ValueAt(i));
+    if (i > 0) {
+      EXPECT_EQ(10 * i, KeyValue(left->KeyAt(i)));
+    }
+  }
+
+  // the buffer pool overloads need the children
+  bool threw = false;
+  try {
+    left->MoveFirstToEndOf(right, bpm);
+  } catch (Exception &e) {
+    threw = true;
+  }
+  EXPECT_EQ(true, threw);
+
+  for (page_id_t page_id : pinned) {
+    bpm->UnpinPage(page_id, false);
+  }
+  // none of the children was fetched, they all still name left as parent
+  for (int i = 0; i < total; i++) {
+    EXPECT_EQ(left_id, ParentOf(bpm, children[i]));
+  }
+
+  bpm->UnpinPage(parent_id, true);
+  bpm->UnpinPage(left_id, true);
+  bpm->UnpinPage(right_id, true);
+  delete bpm;
+  delete disk_manager;
+  remove("test.db");
+}
+
+} // namespace cmudb
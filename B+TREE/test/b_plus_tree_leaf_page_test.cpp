@@ -0,0 +1,133 @@
+/**
+ * b_plus_tree_leaf_page_test.cpp
+ */
+
+#include <algorithm>
+#include <cstdio>
+#include <random>
+#include <set>
+#include <vector>
+
+#include "buffer/buffer_pool_manager.h"
+#include "common/rid.h"
+#include "page/b_plus_tree_leaf_page.h"
+#include "vtable/virtual_table.h"
+#include "gtest/gtest.h"
+
+namespace cmudb {
+
+typedef GenericKey<8> KeyType;
+typedef GenericComparator<8> ComparatorType;
+typedef BPlusTreeLeafPage<KeyType, RID, ComparatorType> LeafPage;
+
+static KeyType MakeKey(int64_t value) {
+  KeyType key;
+  key.SetFromInteger(value);
+  return key;
+}
+
+static int64_t KeyValue(const KeyType &key) { return key.ToString(); }
+
+/*
+ * Starts both pages from existing, inserts added into one with InsertMany
+ * and into the other with repeated Insert, and checks that they end up
+ * with the same entries.
+ */
+static void CheckInsertMany(LeafPage *many, LeafPage *single, const std::vector<int64_t> &existing,
+                            const std::vector<int64_t> &added, const ComparatorType &comparator) {
+  many->SetSize(0);
+  single->SetSize(0);
+  for (int64_t value : existing) {
+    many->Insert(MakeKey(value), RID(0, static_cast<int32_t>(value)), comparator);
+    single->Insert(MakeKey(value), RID(0, static_cast<int32_t>(value)), comparator);
+  }
+  std::vector<std::pair<KeyType, RID>> items;
+  for (int64_t value : added) {
+    items.emplace_back(MakeKey(value), RID(1, static_cast<int32_t>(value)));
+    single->Insert(items.back().first, items.back().second, comparator);
+  }
+  int size = many->InsertMany(items.data(), static_cast<int>(items.size()), comparator);
+  EXPECT_EQ(static_cast<int>(existing.size() + added.size()), size);
+  ASSERT_EQ(single->GetSize(), many->GetSize());
+  for (int i = 0; i < many->GetSize(); i++) {
+    EXPECT_EQ(KeyValue(single->KeyAt(i)), KeyValue(many->KeyAt(i)));
+    EXPECT_EQ(single->GetItem(i).second, many->GetItem(i).second);
+    if (i > 0) {
+      EXPECT_LT(KeyValue(many->KeyAt(i - 1)), KeyValue(many->KeyAt(i)));
+    }
+  }
+  for (int64_t value : added) {
+    RID rid;
+    EXPECT_EQ(true, many->Lookup(MakeKey(value), rid, comparator));
+    EXPECT_EQ(RID(1, static_cast<int32_t>(value)), rid);
+  }
+}
+
+TEST(BPlusTreeLeafPageTest, InsertManyTest) {
+  Schema *key_schema = ParseCreateStatement("a bigint");
+  ComparatorType comparator(key_schema);
+  DiskManager *disk_manager = new DiskManager("test.db");
+  BufferPoolManager *bpm = new BufferPoolManager(10, disk_manager);
+
+  page_id_t many_id, single_id;
+  auto *many = reinterpret_cast<LeafPage *>(bpm->NewPage(many_id)->GetData());
+  auto *single = reinterpret_cast<LeafPage *>(bpm->NewPage(single_id)->GetData());
+  many->Init(many_id);
+  single->Init(single_id);
+  const int max_size = many->GetMaxSize();
+  ASSERT_EQ(true, max_size >= 8);
+
+  std::vector<int64_t> existing;
+  for (int64_t i = 0; i < max_size / 2; i++) {
+    existing.push_back(10 * (i + 1));
+  }
+  std::vector<int64_t> interleaved, before, after;
+  for (int64_t i = 0; i < max_size / 2; i++) {
+    interleaved.push_back(10 * (i + 1) + 5);
+    before.push_back(i - max_size);
+    after.push_back(10 * (max_size + i));
+  }
+  CheckInsertMany(many, single, existing, interleaved, comparator);
+  CheckInsertMany(many, single, existing, before, comparator);
+  CheckInsertMany(many, single, existing, after, comparator);
+  // into an empty page, and nothing at all
+  CheckInsertMany(many, single, {}, interleaved, comparator);
+  CheckInsertMany(many, single, existing, {}, comparator);
+
+  // up to one over max size, as Insert leaves a page before its split
+  std::vector<int64_t> fill;
+  for (int64_t i = 0; static_cast<int>(existing.size() + fill.size()) < max_size + 1; i++) {
+    fill.push_back(i % 2 == 0 ? 10 * i + 5 : 100000 + i);
+  }
+  std::sort(fill.begin(), fill.end());
+  CheckInsertMany(many, single, existing, fill, comparator);
+  EXPECT_EQ(max_size + 1, many->GetSize());
+
+  // random batches
+  std::mt19937 rng(1);
+  for (int round = 0; round < 200; round++) {
+    std::set<int64_t> present, batch;
+    int present_size = static_cast<int>(rng() % (max_size + 1));
+    while (static_cast<int>(present.size()) < present_size) {
+      present.insert(rng() % 1000);
+    }
+    int batch_size = static_cast<int>(rng() % (max_size + 2 - present_size));
+    while (static_cast<int>(batch.size()) < batch_size) {
+      int64_t value = rng() % 1000;
+      if (present.count(value) == 0) {
+        batch.insert(value);
+      }
+    }
+    CheckInsertMany(many, single, std::vector<int64_t>(present.begin(), present.end()),
+                    std::vector<int64_t>(batch.begin(), batch.end()), comparator);
+  }
+
+  bpm->UnpinPage(many_id, true);
+  bpm->UnpinPage(single_id, true);
+  delete bpm;
+  delete disk_manager;
+  delete key_schema;
+  remove("test.db");
+}
+
+} // namespace cmudb
@@ -0,0 +1,250 @@
+/**
+ * b_plus_tree_optimistic_descent_test.cpp
+ */
+
+#include <atomic>
+#include <cstdio>
+#include <thread>
+#include <vector>
+
+#include "buffer/buffer_pool_manager.h"
+#include "common/rid.h"
+#include "index/b_plus_tree_bulk_loader.h"
+#include "index/b_plus_tree_optimistic_descent.h"
+#include "page/header_page.h"
+#include "vtable/virtual_table.h"
+#include "gtest/gtest.h"
+
+namespace cmudb {
+
+typedef GenericKey<8> KeyType;
+typedef GenericComparator<8> ComparatorType;
+typedef BPlusTreeLeafPage<KeyType, RID, ComparatorType> LeafPage;
+typedef BPlusTreeInternalPage<KeyType, page_id_t, ComparatorType> InternalPage;
+typedef BPlusTreeOptimisticDescent<KeyType, RID, ComparatorType> Descent;
+
+static KeyType MakeKey(int64_t value) {
+  KeyType key;
+  key.SetFromInteger(value);
+  return key;
+}
+
+/*
+ * Inserts key into a two level tree by latch crabbing, the way a writer falls
+ * back when FindLeaf returns nullptr: the root stays write-latched through a
+ * leaf split, and the new leaf is initialized before it becomes reachable.
+ */
+static void CrabInsert(BufferPoolManager *bpm, page_id_t root_id, const KeyType &key,
+                       const RID &rid, const ComparatorType &comparator) {
+  Page *root_page = bpm->FetchPage(root_id);
+  BPlusTreePage::WLatch(root_page);
+  auto *root = reinterpret_cast<InternalPage *>(root_page->GetData());
+  page_id_t leaf_id = root->Lookup(key, comparator);
+  Page *leaf_page = bpm->FetchPage(leaf_id);
+  BPlusTreePage::WLatch(leaf_page);
+  auto *leaf = reinterpret_cast<LeafPage *>(leaf_page->GetData());
+  if (leaf->Insert(key, rid, comparator) > leaf->GetMaxSize()) {
+    page_id_t sibling_id;
+    Page *sibling_page = bpm->NewPage(sibling_id);
+    auto *sibling = reinterpret_cast<LeafPage *>(sibling_page->GetData());
+    sibling->Init(sibling_id, root_id);
+    leaf->MoveHalfTo(sibling, bpm);
+    root->InsertNodeAfter(leaf_id, sibling->KeyAt(0), sibling_id);
+    bpm->UnpinPage(sibling_id, true);
+  }
+  BPlusTreePage::WUnlatch(leaf_page);
+  bpm->UnpinPage(leaf_id, true);
+  BPlusTreePage::WUnlatch(root_page);
+  bpm->UnpinPage(root_id, true);
+}
+
+/*
+ * Optimistic readers look up keys while a writer inserts between them and
+ * splits leaves under the root. Every key loaded or already inserted must be
+ * found, whichever state of a split a reader's descent ran into.
+ */
+TEST(BPlusTreeOptimisticDescentTest, ConcurrentSplitTest) {
+  Schema *key_schema = ParseCreateStatement("a bigint");
+  ComparatorType comparator(key_schema);
+  DiskManager *disk_manager = new DiskManager("test.db");
+  BufferPoolManager *bpm = new BufferPoolManager(100, disk_manager);
+  page_id_t header_id;
+  static_cast<HeaderPage *>(bpm->NewPage(header_id))->Init();
+  bpm->UnpinPage(header_id, true);
+
+  // half full leaves under one root, with room in the root for every split
+  const int leaf_max = (PAGE_SIZE - sizeof(LeafPage)) / sizeof(std::pair<KeyType, RID>) - 1;
+  const int loaded = 4 * leaf_max;
+  BPlusTreeBulkLoader<KeyType, RID, ComparatorType> loader(bpm, comparator, loaded, 0.5);
+  for (int i = 0; i < loaded; i++) {
+    loader.Append(MakeKey(4 * i), RID(0, i));
+  }
+  page_id_t root_id = loader.Finish();
+  ASSERT_EQ(2, loader.GetHeight());
+
+  Descent descent(bpm, comparator);
+  // keys 4 * i + 1 for i < inserted are in the tree
+  std::atomic<int> inserted(0);
+  std::atomic<bool> done(false);
+  std::atomic<int> missing(0);
+  auto reader = [&](int seed) {
+    unsigned state = seed;
+    while (!done.load()) {
+      state = state * 1103515245 + 12345;
+      int i = (state >> 8) % loaded;
+      int64_t value = 4 * i;
+      int32_t slot = i;
+      int published = inserted.load();
+      if ((state & 1) != 0 && published > 0) {
+        i = (state >> 8) % published;
+        value = 4 * i + 1;
+        slot = loaded + i;
+      }
+      Page *page = descent.FindLeaf(root_id, MakeKey(value), OpType::READ);
+      if (page == nullptr) {
+        continue;
+      }
+      RID rid;
+      if (!reinterpret_cast<LeafPage *>(page->GetData())->Lookup(MakeKey(value), rid, comparator) ||
+          !(rid == RID(0, slot))) {
+        missing++;
+      }
+      descent.ReleaseLeaf(page, OpType::READ, false);
+    }
+  };
+  std::vector<std::thread> readers;
+  for (int seed = 1; seed <= 3; seed++) {
+    readers.emplace_back(reader, seed);
+  }
+
+  for (int i = 0; i < loaded; i++) {
+    KeyType key = MakeKey(4 * i + 1);
+    RID rid(0, loaded + i);
+    Page *page = descent.FindLeaf(root_id, key, OpType::INSERT);
+    if (page != nullptr) {
+      reinterpret_cast<LeafPage *>(page->GetData())->Insert(key, rid, comparator);
+      descent.ReleaseLeaf(page, OpType::INSERT, true);
+    } else {
+      CrabInsert(bpm, root_id, key, rid, comparator);
+    }
+    inserted++;
+  }
+  done = true;
+  for (auto &thread : readers) {
+    thread.join();
+  }
+  EXPECT_EQ(0, missing.load());
+  // some inserts had to split their leaf and crabbed instead
+  EXPECT_LT(0u, descent.GetFallbacks());
+
+  for (int i = 0; i < loaded; i++) {
+    for (int64_t value : {4 * i, 4 * i + 1}) {
+      Page *page = descent.FindLeaf(root_id, MakeKey(value), OpType::READ);
+      ASSERT_NE(nullptr, page);
+      RID rid;
+      EXPECT_EQ(true,
+                reinterpret_cast<LeafPage *>(page->GetData())->Lookup(MakeKey(value), rid, comparator));
+      descent.ReleaseLeaf(page, OpType::READ, false);
+    }
+  }
+
+  delete bpm;
+  delete disk_manager;
+  delete key_schema;
+  remove("test.db");
+}
+
+/*
+ * A page is odd for as long as it is write-latched, whatever page methods
+ * run in between; Init makes it even, and a page flushed in the middle of a
+ * write is recovered by the first descent that reads it back.
+ */
+TEST(BPlusTreeOptimisticDescentTest, VersionTest) {
+  Schema *key_schema = ParseCreateStatement("a bigint");
+  ComparatorType comparator(key_schema);
+  DiskManager *disk_manager = new DiskManager("test.db");
+  BufferPoolManager *bpm = new BufferPoolManager(10, disk_manager);
+
+  page_id_t leaf_id;
+  Page *page = bpm->NewPage(leaf_id);
+  auto *leaf = reinterpret_cast<LeafPage *>(page->GetData());
+  leaf->BeginWrite();
+  leaf->Init(leaf_id);
+  EXPECT_EQ(0u, leaf->ReadVersion());
+  // dirty, for FlushPage to write it
+  bpm->UnpinPage(leaf_id, true);
+  EXPECT_EQ(page, bpm->FetchPage(leaf_id));
+
+  BPlusTreePage::WLatch(page);
+  uint32_t version = leaf->ReadVersion();
+  EXPECT_EQ(1u, version & 1);
+  leaf->Insert(MakeKey(1), RID(0, 1), comparator);
+  leaf->SetParentPageId(INVALID_PAGE_ID);
+  EXPECT_EQ(version, leaf->ReadVersion());
+  EXPECT_EQ(false, leaf->ValidateVersion(version));
+
+  // written out while still latched, and lost again before the next write
+  EXPECT_EQ(true, bpm->FlushPage(leaf_id));
+  char flushed[PAGE_SIZE];
+  disk_manager->ReadPage(leaf_id, flushed);
+  BPlusTreePage::WUnlatch(page);
+  EXPECT_EQ(version + 1, leaf->ReadVersion());
+  bpm->UnpinPage(leaf_id, true);
+  delete bpm;
+  disk_manager->WritePage(leaf_id, flushed);
+
+  bpm = new BufferPoolManager(10, disk_manager);
+  leaf = reinterpret_cast<LeafPage *>(bpm->FetchPage(leaf_id)->GetData());
+  EXPECT_EQ(version, leaf->ReadVersion());
+  Descent descent(bpm, comparator);
+  page = descent.FindLeaf(leaf_id, MakeKey(1), OpType::READ);
+  ASSERT_NE(nullptr, page);
+  EXPECT_EQ(version + 1, leaf->ReadVersion());
+  EXPECT_EQ(true, leaf->ValidateVersion(version + 1));
+  descent.ReleaseLeaf(page, OpType::READ, false);
+  EXPECT_EQ(0u, descent.GetRestarts());
+  bpm->UnpinPage(leaf_id, false);
+
+  delete bpm;
+  delete disk_manager;
+  delete key_schema;
+  remove("test.db");
+}
+
+// a tree that is a single leaf is written optimistically too
+TEST(BPlusTreeOptimisticDescentTest, RootLeafTest) {
+  Schema *key_schema = ParseCreateStatement("a bigint");
+  ComparatorType comparator(key_schema);
+  DiskManager *disk_manager = new DiskManager("test.db");
+  BufferPoolManager *bpm = new BufferPoolManager(10, disk_manager);
+
+  page_id_t root_id;
+  auto *root = reinterpret_cast<LeafPage *>(bpm->NewPage(root_id)->GetData());
+  root->Init(root_id);
+  bpm->UnpinPage(root_id, true);
+
+  Descent descent(bpm, comparator);
+  for (int64_t value = 1; value <= 3; value++) {
+    Page *page = descent.FindLeaf(root_id, MakeKey(value), OpType::INSERT);
+    ASSERT_NE(nullptr, page);
+    EXPECT_EQ(root_id, page->GetPageId());
+    reinterpret_cast<LeafPage *>(page->GetData())
+        ->Insert(MakeKey(value), RID(0, static_cast<int32_t>(value)), comparator);
+    descent.ReleaseLeaf(page, OpType::INSERT, true);
+  }
+  Page *page = descent.FindLeaf(root_id, MakeKey(2), OpType::DELETE);
+  ASSERT_NE(nullptr, page);
+  auto *leaf = reinterpret_cast<LeafPage *>(page->GetData());
+  EXPECT_EQ(2, leaf->RemoveAndDeleteRecord(MakeKey(2), comparator));
+  descent.ReleaseLeaf(page, OpType::DELETE, true);
+  EXPECT_EQ(0u, leaf->ReadVersion() & 1);
+  EXPECT_EQ(0u, descent.GetRestarts());
+  EXPECT_EQ(0u, descent.GetFallbacks());
+
+  delete bpm;
+  delete disk_manager;
+  delete key_schema;
+  remove("test.db");
+}
+
+} // namespace cmudb
@@ -0,0 +1,138 @@
+/**
+ * b_plus_tree_search_benchmark_test.cpp
+ */
+
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <iostream>
+#include <random>
+#include <string>
+
+#include "buffer/buffer_pool_manager.h"
+#include "common/rid.h"
+#include "page/b_plus_tree_internal_page.h"
+#include "page/b_plus_tree_leaf_page.h"
+#include "page/b_plus_tree_separated_internal_page.h"
+#include "page/b_plus_tree_separated_leaf_page.h"
+#include "vtable/virtual_table.h"
+#include "gtest/gtest.h"
+
+namespace cmudb {
+
+const int NUM_PROBES = 1000000;
+
+template <typename Function> double LookupsPerSecond(Function lookup) {
+  auto start = std::chrono::steady_clock::now();
+  for (int i = 0; i < NUM_PROBES; i++) {
+    lookup(i);
+  }
+  std::chrono::duration<double> elapsed = std::chrono::steady_clock::now() - start;
+  return NUM_PROBES / elapsed.count();
+}
+
+// the same keys in a full page of each layout, searched with the same probes
+template <typename KeyType, typename ComparatorType>
+void SearchBenchmark(const std::string &name) {
+  Schema *key_schema = ParseCreateStatement(sizeof(KeyType) == 4 ? "a int" : "a bigint");
+  ComparatorType comparator(key_schema);
+  DiskManager *disk_manager = new DiskManager("test.db");
+  BufferPoolManager *bpm = new BufferPoolManager(10, disk_manager);
+
+  page_id_t leaf_id, separated_leaf_id, internal_id, separated_internal_id;
+  auto *leaf = reinterpret_cast<BPlusTreeLeafPage<KeyType, RID, ComparatorType> *>(
+      bpm->NewPage(leaf_id)->GetData());
+  auto *separated_leaf =
+      reinterpret_cast<BPlusTreeSeparatedLeafPage<KeyType, RID, ComparatorType> *>(
+          bpm->NewPage(separated_leaf_id)->GetData());
+  auto *internal =
+      reinterpret_cast<BPlusTreeInternalPage<KeyType, page_id_t, ComparatorType> *>(
+          bpm->NewPage(internal_id)->GetData());
+  auto *separated_internal = reinterpret_cast<
+      BPlusTreeSeparatedInternalPage<KeyType, page_id_t, ComparatorType> *>(
+      bpm->NewPage(separated_internal_id)->GetData());
+  leaf->Init(leaf_id);
+  separated_leaf->Init(separated_leaf_id);
+  internal->Init(internal_id);
+  separated_internal->Init(separated_internal_id);
+
+  // even keys, so that odd probes miss
+  std::mt19937 rng(15445);
+  int num_keys = std::min(std::min(leaf->GetMaxSize(), separated_leaf->GetMaxSize()),
+                          std::min(internal->GetMaxSize(), separated_internal->GetMaxSize()));
+  std::vector<KeyType> keys(num_keys);
+  for (int i = 0; i < num_keys; i++) {
+    keys[i].SetFromInteger(2 * i);
+  }
+  std::sort(keys.begin(), keys.end(), [&](const KeyType &a, const KeyType &b) {
+    return comparator(a, b) < 0;
+  });
+  std::vector<int> order(num_keys);
+  for (int i = 0; i < num_keys; i++) {
+    order[i] = i;
+  }
+  std::shuffle(order.begin(), order.end(), rng);
+  for (int i : order) {
+    leaf->Insert(keys[i], RID(i, 0), comparator);
+    separated_leaf->Insert(keys[i], RID(i, 0), comparator);
+  }
+  internal->PopulateNewRoot(0, keys[1], 1);
+  separated_internal->PopulateNewRoot(0, keys[1], 1);
+  for (int i = 2; i < num_keys; i++) {
+    internal->InsertNodeAfter(i - 1, keys[i], i);
+    separated_internal->InsertNodeAfter(i - 1, keys[i], i);
+  }
+
+  std::vector<KeyType> probes(4096);
+  for (auto &probe : probes) {
+    probe.SetFromInteger(rng() % (2 * num_keys));
+  }
+  for (auto &probe : probes) {
+    EXPECT_EQ(leaf->KeyIndex(probe, comparator),
+              separated_leaf->KeyIndex(probe, comparator));
+    EXPECT_EQ(internal->Lookup(probe, comparator),
+              separated_internal->Lookup(probe, comparator));
+  }
+
+  const size_t mask = probes.size() - 1;
+  long sink = 0;
+  double leaf_pairs = LookupsPerSecond([&](int i) {
+    sink += leaf->KeyIndex(probes[i & mask], comparator);
+  });
+  double leaf_separated = LookupsPerSecond([&](int i) {
+    sink += separated_leaf->KeyIndex(probes[i & mask], comparator);
+  });
+  double internal_pairs = LookupsPerSecond([&](int i) {
+    sink += internal->Lookup(probes[i & mask], comparator);
+  });
+  double internal_separated = LookupsPerSecond([&](int i) {
+    sink += separated_internal->Lookup(probes[i & mask], comparator);
+  });
+  std::cout << name << ", " << num_keys << " keys per page"
+            << " (lookups/s, pairs vs separated)" << std::endl
+            << "  leaf KeyIndex:  " << leaf_pairs << " vs " << leaf_separated << std::endl
+            << "  internal Lookup: " << internal_pairs << " vs " << internal_separated
+            << " (" << sink % 2 << ")" << std::endl;
+
+  bpm->UnpinPage(leaf_id, false);
+  bpm->UnpinPage(separated_leaf_id, false);
+  bpm->UnpinPage(internal_id, false);
+  bpm->UnpinPage(separated_internal_id, false);
+  delete bpm;
+  delete disk_manager;
+  delete key_schema;
+  remove("test.db");
+}
+
+TEST(BPlusTreeSearchTest, SearchBenchmarkTest) {
+  SearchBenchmark<GenericKey<4>, GenericComparator<4>>("GenericKey<4>");
+  SearchBenchmark<GenericKey<8>, GenericComparator<8>>("GenericKey<8>");
+}
+
+// memcmp-orderable keys compare as one integer instead of through the schema
+TEST(BPlusTreeSearchTest, NormalizedKeySearchBenchmarkTest) {
+  SearchBenchmark<NormalizedKey<4>, NormalizedComparator<4>>("NormalizedKey<4>");
+  SearchBenchmark<NormalizedKey<8>, NormalizedComparator<8>>("NormalizedKey<8>");
+}
+
+} // namespace cmudb
@@ -0,0 +1,177 @@
+/**
+ * b_plus_tree_separated_page_test.cpp
+ */
+
+#include <algorithm>
+#include <cstdio>
+#include <string>
+
+#include "buffer/buffer_pool_manager.h"
+#include "common/rid.h"
+#include "page/b_plus_tree_separated_internal_page.h"
+#include "page/b_plus_tree_separated_leaf_page.h"
+#include "vtable/virtual_table.h"
+#include "gtest/gtest.h"
+
+namespace cmudb {
+
+typedef GenericKey<8> KeyType;
+typedef GenericComparator<8> ComparatorType;
+typedef BPlusTreeSeparatedLeafPage<KeyType, RID, ComparatorType> LeafPage;
+typedef BPlusTreeSeparatedInternalPage<KeyType, page_id_t, ComparatorType> InternalPage;
+
+static KeyType MakeKey(int64_t value) {
+  KeyType key;
+  key.SetFromInteger(value);
+  return key;
+}
+
+static int64_t KeyValue(const KeyType &key) { return key.ToString(); }
+
+// LookupIndex is the slot Lookup descends into, and a stale slot hint falls
+// back to the scan
+TEST(BPlusTreeSeparatedPageTest, LookupIndexTest) {
+  Schema *key_schema = ParseCreateStatement("a bigint");
+  ComparatorType comparator(key_schema);
+  DiskManager *disk_manager = new DiskManager("test.db");
+  BufferPoolManager *bpm = new BufferPoolManager(10, disk_manager);
+
+  page_id_t page_id;
+  auto *page = reinterpret_cast<InternalPage *>(bpm->NewPage(page_id)->GetData());
+  page->Init(page_id);
+  page->PopulateNewRoot(100, MakeKey(10), 101);
+  for (int i = 2; i < 8; i++) {
+    page->InsertNodeAfter(100 + i - 1, MakeKey(10 * i), 100 + i);
+  }
+  for (int64_t key = 0; key < 90; key++) {
+    int slot = page->LookupIndex(MakeKey(key), comparator);
+    EXPECT_EQ(std::min<int64_t>(key / 10, 7), slot);
+    EXPECT_EQ(page->Lookup(MakeKey(key), comparator), page->ValueAt(slot));
+  }
+  page->InsertNodeAt(3, MakeKey(25), 200);
+  EXPECT_EQ(3, page->ValueIndex(200, 3));
+  EXPECT_EQ(4, page->ValueIndex(103, 3));
+  EXPECT_EQ(8, page->ValueIndex(107, -1));
+  EXPECT_EQ(-1, page->ValueIndex(300, 0));
+
+  bpm->UnpinPage(page_id, true);
+  delete bpm;
+  delete disk_manager;
+  delete key_schema;
+  remove("test.db");
+}
+
+// a leaf shifts one entry at a time to its sibling and back, with the
+// separator in the parent following the boundary
+TEST(BPlusTreeSeparatedPageTest, LeafRedistributeTest) {
+  Schema *key_schema = ParseCreateStatement("a bigint");
+  ComparatorType comparator(key_schema);
+  DiskManager *disk_manager = new DiskManager("test.db");
+  BufferPoolManager *bpm = new BufferPoolManager(10, disk_manager);
+
+  page_id_t parent_id, left_id, right_id;
+  auto *parent = reinterpret_cast<InternalPage *>(bpm->NewPage(parent_id)->GetData());
+  auto *left = reinterpret_cast<LeafPage *>(bpm->NewPage(left_id)->GetData());
+  auto *right = reinterpret_cast<LeafPage *>(bpm->NewPage(right_id)->GetData());
+  parent->Init(parent_id);
+  left->Init(left_id, parent_id);
+  right->Init(right_id, parent_id);
+  for (int64_t i = 1; i <= 4; i++) {
+    left->Insert(MakeKey(i), RID(0, static_cast<int32_t>(i)), comparator);
+    right->Insert(MakeKey(i + 10), RID(0, static_cast<int32_t>(i + 10)), comparator);
+  }
+  parent->PopulateNewRoot(left_id, MakeKey(11), right_id);
+
+  EXPECT_EQ(2, KeyValue(left->GetItem(1).first));
+  EXPECT_EQ(2, left->GetItem(1).second.GetSlotNum());
+  EXPECT_EQ("1 2 3 4", left->ToString());
+  EXPECT_NE(std::string::npos, left->ToString(true).find("parentId: " + std::to_string(parent_id)));
+
+  right->MoveFirstToEndOf(left, parent, 1);
+  EXPECT_EQ(5, left->GetSize());
+  EXPECT_EQ(3, right->GetSize());
+  EXPECT_EQ(11, KeyValue(left->KeyAt(4)));
+  EXPECT_EQ(11, left->ValueAt(4).GetSlotNum());
+  EXPECT_EQ(12, KeyValue(right->KeyAt(0)));
+  EXPECT_EQ(12, KeyValue(parent->KeyAt(1)));
+
+  left->MoveLastToFrontOf(right, parent, 1);
+  EXPECT_EQ(4, left->GetSize());
+  EXPECT_EQ("11 12 13 14", right->ToString());
+  EXPECT_EQ(11, KeyValue(parent->KeyAt(1)));
+
+  // the same through the overloads that fetch the parent
+  right->MoveFirstToEndOf(left, bpm);
+  EXPECT_EQ("1 2 3 4 11", left->ToString());
+  EXPECT_EQ(12, KeyValue(parent->KeyAt(1)));
+  left->MoveLastToFrontOf(right, 1, bpm);
+  EXPECT_EQ("11 12 13 14", right->ToString());
+  EXPECT_EQ(11, KeyValue(parent->KeyAt(1)));
+
+  bpm->UnpinPage(parent_id, true);
+  bpm->UnpinPage(left_id, true);
+  bpm->UnpinPage(right_id, true);
+  delete bpm;
+  delete disk_manager;
+  delete key_schema;
+  remove("test.db");
+}
+
+// an internal page rotates a child through the parent: the separator comes
+// down with the moved child and the moved boundary key goes up
+TEST(BPlusTreeSeparatedPageTest, InternalRedistributeTest) {
+  Schema *key_schema = ParseCreateStatement("a bigint");
+  DiskManager *disk_manager = new DiskManager("test.db");
+  BufferPoolManager *bpm = new BufferPoolManager(20, disk_manager);
+
+  page_id_t parent_id, left_id, right_id;
+  auto *parent = reinterpret_cast<InternalPage *>(bpm->NewPage(parent_id)->GetData());
+  auto *left = reinterpret_cast<InternalPage *>(bpm->NewPage(left_id)->GetData());
+  auto *right = reinterpret_cast<InternalPage *>(bpm->NewPage(right_id)->GetData());
+  parent->Init(parent_id);
+  left->Init(left_id, parent_id);
+  right->Init(right_id, parent_id);
+  // six leaf children, three under each page
+  page_id_t children[6];
+  for (int i = 0; i < 6; i++) {
+    auto *child = reinterpret_cast<LeafPage *>(bpm->NewPage(children[i])->GetData());
+    child->Init(children[i], i < 3 ? left_id : right_id);
+    bpm->UnpinPage(children[i], true);
+  }
+  left->PopulateNewRoot(children[0], MakeKey(10), children[1]);
+  left->InsertNodeAt(2, MakeKey(20), children[2]);
+  right->PopulateNewRoot(children[3], MakeKey(40), children[4]);
+  right->InsertNodeAt(2, MakeKey(50), children[5]);
+  parent->PopulateNewRoot(left_id, MakeKey(30), right_id);
+  EXPECT_EQ("30", parent->ToString(false));
+  EXPECT_EQ("10 20", left->ToString(false));
+
+  right->MoveFirstToEndOf(left, bpm);
+  EXPECT_EQ("10 20 30", left->ToString(false));
+  EXPECT_EQ(children[3], left->ValueAt(3));
+  EXPECT_EQ("50", right->ToString(false));
+  EXPECT_EQ(children[4], right->ValueAt(0));
+  EXPECT_EQ(40, KeyValue(parent->KeyAt(1)));
+  auto *moved = reinterpret_cast<BPlusTreePage *>(bpm->FetchPage(children[3])->GetData());
+  EXPECT_EQ(left_id, moved->GetParentPageId());
+  bpm->UnpinPage(children[3], false);
+
+  left->MoveLastToFrontOf(right, 1, bpm);
+  EXPECT_EQ("10 20", left->ToString(false));
+  EXPECT_EQ("40 50", right->ToString(false));
+  EXPECT_EQ(children[3], right->ValueAt(0));
+  EXPECT_EQ(30, KeyValue(parent->KeyAt(1)));
+  moved = reinterpret_cast<BPlusTreePage *>(bpm->FetchPage(children[3])->GetData());
+  EXPECT_EQ(right_id, moved->GetParentPageId());
+  bpm->UnpinPage(children[3], false);
+
+  bpm->UnpinPage(parent_id, true);
+  bpm->UnpinPage(left_id, true);
+  bpm->UnpinPage(right_id, true);
+  delete bpm;
+  delete disk_manager;
+  delete key_schema;
+  remove("test.db");
+}
+
+} // namespace cmudb
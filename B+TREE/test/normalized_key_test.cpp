@@ -0,0 +1,172 @@
+/**
+ * normalized_key_test.cpp
+ */
+
+#include <cstring>
+#include <limits>
+#include <random>
+#include <vector>
+
+#include "index/normalized_key.h"
+#include "gtest/gtest.h"
+
+namespace cmudb {
+
+template <size_t KeySize>
+static int Sign(const NormalizedKey<KeySize> &a, const NormalizedKey<KeySize> &b) {
+  int cmp = memcmp(a.data, b.data, KeySize);
+  return (cmp > 0) - (cmp < 0);
+}
+
+// keys encoded from values in increasing order compare in increasing order,
+// by the comparator and by their bytes
+template <size_t KeySize>
+static void CheckIncreasing(const std::vector<NormalizedKey<KeySize>> &keys) {
+  NormalizedComparator<KeySize> comparator;
+  for (size_t i = 0; i < keys.size(); i++) {
+    for (size_t j = 0; j < keys.size(); j++) {
+      int expected = (i > j) - (i < j);
+      EXPECT_EQ(expected, comparator(keys[i], keys[j]));
+      EXPECT_EQ(expected, Sign(keys[i], keys[j]));
+    }
+  }
+}
+
+TEST(NormalizedKeyTest, IntegerOrderTest) {
+  std::vector<int64_t> values{std::numeric_limits<int64_t>::min(),
+                              std::numeric_limits<int64_t>::min() + 1,
+                              -(1LL << 32) - 1,
+                              -(1LL << 31),
+                              -256,
+                              -1,
+                              0,
+                              1,
+                              255,
+                              256,
+                              1LL << 31,
+                              1LL << 32,
+                              std::numeric_limits<int64_t>::max() - 1,
+                              std::numeric_limits<int64_t>::max()};
+  std::vector<NormalizedKey<8>> keys(values.size());
+  for (size_t i = 0; i < values.size(); i++) {
+    keys[i].SetFromInteger(values[i]);
+    EXPECT_EQ(values[i], keys[i].ToInteger());
+  }
+  CheckIncreasing(keys);
+
+  // random values over the whole range, and their close neighbours
+  std::mt19937_64 rng(15445);
+  NormalizedComparator<8> comparator;
+  NormalizedKey<8> a, b;
+  for (int i = 0; i < 10000; i++) {
+    int64_t x = static_cast<int64_t>(rng());
+    int64_t y = static_cast<int64_t>(rng());
+    if (i % 2) {
+      int64_t delta = static_cast<int64_t>(rng() % 3) - 1;
+      bool overflows = (delta > 0 && x == std::numeric_limits<int64_t>::max()) ||
+                       (delta < 0 && x == std::numeric_limits<int64_t>::min());
+      y = overflows ? x : x + delta;
+    }
+    a.SetFromInteger(x);
+    b.SetFromInteger(y);
+    EXPECT_EQ(x, a.ToInteger());
+    EXPECT_EQ((x > y) - (x < y), comparator(a, b));
+    EXPECT_EQ((x > y) - (x < y), Sign(a, b));
+  }
+}
+
+TEST(NormalizedKeyTest, FourByteKeyTest) {
+  std::vector<int64_t> values{std::numeric_limits<int32_t>::min(),
+                              std::numeric_limits<int32_t>::min() + 1,
+                              -65536,
+                              -1,
+                              0,
+                              1,
+                              65536,
+                              std::numeric_limits<int32_t>::max() - 1,
+                              std::numeric_limits<int32_t>::max()};
+  std::vector<NormalizedKey<4>> keys(values.size());
+  for (size_t i = 0; i < values.size(); i++) {
+    keys[i].SetFromInteger(values[i]);
+    EXPECT_EQ(values[i], keys[i].ToInteger());
+  }
+  CheckIncreasing(keys);
+
+  std::mt19937 rng(15445);
+  NormalizedKey<4> key;
+  for (int i = 0; i < 10000; i++) {
+    int64_t value = static_cast<int32_t>(rng());
+    key.SetFromInteger(value);
+    EXPECT_EQ(value, key.ToInteger());
+  }
+}
+
+// narrow integer columns keep their order with negative values, and a
+// column decides the order only when the ones before it are equal
+TEST(NormalizedKeyTest, IntegerWidthTest) {
+  for (size_t width : {1, 2, 4}) {
+    int64_t max = (1LL << (width * 8 - 1)) - 1;
+    int64_t min = -max - 1;
+    std::vector<int64_t> values{min, min + 1, -2, -1, 0, 1, 2, max - 1, max};
+    std::vector<NormalizedKey<8>> keys(values.size());
+    for (size_t i = 0; i < values.size(); i++) {
+      // the bytes after the column are zero, so they do not affect order
+      NormalizedKeyBuilder<8>(&keys[i]).AppendInteger(values[i], width);
+    }
+    CheckIncreasing(keys);
+  }
+
+  std::vector<NormalizedKey<8>> keys;
+  for (int64_t first : {-2, -1, 0, 1}) {
+    for (int64_t second : {-128, -1, 0, 127}) {
+      for (int64_t third : {-32768, -1, 0, 32767}) {
+        keys.emplace_back();
+        NormalizedKeyBuilder<8>(&keys.back())
+            .AppendInteger(first, 4)
+            .AppendInteger(second, 1)
+            .AppendInteger(third, 2);
+      }
+    }
+  }
+  CheckIncreasing(keys);
+}
+
+TEST(NormalizedKeyTest, DoubleOrderTest) {
+  const double infinity = std::numeric_limits<double>::infinity();
+  const double max = std::numeric_limits<double>::max();
+  const double denorm = std::numeric_limits<double>::denorm_min();
+  std::vector<double> values{-infinity, -max, -1.5, -1.0, -denorm, 0.0, denorm,
+                             1e-300,    1.0,  1.5,  max,  infinity};
+  std::vector<NormalizedKey<8>> keys(values.size());
+  for (size_t i = 0; i < values.size(); i++) {
+    NormalizedKeyBuilder<8>(&keys[i]).AppendDouble(values[i]);
+  }
+  CheckIncreasing(keys);
+
+  // -0.0 and 0.0 are the same key
+  NormalizedKey<8> negative_zero;
+  NormalizedKeyBuilder<8>(&negative_zero).AppendDouble(-0.0);
+  NormalizedComparator<8> comparator;
+  EXPECT_EQ(0, comparator(negative_zero, keys[5]));
+}
+
+// a double column followed by a fixed width string column
+TEST(NormalizedKeyTest, CompositeKeyTest) {
+  NormalizedKey<16> c, d;
+  NormalizedComparator<16> comparator;
+  NormalizedKeyBuilder<16>(&c).AppendDouble(-1.5).AppendString("ab", 2, 8);
+  NormalizedKeyBuilder<16>(&d).AppendDouble(-0.0).AppendString("a", 1, 8);
+  EXPECT_TRUE(comparator(c, d) < 0);
+  NormalizedKeyBuilder<16>(&c).AppendDouble(0.0).AppendString("a", 1, 8);
+  EXPECT_EQ(0, comparator(c, d));
+  NormalizedKeyBuilder<16>(&d).AppendDouble(0.0).AppendString("ab", 2, 8);
+  EXPECT_TRUE(comparator(c, d) < 0);
+  NormalizedKeyBuilder<16>(&d).AppendDouble(1e-300).AppendString("", 0, 8);
+  EXPECT_TRUE(comparator(c, d) < 0);
+  // longer strings are truncated to the column width
+  NormalizedKeyBuilder<16>(&c).AppendDouble(1.0).AppendString("abcdefgh", 8, 8);
+  NormalizedKeyBuilder<16>(&d).AppendDouble(1.0).AppendString("abcdefghij", 10, 8);
+  EXPECT_EQ(0, comparator(c, d));
+}
+
+} // namespace cmudb
@@ -0,0 +1,421 @@
+#include <algorithm>
+#include <cerrno>
+#include <cstdlib>
+#include <cstring>
+
+#include <fcntl.h>
+#include <linux/io_uring.h>
+#include <sys/mman.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+
+#include "common/exception.h"
+#include "disk/async_disk_manager.h"
+
+namespace scudb {
+
+    static const size_t POOL_THREADS = 4; // 线程池后端最多的线程数
+    static const size_t MIN_BLOCK_SIZE = 512; // O_DIRECT的偏移和长度至少要按逻辑块对齐
+
+    const size_t AsyncDiskManager::DIRECT_IO_ALIGNMENT;
+
+    AsyncDiskManager::AsyncDiskManager(const std::string& db_file, size_t queue_depth, bool use_io_uring,
+        bool direct_io)
+        : DiskManager(db_file), direct_io_(false), bounce_(nullptr), backend_(Backend::THREAD_POOL),
+        queue_depth_(queue_depth == 0 ? 1 : queue_depth),
+        ring_fd_(-1), sq_ring_(nullptr), cq_ring_(nullptr), sqes_(nullptr), stop_(false) {
+        fd_ = -1;
+        if (direct_io && PAGE_SIZE % MIN_BLOCK_SIZE == 0) {
+            fd_ = open(db_file.c_str(), O_RDWR | O_CREAT | O_DIRECT, 0644);
+            direct_io_ = fd_ >= 0;
+        }
+        if (fd_ < 0) {
+            fd_ = open(db_file.c_str(), O_RDWR | O_CREAT, 0644);
+        }
+        if (fd_ < 0) {
+            throw Exception("can't open db file " + db_file);
+        }
+        if (direct_io_) {
+            void* bounce = nullptr;
+            if (posix_memalign(&bounce, DIRECT_IO_ALIGNMENT, queue_depth_ * PAGE_SIZE) != 0) {
+                close(fd_);
+                throw Exception("out of memory while allocating direct I/O buffers");
+            }
+            bounce_ = static_cast<char*>(bounce);
+        }
+        requests_.resize(queue_depth_);
+        for (size_t i = queue_depth_; i > 0; --i) {
+            free_slots_.push_back(i - 1);
+        }
+        if (use_io_uring && SetupRing()) {
+            backend_ = Backend::IO_URING;
+            return;
+        }
+        size_t num_threads = std::min(queue_depth_, POOL_THREADS);
+        for (size_t i = 0; i < num_threads; ++i) {
+            workers_.emplace_back(&AsyncDiskManager::WorkerLoop, this);
+        }
+    }
+
+    /*
+     * 析构前调用者应当已经取走所有完成的请求
+     */
+    AsyncDiskManager::~AsyncDiskManager() {
+        {
+            lock_guard<mutex> lck(latch_);
+            stop_ = true;
+        }
+        work_cv_.notify_all();
+        for (auto& worker : workers_) {
+            worker.join();
+        }
+        TeardownRing();
+        close(fd_);
+        free(bounce_);
+    }
+
+    void AsyncDiskManager::WritePage(page_id_t page_id, const char* page_data) {
+        Request request{0, page_id, const_cast<char*>(page_data), false, false};
+        DoIO(request);
+    }
+
+    void AsyncDiskManager::ReadPage(page_id_t page_id, char* page_data) {
+        Request request{0, page_id, page_data, true, false};
+        DoIO(request);
+    }
+
+    void AsyncDiskManager::WritePages(page_id_t first_page_id, const char* data, size_t num_pages) {
+        if (NeedsBounce(data)) {
+            for (size_t i = 0; i < num_pages; ++i) {
+                WritePage(first_page_id + static_cast<page_id_t>(i), data + i * PAGE_SIZE);
+            }
+            return;
+        }
+        if (WriteContiguous(first_page_id, data, num_pages) == -EINVAL && direct_io_) {
+            DisableDirectIO();
+            WriteContiguous(first_page_id, data, num_pages);
+        }
+    }
+
+    bool AsyncDiskManager::SubmitRead(page_id_t page_id, char* page_data, uint64_t tag) {
+        return Enqueue(page_id, page_data, true, tag);
+    }
+
+    bool AsyncDiskManager::SubmitWrite(page_id_t page_id, const char* page_data, uint64_t tag) {
+        return Enqueue(page_id, const_cast<char*>(page_data), false, tag);
+    }
+
+    bool AsyncDiskManager::Enqueue(page_id_t page_id, char* data, bool is_read, uint64_t tag) {
+        lock_guard<mutex> lck(latch_);
+        if (free_slots_.empty()) {
+            return false;
+        }
+        size_t slot = free_slots_.back();
+        free_slots_.pop_back();
+        requests_[slot] = Request{tag, page_id, data, is_read, false};
+        queued_.push_back(slot);
+        return true;
+    }
+
+    void AsyncDiskManager::Submit() {
+        if (backend_ == Backend::IO_URING) {
+            SubmitRing();
+            return;
+        }
+        {
+            lock_guard<mutex> lck(latch_);
+            work_queue_.insert(work_queue_.end(), queued_.begin(), queued_.end());
+            queued_.clear();
+        }
+        work_cv_.notify_all();
+    }
+
+    size_t AsyncDiskManager::Complete(std::vector<Completion>& done, size_t min_complete) {
+        if (backend_ == Backend::IO_URING) {
+            return CompleteRing(done, min_complete);
+        }
+        unique_lock<mutex> lck(latch_);
+        done_cv_.wait(lck, [&] { return done_queue_.size() >= min_complete; });
+        size_t n = done_queue_.size();
+        done.insert(done.end(), done_queue_.begin(), done_queue_.end());
+        done_queue_.clear();
+        return n;
+    }
+
+    size_t AsyncDiskManager::GetInFlight() {
+        lock_guard<mutex> lck(latch_);
+        return queue_depth_ - free_slots_.size();
+    }
+
+    /*
+     * 读不满一页（文件末尾之外）时补0，和DiskManager::ReadPage一致；写不满一页算作I/O错误
+     */
+    AsyncDiskManager::Completion AsyncDiskManager::Finish(size_t slot, int result) {
+        lock_guard<mutex> lck(latch_);
+        const Request& request = requests_[slot];
+        Completion completion{request.tag, 0};
+        if (result < 0) {
+            completion.result = result;
+            if (request.is_read) {
+                memset(request.data, 0, PAGE_SIZE);
+            }
+        }
+        else if (request.is_read) {
+            memset(request.data + result, 0, PAGE_SIZE - result);
+        }
+        else if (result < PAGE_SIZE) {
+            completion.result = -EIO;
+        }
+        free_slots_.push_back(slot);
+        return completion;
+    }
+
+    bool AsyncDiskManager::NeedsBounce(const char* data) const {
+        return direct_io_ && reinterpret_cast<uintptr_t>(data) % DIRECT_IO_ALIGNMENT != 0;
+    }
+
+    /*
+     * 设备的逻辑块比页大等原因导致O_DIRECT请求被拒绝时，整个文件改回普通I/O
+     */
+    void AsyncDiskManager::DisableDirectIO() {
+        if (direct_io_.exchange(false)) {
+            fcntl(fd_, F_SETFL, fcntl(fd_, F_GETFL) & ~O_DIRECT);
+        }
+    }
+
+    int AsyncDiskManager::DoIO(const Request& request) {
+        if (!NeedsBounce(request.data)) {
+            int result = DoAlignedIO(request, request.data);
+            if (result != -EINVAL || !direct_io_) {
+                return result;
+            }
+            DisableDirectIO();
+            return DoAlignedIO(request, request.data);
+        }
+        alignas(DIRECT_IO_ALIGNMENT) char buffer[PAGE_SIZE];
+        if (!request.is_read) {
+            memcpy(buffer, request.data, PAGE_SIZE);
+        }
+        int result = DoAlignedIO(request, buffer);
+        if (result == -EINVAL) {
+            DisableDirectIO();
+            result = DoAlignedIO(request, buffer);
+        }
+        if (request.is_read) {
+            memcpy(request.data, buffer, PAGE_SIZE);
+        }
+        return result;
+    }
+
+    int AsyncDiskManager::DoAlignedIO(const Request& request, char* buffer) {
+        off_t offset = static_cast<off_t>(request.page_id) * PAGE_SIZE;
+        size_t transferred = 0;
+        while (transferred < PAGE_SIZE) {
+            ssize_t n = request.is_read
+                ? pread(fd_, buffer + transferred, PAGE_SIZE - transferred, offset + transferred)
+                : pwrite(fd_, buffer + transferred, PAGE_SIZE - transferred, offset + transferred);
+            if (n < 0 && errno == EINTR) {
+                continue;
+            }
+            if (n < 0) {
+                int err = errno;
+                if (request.is_read) {
+                    memset(buffer, 0, PAGE_SIZE);
+                }
+                return -err;
+            }
+            if (n == 0) {
+                break;
+            }
+            transferred += n;
+        }
+        if (request.is_read) {
+            memset(buffer + transferred, 0, PAGE_SIZE - transferred);
+        }
+        return static_cast<int>(transferred);
+    }
+
+    // 成功时返回0，否则为-errno
+    int AsyncDiskManager::WriteContiguous(page_id_t first_page_id, const char* data, size_t num_pages) {
+        off_t offset = static_cast<off_t>(first_page_id) * PAGE_SIZE;
+        size_t size = num_pages * PAGE_SIZE;
+        size_t transferred = 0;
+        while (transferred < size) {
+            ssize_t n = pwrite(fd_, data + transferred, size - transferred, offset + transferred);
+            if (n < 0 && errno == EINTR) {
+                continue;
+            }
+            if (n < 0) {
+                return -errno;
+            }
+            transferred += n;
+        }
+        return 0;
+    }
+
+    void AsyncDiskManager::WorkerLoop() {
+        unique_lock<mutex> lck(latch_);
+        while (true) {
+            work_cv_.wait(lck, [&] { return stop_ || !work_queue_.empty(); });
+            if (stop_) {
+                return;
+            }
+            size_t slot = work_queue_.front();
+            work_queue_.pop_front();
+            Request request = requests_[slot];
+            lck.unlock();
+            Completion completion = Finish(slot, DoIO(request));
+            lck.lock();
+            done_queue_.push_back(completion);
+            done_cv_.notify_all();
+        }
+    }
+
+    /*
+     * 按io_uring的约定映射提交环、完成环和SQE数组。内核不支持或被seccomp禁止时返回false
+     */
+    bool AsyncDiskManager::SetupRing() {
+        io_uring_params params;
+        memset(&params, 0, sizeof(params));
+        ring_fd_ = static_cast<int>(syscall(__NR_io_uring_setup, static_cast<unsigned>(queue_depth_), &params));
+        if (ring_fd_ < 0) {
+            ring_fd_ = -1;
+            return false;
+        }
+        sq_ring_size_ = params.sq_off.array + params.sq_entries * sizeof(unsigned);
+        cq_ring_size_ = params.cq_off.cqes + params.cq_entries * sizeof(io_uring_cqe);
+        bool single_mmap = (params.features & IORING_FEAT_SINGLE_MMAP) != 0;
+        if (single_mmap) {
+            sq_ring_size_ = cq_ring_size_ = std::max(sq_ring_size_, cq_ring_size_);
+        }
+        sq_ring_ = mmap(nullptr, sq_ring_size_, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE,
+            ring_fd_, IORING_OFF_SQ_RING);
+        if (sq_ring_ == MAP_FAILED) {
+            sq_ring_ = nullptr;
+            TeardownRing();
+            return false;
+        }
+        cq_ring_ = single_mmap ? sq_ring_ : mmap(nullptr, cq_ring_size_, PROT_READ | PROT_WRITE,
+            MAP_SHARED | MAP_POPULATE, ring_fd_, IORING_OFF_CQ_RING);
+        if (cq_ring_ == MAP_FAILED) {
+            cq_ring_ = nullptr;
+            TeardownRing();
+            return false;
+        }
+        sqes_size_ = params.sq_entries * sizeof(io_uring_sqe);
+        sqes_ = mmap(nullptr, sqes_size_, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE,
+            ring_fd_, IORING_OFF_SQES);
+        if (sqes_ == MAP_FAILED) {
+            sqes_ = nullptr;
+            TeardownRing();
+            return false;
+        }
+        char* sq = static_cast<char*>(sq_ring_);
+        char* cq = static_cast<char*>(cq_ring_);
+        sq_tail_ = reinterpret_cast<unsigned*>(sq + params.sq_off.tail);
+        sq_mask_ = reinterpret_cast<unsigned*>(sq + params.sq_off.ring_mask);
+        sq_array_ = reinterpret_cast<unsigned*>(sq + params.sq_off.array);
+        cq_head_ = reinterpret_cast<unsigned*>(cq + params.cq_off.head);
+        cq_tail_ = reinterpret_cast<unsigned*>(cq + params.cq_off.tail);
+        cq_mask_ = reinterpret_cast<unsigned*>(cq + params.cq_off.ring_mask);
+        cqes_ = cq + params.cq_off.cqes;
+        return true;
+    }
+
+    void AsyncDiskManager::TeardownRing() {
+        if (sqes_ != nullptr) {
+            munmap(sqes_, sqes_size_);
+        }
+        if (cq_ring_ != nullptr && cq_ring_ != sq_ring_) {
+            munmap(cq_ring_, cq_ring_size_);
+        }
+        if (sq_ring_ != nullptr) {
+            munmap(sq_ring_, sq_ring_size_);
+        }
+        if (ring_fd_ >= 0) {
+            close(ring_fd_);
+        }
+        sqes_ = sq_ring_ = cq_ring_ = nullptr;
+        ring_fd_ = -1;
+    }
+
+    /*
+     * 在途请求不超过queue_depth，而提交环至少有queue_depth项，所以环不会满
+     */
+    void AsyncDiskManager::SubmitRing() {
+        lock_guard<mutex> lck(latch_);
+        if (queued_.empty()) {
+            return;
+        }
+        io_uring_sqe* sqes = static_cast<io_uring_sqe*>(sqes_);
+        unsigned tail = *sq_tail_;
+        for (size_t slot : queued_) {
+            Request& request = requests_[slot];
+            unsigned idx = tail & *sq_mask_;
+            io_uring_sqe* sqe = &sqes[idx];
+            memset(sqe, 0, sizeof(*sqe));
+            sqe->opcode = request.is_read ? IORING_OP_READ : IORING_OP_WRITE;
+            sqe->fd = fd_;
+            sqe->off = static_cast<uint64_t>(request.page_id) * PAGE_SIZE;
+            char* buffer = request.data;
+            request.bounced = NeedsBounce(buffer);
+            if (request.bounced) {
+                buffer = bounce_ + slot * PAGE_SIZE;
+                if (!request.is_read) {
+                    memcpy(buffer, request.data, PAGE_SIZE);
+                }
+            }
+            sqe->addr = reinterpret_cast<uint64_t>(buffer);
+            sqe->len = PAGE_SIZE;
+            sqe->user_data = slot;
+            sq_array_[idx] = idx;
+            tail++;
+        }
+        __atomic_store_n(sq_tail_, tail, __ATOMIC_RELEASE);
+        unsigned to_submit = static_cast<unsigned>(queued_.size());
+        queued_.clear();
+        while (to_submit > 0) {
+            int ret = static_cast<int>(syscall(__NR_io_uring_enter, ring_fd_, to_submit, 0, 0, nullptr, 0));
+            if (ret < 0 && errno != EINTR && errno != EAGAIN && errno != EBUSY) {
+                throw Exception("io_uring_enter failed: " + std::string(strerror(errno)));
+            }
+            if (ret > 0) {
+                to_submit -= static_cast<unsigned>(ret);
+            }
+        }
+    }
+
+    size_t AsyncDiskManager::CompleteRing(std::vector<Completion>& done, size_t min_complete) {
+        io_uring_cqe* cqes = static_cast<io_uring_cqe*>(cqes_);
+        size_t n = 0;
+        while (true) {
+            unsigned head = *cq_head_;
+            unsigned tail = __atomic_load_n(cq_tail_, __ATOMIC_ACQUIRE);
+            while (head != tail) {
+                io_uring_cqe* cqe = &cqes[head & *cq_mask_];
+                size_t slot = static_cast<size_t>(cqe->user_data);
+                int result = cqe->res;
+                head++;
+                __atomic_store_n(cq_head_, head, __ATOMIC_RELEASE);
+                const Request& request = requests_[slot];
+                if (result == PAGE_SIZE && request.is_read && request.bounced) {
+                    memcpy(request.data, bounce_ + slot * PAGE_SIZE, PAGE_SIZE);
+                }
+                // 读写不满一页或O_DIRECT被拒绝时同步重做一遍，读到文件末尾的情况由DoIO补0
+                if ((result >= 0 && result < PAGE_SIZE) || result == -EINVAL) {
+                    result = DoIO(request);
+                }
+                done.push_back(Finish(slot, result));
+                n++;
+            }
+            if (n >= min_complete) {
+                return n;
+            }
+            int ret = static_cast<int>(syscall(__NR_io_uring_enter, ring_fd_, 0,
+                static_cast<unsigned>(min_complete - n), IORING_ENTER_GETEVENTS, nullptr, 0));
+            if (ret < 0 && errno != EINTR) {
+                throw Exception("io_uring_enter failed: " + std::string(strerror(errno)));
+            }
+        }
+    }
+}
@@ -0,0 +1,134 @@
+#pragma once
+#include <atomic>
+#include <condition_variable>
+#include <cstdint>
+#include <deque>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+#include "disk/disk_manager.h"
+using namespace std;
+
+namespace scudb {
+
+    class BufferPoolManager;
+
+    /*
+     * 可以同时挂起多个页面读写的磁盘管理器。优先用io_uring（直接走系统调用，不依赖liburing），
+     * 内核不支持或被禁止时退回到pread/pwrite线程池，两种后端对外的行为相同。
+     * 页面文件由这里另外打开的fd读写，基类只负责分配page_id和日志。基类的ReadPage/WritePage
+     * 不是虚函数，经DiskManager*调用会绕过这里走fstream，和O_DIRECT的读写不一致，
+     * 所以私有继承：只有BufferPoolManager能把它当作DiskManager用（它的页面I/O都先分派到这里），
+     * 其余基类接口按需重新公开。
+     * 提交/完成接口只给一个线程用：Complete取出的是所有已完成的请求，不区分是谁提交的。
+     * direct_io时用O_DIRECT绕过内核页缓存，页面只在缓冲池里存一份；调用者的缓冲区
+     * 没有按DIRECT_IO_ALIGNMENT对齐时经过对齐的中转缓冲区复制一次。
+     * 文件系统不支持O_DIRECT时退回普通I/O
+     */
+    class AsyncDiskManager : private DiskManager {
+        friend class BufferPoolManager;
+
+    public:
+        enum class Backend { IO_URING = 0, THREAD_POOL };
+
+        static const size_t DIRECT_IO_ALIGNMENT = 4096;
+
+        struct Completion {
+            uint64_t tag;   // 提交时传入的标识
+            int result;     // 0表示成功，否则为-errno；读到文件末尾之外的部分填0，不算错误
+        };
+
+        // queue_depth是同时在途的最大请求数
+        AsyncDiskManager(const std::string& db_file, size_t queue_depth = 64, bool use_io_uring = true,
+            bool direct_io = false);
+
+        ~AsyncDiskManager();
+
+        using DiskManager::AllocatePage;
+        using DiskManager::DeallocatePage;
+        using DiskManager::GetNumFlushes;
+        using DiskManager::WriteLog;
+        using DiskManager::ReadLog;
+
+        // 同步读写，直接pread/pwrite，可以和异步请求并发；隐藏了基类基于fstream的版本
+        void WritePage(page_id_t page_id, const char* page_data);
+        void ReadPage(page_id_t page_id, char* page_data);
+
+        // 同步写出page_id从first_page_id开始连续的num_pages页，一次pwrite；
+        // direct_io时data没有对齐就逐页经中转缓冲区写
+        void WritePages(page_id_t first_page_id, const char* data, size_t num_pages);
+
+        // 把请求放进提交队列，在途请求已达queue_depth时返回false。调用Submit后才真正发出
+        bool SubmitRead(page_id_t page_id, char* page_data, uint64_t tag);
+        bool SubmitWrite(page_id_t page_id, const char* page_data, uint64_t tag);
+
+        // 一次系统调用把排队的请求都交给内核（或线程池）
+        void Submit();
+
+        // 等到至少min_complete个请求完成，把已完成的请求全部追加到done，返回追加的个数
+        size_t Complete(std::vector<Completion>& done, size_t min_complete);
+
+        Backend GetBackend() const { return backend_; }
+        size_t GetQueueDepth() const { return queue_depth_; }
+        size_t GetInFlight();
+        bool IsDirectIO() const { return direct_io_; }
+
+    private:
+        // 一个在途请求，下标作为io_uring的user_data
+        struct Request {
+            uint64_t tag;
+            page_id_t page_id;
+            char* data;
+            bool is_read;
+            bool bounced;   // io_uring请求经过了中转缓冲区
+        };
+
+        bool Enqueue(page_id_t page_id, char* data, bool is_read, uint64_t tag);
+        Completion Finish(size_t slot, int result);
+        bool SetupRing();
+        void TeardownRing();
+        void SubmitRing();
+        size_t CompleteRing(std::vector<Completion>& done, size_t min_complete);
+        void WorkerLoop();
+        int DoIO(const Request& request);
+        int DoAlignedIO(const Request& request, char* buffer);
+        int WriteContiguous(page_id_t first_page_id, const char* data, size_t num_pages);
+        bool NeedsBounce(const char* data) const;
+        void DisableDirectIO();
+
+        int fd_;
+        std::atomic<bool> direct_io_;
+        char* bounce_;                   // 每个请求槽一页的对齐中转缓冲区，只在direct_io时分配
+        Backend backend_;
+        size_t queue_depth_;
+        std::vector<Request> requests_;
+        std::vector<size_t> free_slots_;
+        std::vector<size_t> queued_;     // 已排队还没有Submit的请求
+        std::mutex latch_;               // 保护以上请求的记录
+
+        // io_uring的共享内存环
+        int ring_fd_;
+        void* sq_ring_;
+        void* cq_ring_;
+        size_t sq_ring_size_;
+        size_t cq_ring_size_;
+        void* sqes_;
+        size_t sqes_size_;
+        unsigned* sq_tail_;
+        unsigned* sq_mask_;
+        unsigned* sq_array_;
+        unsigned* cq_head_;
+        unsigned* cq_tail_;
+        unsigned* cq_mask_;
+        void* cqes_;
+
+        // 线程池后端
+        std::vector<std::thread> workers_;
+        std::deque<size_t> work_queue_;
+        std::deque<Completion> done_queue_;
+        std::condition_variable work_cv_;
+        std::condition_variable done_cv_;
+        bool stop_;
+    };
+}
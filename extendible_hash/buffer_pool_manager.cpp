@@ -1,26 +1,92 @@
+#include <algorithm>
+#include <cstdlib>
+#include <limits>
+#include <vector>
+
 #include "buffer/buffer_pool_manager.h"
 
 namespace scudb {
     BufferPoolManager::BufferPoolManager(size_t pool_size,
         DiskManager* disk_manager,
-        LogManager* log_manager)
-        : pool_size_(pool_size), disk_manager_(disk_manager),
-        log_manager_(log_manager) { 
-        pages_ = new Page[pool_size_];
-        page_table_ = new ExtendibleHash<page_id_t, Page*>(BUCKET_SIZE);
-        replacer_ = new LRUReplacer<Page*>;
-        free_list_ = new std::list<Page*>;    // 用于缓冲池的连续内存空间
-
+        LogManager* log_manager, size_t num_instances,
+        ReplacerType replacer_type, ArenaType arena_type, NumaPolicy numa_policy)
+        : pool_size_(pool_size), disk_manager_(disk_manager), async_disk_manager_(nullptr),
+        log_manager_(log_manager), replacer_type_(replacer_type), flusher_stop_(false),
+        dirty_ratio_target_(1.0), flusher_interval_(10), prefetch_stop_(false) {
+        // 分片数不能超过页数，否则会出现没有帧的分片
+        num_instances_ = num_instances == 0 ? 1 : num_instances;
+        if (num_instances_ > pool_size_ && pool_size_ > 0) {
+            num_instances_ = pool_size_;
+        }
+        // 余数均匀地分给前面的分片
+        std::vector<size_t> instance_sizes;
+        for (size_t i = 0; i < num_instances_; ++i) {
+            instance_sizes.push_back(pool_size_ / num_instances_ + (i < pool_size_ % num_instances_ ? 1 : 0));
+        }
+        arena_ = new FrameArena(pool_size_, arena_type, numa_policy, instance_sizes);
+        pages_ = arena_->GetFrames();    // 用于缓冲池的连续内存空间
+        pin_counts_ = new std::atomic<int>[pool_size_];
+        frame_page_ids_ = new std::atomic<page_id_t>[pool_size_];
+        io_pending_ = new std::atomic<bool>[pool_size_];
         for (size_t i = 0; i < pool_size_; ++i) {
-            free_list_->push_back(&pages_[i]);   // 把所有的页面放入空闲列表
+            pin_counts_[i] = 0;
+            frame_page_ids_[i] = INVALID_PAGE_ID;
+            io_pending_[i] = false;
+        }
+        instances_ = new Instance[num_instances_];
+
+        size_t start = 0;
+        for (size_t i = 0; i < num_instances_; ++i) {
+            Instance& inst = instances_[i];
+            inst.pool_size = instance_sizes[i];
+            inst.pages = pages_ + start;
+            inst.page_table = new ExtendibleHash<page_id_t, Page*>(BUCKET_SIZE);
+            inst.fast_table = new OptimisticPageTable(inst.pool_size);
+            inst.replacer = MakeReplacer(&inst);
+            inst.free_list = new std::list<Page*>;
+            inst.write_back = new std::multiset<page_id_t>;
+            inst.hit_count.store(0);
+            inst.miss_count = 0;
+            inst.dirty_evictions = 0;
+            inst.flush_hand = 0;
+            for (size_t j = 0; j < inst.pool_size; ++j) {
+                inst.free_list->push_back(&inst.pages[j]);   // 把所有的页面放入空闲列表
+            }
+            start += inst.pool_size;
         }
     }
 
+    BufferPoolManager::BufferPoolManager(size_t pool_size,
+        AsyncDiskManager* disk_manager,
+        LogManager* log_manager, size_t num_instances,
+        ReplacerType replacer_type, ArenaType arena_type, NumaPolicy numa_policy)
+        : BufferPoolManager(pool_size, static_cast<DiskManager*>(disk_manager), log_manager,
+            num_instances, replacer_type, arena_type, numa_policy) {
+        async_disk_manager_ = disk_manager;
+    }
+
     BufferPoolManager::~BufferPoolManager() {
-        delete[] pages_;
-        delete page_table_;
-        delete replacer_;
-        delete free_list_;
+        StopFlusher();
+        {
+            lock_guard<mutex> lck(prefetch_latch_);
+            prefetch_stop_ = true;
+        }
+        prefetch_cv_.notify_all();
+        if (prefetcher_.joinable()) {
+            prefetcher_.join();
+        }
+        for (size_t i = 0; i < num_instances_; ++i) {
+            delete instances_[i].page_table;
+            delete instances_[i].fast_table;
+            delete instances_[i].replacer;
+            delete instances_[i].free_list;
+            delete instances_[i].write_back;
+        }
+        delete[] instances_;
+        delete[] pin_counts_;
+        delete[] frame_page_ids_;
+        delete[] io_pending_;
+        delete arena_;
     }
 
     /**
@@ -30,53 +96,290 @@ namespace scudb {
      * 2. 如果选择替换的条目是脏的，则将其写回磁盘
      * 3. 从散列表中删除旧页面的条目，并为新页面插入条目
      * 4.更新页面元数据，从磁盘文件读取页面内容并返回页面指针
+     * 只锁page_id所在的分片，其他分片上的请求不受影响
+     * 命中时先走无锁路径：查fast_table，原子地钉住帧，再核对帧里确实是这一页
      */
     Page* BufferPoolManager::FetchPage(page_id_t page_id) {
-        lock_guard<mutex> lck(latch_);
-        
+        return FetchPage(page_id, true);
+    }
+
+    // count_access为false时不计入命中率，给预读用
+    Page* BufferPoolManager::FetchPage(page_id_t page_id, bool count_access) {
+        Instance* inst = GetInstance(page_id);
+        size_t frame_id = 0;
+        if (inst->fast_table->Find(page_id, frame_id) && TryPin(frame_id)) {
+            if (frame_page_ids_[frame_id] == page_id && !io_pending_[frame_id]) {
+                if (count_access) {
+                    inst->hit_count.fetch_add(1, std::memory_order_relaxed);
+                }
+                return &pages_[frame_id];
+            }
+            // 表中的映射已过时或页面还在读入，退回加锁路径
+            ReleasePin(inst, frame_id);
+        }
+        unique_lock<mutex> lck(inst->latch);
+
         Page* tar = nullptr;
-        if (page_table_->Find(page_id, tar)) { //1.1
-            tar->pin_count_++;
-            replacer_->Erase(tar);
-            return tar;
+        while (true) {
+            if (inst->page_table->Find(page_id, tar)) { //1.1
+                if (count_access) {
+                    inst->hit_count++;
+                }
+                pin_counts_[FrameId(tar)]++;
+                inst->replacer->Erase(tar);
+                // 别的线程正在把该页读入这个帧，等它读完而不是重复读一次
+                inst->io_cv.wait(lck, [&] { return !io_pending_[FrameId(tar)]; });
+                return tar;
+            }
+            if (inst->write_back->count(page_id) == 0) break;
+            // 该页正作为牺牲页写回，磁盘上还是旧内容，等写完再读
+            inst->io_cv.wait(lck);
         }
         //1.2
-        tar = GetVictimPage();
+        if (count_access) {
+            inst->miss_count++;
+        }
+        page_id_t victim_id;
+        bool victim_dirty;
+        tar = BeginRead(inst, page_id, victim_id, victim_dirty);
         if (tar == nullptr) return tar;
-        //2
-        if (tar->is_dirty_) {
-            disk_manager_->WritePage(tar->GetPageId(), tar->data_);
+        //2,4 磁盘I/O期间释放分片latch，命中其他页的请求不必等待
+        lck.unlock();
+        {
+            lock_guard<mutex> disk_lck(disk_latch_);
+            if (victim_dirty) {
+                DiskWrite(victim_id, tar->data_);
+            }
+            DiskRead(page_id, tar->data_);
         }
+        lck.lock();
+        FinishRead(inst, FrameId(tar), victim_id, victim_dirty);
+
+        return tar;
+    }
+
+    /*
+     * 持有分片latch。为page_id找一个牺牲帧，先建立新映射并钉住帧、标记I/O进行中，
+     * I/O期间该帧不会被别人替换，别的线程来取这一页会等FinishRead。
+     * 牺牲页是脏页时记进write_back，调用者必须先把它写回再读入page_id
+     */
+    Page* BufferPoolManager::BeginRead(Instance* inst, page_id_t page_id, page_id_t& victim_id, bool& victim_dirty) {
+        Page* tar = GetVictimPage(inst);
+        if (tar == nullptr) return tar;
+        size_t frame_id = FrameId(tar);
+        victim_id = tar->GetPageId();
+        victim_dirty = tar->is_dirty_;
         //3
-        page_table_->Remove(tar->GetPageId());
-        page_table_->Insert(page_id, tar);
-        //4
-        disk_manager_->ReadPage(page_id, tar->data_);
-        tar->pin_count_ = 1;
-        tar->is_dirty_ = false;
+        inst->page_table->Remove(victim_id);
+        inst->fast_table->Remove(victim_id);
+        inst->page_table->Insert(page_id, tar);
         tar->page_id_ = page_id;
-
+        tar->is_dirty_ = false;
+        io_pending_[frame_id] = true;
+        frame_page_ids_[frame_id] = page_id;
+        inst->fast_table->Insert(page_id, frame_id);
+        pin_counts_[frame_id] = 1;
+        if (victim_dirty) {
+            inst->dirty_evictions++;
+            inst->write_back->insert(victim_id);
+        }
         return tar;
     }
 
+    // 持有分片latch，帧里的页面已经读入
+    void BufferPoolManager::FinishRead(Instance* inst, size_t frame_id, page_id_t victim_id, bool victim_dirty) {
+        if (victim_dirty) {
+            inst->write_back->erase(inst->write_back->find(victim_id));
+        }
+        io_pending_[frame_id] = false;
+        inst->io_cv.notify_all();
+    }
+
+    // 持有disk_latch_
+    void BufferPoolManager::DiskRead(page_id_t page_id, char* data) {
+        if (async_disk_manager_ != nullptr) {
+            async_disk_manager_->ReadPage(page_id, data);
+        } else {
+            disk_manager_->ReadPage(page_id, data);
+        }
+    }
+
+    // 持有disk_latch_
+    void BufferPoolManager::DiskWrite(page_id_t page_id, const char* data) {
+        if (async_disk_manager_ != nullptr) {
+            async_disk_manager_->WritePage(page_id, data);
+        } else {
+            disk_manager_->WritePage(page_id, data);
+        }
+    }
+
+    /*
+     * 队列最多pool_size项，满了就丢弃这次预读：预读只是提示，不能挤掉正在用的页
+     */
+    bool BufferPoolManager::PrefetchPage(page_id_t page_id) {
+        if (IsResident(page_id)) {
+            return true;
+        }
+        lock_guard<mutex> lck(prefetch_latch_);
+        if (!prefetcher_.joinable()) {
+            prefetcher_ = std::thread(&BufferPoolManager::PrefetcherLoop, this);
+        }
+        if (prefetch_queue_.size() < pool_size_ && prefetch_pending_.insert(page_id).second) {
+            prefetch_queue_.push_back(page_id);
+            prefetch_cv_.notify_one();
+        }
+        return false;
+    }
+
+    /*
+     * 不加锁地查fast_table，结果只是提示
+     */
+    bool BufferPoolManager::IsResident(page_id_t page_id) {
+        size_t frame_id = 0;
+        return GetInstance(page_id)->fast_table->Find(page_id, frame_id) &&
+            frame_page_ids_[frame_id] == page_id && !io_pending_[frame_id];
+    }
+
+    /*
+     * 按请求顺序读入页面后立即解除钉住，页面留在替换器中等待真正的FetchPage。
+     * 已经在缓冲池里的页跳过，免得改变它在替换器中的位置。
+     * 有AsyncDiskManager时一次取出最多queue_depth个页，读请求同时在途
+     */
+    void BufferPoolManager::PrefetcherLoop() {
+        size_t batch_size = async_disk_manager_ != nullptr ? async_disk_manager_->GetQueueDepth() : 1;
+        std::vector<page_id_t> batch;
+        unique_lock<mutex> lck(prefetch_latch_);
+        while (true) {
+            prefetch_cv_.wait(lck, [&] { return prefetch_stop_ || !prefetch_queue_.empty(); });
+            if (prefetch_stop_) {
+                return;
+            }
+            batch.clear();
+            while (!prefetch_queue_.empty() && batch.size() < batch_size) {
+                batch.push_back(prefetch_queue_.front());
+                prefetch_queue_.pop_front();
+            }
+            lck.unlock();
+            if (async_disk_manager_ != nullptr) {
+                PrefetchBatch(batch);
+            } else if (!IsResident(batch[0]) && FetchPage(batch[0], false) != nullptr) {
+                UnpinPage(batch[0], false);
+            }
+            lck.lock();
+            for (page_id_t page_id : batch) {
+                prefetch_pending_.erase(page_id);
+            }
+        }
+    }
+
+    /*
+     * 逐个占用帧并提交读请求，最后一次Submit，再逐个完成。预读不计入命中率。
+     * 牺牲页是脏页时先同步写回，写回要和其他写者按disk_latch_排序。
+     * 读请求不经过disk_latch_，靠write_back排序：不在缓冲池里的页的每一次写回
+     * （牺牲页、CleanInstance）都在write_back里待到写完，这样的页不预读
+     */
+    void BufferPoolManager::PrefetchBatch(const std::vector<page_id_t>& page_ids) {
+        std::vector<Page*> frames;
+        std::vector<page_id_t> victim_ids;
+        std::vector<bool> victim_dirties;
+        for (page_id_t page_id : page_ids) {
+            Instance* inst = GetInstance(page_id);
+            unique_lock<mutex> lck(inst->latch);
+            Page* tar = nullptr;
+            // 已在缓冲池或正在写回的页不预读
+            if (inst->page_table->Find(page_id, tar) || inst->write_back->count(page_id) != 0) {
+                continue;
+            }
+            page_id_t victim_id;
+            bool victim_dirty;
+            tar = BeginRead(inst, page_id, victim_id, victim_dirty);
+            if (tar == nullptr) {
+                continue;
+            }
+            if (victim_dirty) {
+                lock_guard<mutex> disk_lck(disk_latch_);
+                lck.unlock();
+                DiskWrite(victim_id, tar->data_);
+            } else {
+                lck.unlock();
+            }
+            if (!async_disk_manager_->SubmitRead(page_id, tar->data_, frames.size())) {
+                FinishPrefetch(tar, victim_id, victim_dirty, false);
+                continue;
+            }
+            frames.push_back(tar);
+            victim_ids.push_back(victim_id);
+            victim_dirties.push_back(victim_dirty);
+        }
+        async_disk_manager_->Submit();
+
+        std::vector<AsyncDiskManager::Completion> done;
+        while (done.size() < frames.size()) {
+            size_t first = done.size();
+            async_disk_manager_->Complete(done, 1);
+            for (size_t i = first; i < done.size(); ++i) {
+                size_t idx = static_cast<size_t>(done[i].tag);
+                FinishPrefetch(frames[idx], victim_ids[idx], victim_dirties[idx], done[i].result == 0);
+            }
+        }
+    }
+
+    /*
+     * 结束一次预读并解除钉住。读失败时撤销BeginRead建立的映射，把帧还给free list；
+     * 如果别的线程已经钉住该帧在等这一页，就改为同步地再读一次
+     */
+    void BufferPoolManager::FinishPrefetch(Page* tar, page_id_t victim_id, bool victim_dirty, bool read_ok) {
+        page_id_t page_id = tar->GetPageId();
+        size_t frame_id = FrameId(tar);
+        Instance* inst = GetInstance(page_id);
+        unique_lock<mutex> lck(inst->latch);
+        if (!read_ok) {
+            int pins = 1;
+            if (pin_counts_[frame_id].compare_exchange_strong(pins, FRAME_EVICTING)) {
+                inst->page_table->Remove(page_id);
+                inst->fast_table->Remove(page_id);
+                frame_page_ids_[frame_id] = INVALID_PAGE_ID;
+                tar->page_id_ = INVALID_PAGE_ID;
+                tar->ResetMemory();
+                FinishRead(inst, frame_id, victim_id, victim_dirty);
+                pin_counts_[frame_id] = 0;
+                inst->free_list->push_back(tar);
+                return;
+            }
+            lck.unlock();
+            {
+                lock_guard<mutex> disk_lck(disk_latch_);
+                DiskRead(page_id, tar->data_);
+            }
+            lck.lock();
+        }
+        FinishRead(inst, frame_id, victim_id, victim_dirty);
+        lck.unlock();
+        UnpinPage(page_id, false);
+    }
+
     /*
      *如果引脚计数>为0，则递减它，如果它为0，则将其放回
      *如果在此调用之前引脚计数<=0，则返回false。是否dirty:设置此页面的dirty标志
      */
     bool BufferPoolManager::UnpinPage(page_id_t page_id, bool is_dirty) {
-        lock_guard<mutex> lck(latch_);
+        Instance* inst = GetInstance(page_id);
+        lock_guard<mutex> lck(inst->latch);
         Page* tar = nullptr;
-        page_table_->Find(page_id, tar);
+        inst->page_table->Find(page_id, tar);
         if (tar == nullptr) {
             return false;
         }
-        tar->is_dirty_ = is_dirty;
-        if (tar->GetPinCount() <= 0) {
+        // 其他持有者写过的页面不能因为这次未修改而变干净
+        if (is_dirty) {
+            tar->is_dirty_ = true;
+        }
+        size_t frame_id = FrameId(tar);
+        if (pin_counts_[frame_id] <= 0) {
             return false;
         }
-        ;
-        if (--tar->pin_count_ == 0) {
-            replacer_->Insert(tar);
+        if (pin_counts_[frame_id].fetch_sub(1) == 1) {
+            inst->replacer->Insert(tar);
         }
         return true;
     }
@@ -85,42 +388,170 @@ namespace scudb {
      * 用于将缓冲池的特定页刷新到磁盘。如果页表中没有找到页，是否应该调用磁盘管理器的写页方法，返回false
      */
     bool BufferPoolManager::FlushPage(page_id_t page_id) {
-        lock_guard<mutex> lck(latch_);
-       
+        Instance* inst = GetInstance(page_id);
+        unique_lock<mutex> lck(inst->latch);
+
         Page* tar = nullptr;
-        page_table_->Find(page_id, tar);
+        inst->page_table->Find(page_id, tar);
         if (tar == nullptr || tar->page_id_ == INVALID_PAGE_ID) {
             return false;
         }
+        size_t frame_id = FrameId(tar);
+        // FlushRange可能正在写出该页较早的副本，等它写完，免得覆盖这次写的新内容
+        inst->io_cv.wait(lck, [&] { return !io_pending_[frame_id] && inst->write_back->count(page_id) == 0; });
         if (tar->is_dirty_) {
-            disk_manager_->WritePage(page_id, tar->GetData());
+            lock_guard<mutex> disk_lck(disk_latch_);
+            DiskWrite(page_id, tar->GetData());
             tar->is_dirty_ = false;
         }
 
         return true;
     }
 
+    /*
+     * 1. 逐个分片加锁，只收集范围内脏页的page_id，排序
+     * 2. 每批按顺序取FLUSH_BATCH_PAGES页，一次只锁一个分片，把该分片中仍然是脏的页钉住、
+     *    复制到批缓冲区中它的位置、清掉脏标记并记进write_back，然后放开
+     * 3. 拿disk_latch_把page_id连续的一段作为一次写出，再逐个分片从write_back中去掉并解除钉住。
+     *    钉住的页不会被替换或删除；write_back里的页FlushPage和别的FlushRange会等它写完，
+     *    所以同一页的写回不会乱序。
+     *    和FlushPage一样，被钉住的页也会写出，之后的修改在UnpinPage时重新标脏
+     */
+    size_t BufferPoolManager::FlushRange(page_id_t first_page_id, page_id_t last_page_id) {
+        std::vector<page_id_t> dirty_pages;
+        for (size_t i = 0; i < num_instances_; ++i) {
+            Instance& inst = instances_[i];
+            lock_guard<mutex> lck(inst.latch);
+            for (size_t j = 0; j < inst.pool_size; ++j) {
+                Page* page = &inst.pages[j];
+                if (page->is_dirty_ && page->page_id_ >= first_page_id && page->page_id_ <= last_page_id) {
+                    dirty_pages.push_back(page->page_id_);
+                }
+            }
+        }
+        std::sort(dirty_pages.begin(), dirty_pages.end());
+
+        // 按O_DIRECT的要求对齐，整段写时不用再经过中转缓冲区
+        void* mem = nullptr;
+        if (posix_memalign(&mem, AsyncDiskManager::DIRECT_IO_ALIGNMENT, FLUSH_BATCH_PAGES * PAGE_SIZE) != 0) {
+            return 0;
+        }
+        char* buf = static_cast<char*>(mem);
+        std::vector<Page*> frames(FLUSH_BATCH_PAGES);   // 批中每一页复制自的帧，没有复制的为空
+        size_t written = 0;
+        for (size_t start = 0; start < dirty_pages.size(); start += FLUSH_BATCH_PAGES) {
+            size_t count = std::min(FLUSH_BATCH_PAGES, dirty_pages.size() - start);
+            std::fill(frames.begin(), frames.end(), nullptr);
+            for (size_t s = 0; s < num_instances_; ++s) {
+                Instance* inst = &instances_[s];
+                unique_lock<mutex> lck(inst->latch);
+                for (size_t i = 0; i < count; ++i) {
+                    page_id_t page_id = dirty_pages[start + i];
+                    if (GetInstance(page_id) != inst) {
+                        continue;
+                    }
+                    // 别人正在写出该页，等它写完，否则两次写可能乱序落盘
+                    inst->io_cv.wait(lck, [&] { return inst->write_back->count(page_id) == 0; });
+                    Page* tar = nullptr;
+                    if (!inst->page_table->Find(page_id, tar) || !tar->is_dirty_ || io_pending_[FrameId(tar)]) {
+                        continue;
+                    }
+                    size_t frame_id = FrameId(tar);
+                    // 持有分片latch时页表里的帧不会是FRAME_EVICTING
+                    TryPin(frame_id);
+                    if (pin_counts_[frame_id] == 1) {
+                        inst->replacer->Erase(tar);
+                    }
+                    memcpy(buf + i * PAGE_SIZE, tar->data_, PAGE_SIZE);
+                    tar->is_dirty_ = false;
+                    inst->write_back->insert(page_id);
+                    frames[i] = tar;
+                }
+            }
+            {
+                lock_guard<mutex> disk_lck(disk_latch_);
+                size_t run = 0;
+                for (size_t i = 1; i <= count; ++i) {
+                    if (i < count && frames[i] != nullptr && frames[i - 1] != nullptr &&
+                        dirty_pages[start + i] == dirty_pages[start + i - 1] + 1) {
+                        continue;
+                    }
+                    if (frames[run] != nullptr) {
+                        WriteRun(dirty_pages[start + run], buf + run * PAGE_SIZE, i - run);
+                        written += i - run;
+                    }
+                    run = i;
+                }
+            }
+            for (size_t s = 0; s < num_instances_; ++s) {
+                Instance* inst = &instances_[s];
+                lock_guard<mutex> lck(inst->latch);
+                bool released = false;
+                for (size_t i = 0; i < count; ++i) {
+                    if (frames[i] == nullptr || GetInstance(dirty_pages[start + i]) != inst) {
+                        continue;
+                    }
+                    inst->write_back->erase(inst->write_back->find(dirty_pages[start + i]));
+                    if (pin_counts_[FrameId(frames[i])].fetch_sub(1) == 1) {
+                        inst->replacer->Insert(frames[i]);
+                    }
+                    released = true;
+                }
+                if (released) {
+                    inst->io_cv.notify_all();
+                }
+            }
+        }
+        free(buf);
+        return written;
+    }
+
+    size_t BufferPoolManager::FlushAllPages() {
+        return FlushRange(0, std::numeric_limits<page_id_t>::max());
+    }
+
+    /*
+     * 写出page_id连续、在内存中也连续存放的一段页。调用者持有disk_latch_。
+     * 有AsyncDiskManager时整段一次pwrite；DiskManager只有单页的WritePage，按page_id顺序逐页写
+     */
+    void BufferPoolManager::WriteRun(page_id_t first_page_id, const char* data, size_t num_pages) {
+        if (async_disk_manager_ != nullptr) {
+            async_disk_manager_->WritePages(first_page_id, data, num_pages);
+            return;
+        }
+        for (size_t i = 0; i < num_pages; ++i) {
+            DiskWrite(first_page_id + static_cast<page_id_t>(i), data + i * PAGE_SIZE);
+        }
+    }
+
     /**
-     *用户应该调用此方法来删除页面。这个例程将调用磁盘管理器来释放页面。首先，如果在page 
+     *用户应该调用此方法来删除页面。这个例程将调用磁盘管理器来释放页面。首先，如果在page
      *表中发现了page，缓冲池管理器应该负责从page表中删除该条目，重置页面元数据并添加回空
      *闲列表。其次，调用磁盘管理器的DeallocatePage()方法从磁盘文件中删除。如果在页表中找
      *到，但引脚计数!= 0，返回false
      */
     bool BufferPoolManager::DeletePage(page_id_t page_id) {
-        lock_guard<mutex> lck(latch_);
-        
+        Instance* inst = GetInstance(page_id);
+        lock_guard<mutex> lck(inst->latch);
+
         Page* tar = nullptr;
-        
-        page_table_->Find(page_id, tar);
+
+        inst->page_table->Find(page_id, tar);
         if (tar != nullptr) {
-            if (tar->GetPinCount() > 0) {
+            size_t frame_id = FrameId(tar);
+            // 引脚计数不为0时CAS失败，同时挡住无锁路径上的并发钉住
+            if (!ClaimFrame(frame_id)) {
                 return false;
             }
-            replacer_->Erase(tar);
-            page_table_->Remove(page_id);
+            inst->replacer->Erase(tar);
+            inst->page_table->Remove(page_id);
+            inst->fast_table->Remove(page_id);
+            frame_page_ids_[frame_id] = INVALID_PAGE_ID;
             tar->is_dirty_ = false;
+            tar->page_id_ = INVALID_PAGE_ID;
             tar->ResetMemory();
-            free_list_->push_back(tar);
+            pin_counts_[frame_id] = 0;
+            inst->free_list->push_back(tar);
         }
         disk_manager_->DeallocatePage(page_id);
         return true;
@@ -131,46 +562,245 @@ namespace scudb {
      *来分配页面。缓冲池管理器应该负责从空闲列表或lru替换器中选择一个替
      *换页面(注意:总是首先从空闲列表中选择)，更新新页面的元数据，清空内
      *存并在页表中添加相应的条目。如果池中的所有页面都被固定，则返回nullptr
+     *分片模式下先分配page_id才能知道落在哪个分片；该分片已满时把page_id还给磁盘管理器
      */
     Page* BufferPoolManager::NewPage(page_id_t& page_id) {
-        lock_guard<mutex> lck(latch_);
+        Instance* inst = nullptr;
+        page_id_t new_page_id = INVALID_PAGE_ID;
+        if (num_instances_ > 1) {
+            new_page_id = disk_manager_->AllocatePage();
+            inst = GetInstance(new_page_id);
+        } else {
+            inst = &instances_[0];
+        }
+        unique_lock<mutex> lck(inst->latch);
         Page* tar = nullptr;
-        tar = GetVictimPage();
-        if (tar == nullptr) return tar;
-
-        page_id = disk_manager_->AllocatePage();
-        //2
-        if (tar->is_dirty_) {
-            disk_manager_->WritePage(tar->GetPageId(), tar->data_);
+        tar = GetVictimPage(inst);
+        if (tar == nullptr) {
+            if (new_page_id != INVALID_PAGE_ID) {
+                disk_manager_->DeallocatePage(new_page_id);
+            }
+            return tar;
         }
+
+        page_id = new_page_id != INVALID_PAGE_ID ? new_page_id : disk_manager_->AllocatePage();
+        size_t frame_id = FrameId(tar);
+        page_id_t victim_id = tar->GetPageId();
+        bool victim_dirty = tar->is_dirty_;
         //3
-        page_table_->Remove(tar->GetPageId());
-        page_table_->Insert(page_id, tar);
+        inst->page_table->Remove(victim_id);
+        inst->fast_table->Remove(victim_id);
+        inst->page_table->Insert(page_id, tar);
 
         //4
         tar->page_id_ = page_id;
-        tar->ResetMemory();
         tar->is_dirty_ = false;
-        tar->pin_count_ = 1;
+        frame_page_ids_[frame_id] = page_id;
+        inst->fast_table->Insert(page_id, frame_id);
+        if (!victim_dirty) {
+            tar->ResetMemory();
+            pin_counts_[frame_id] = 1;
+            return tar;
+        }
+        //2 写回期间释放分片latch，写完才能清空内存
+        inst->dirty_evictions++;
+        io_pending_[frame_id] = true;
+        pin_counts_[frame_id] = 1;
+        inst->write_back->insert(victim_id);
+        lck.unlock();
+        {
+            lock_guard<mutex> disk_lck(disk_latch_);
+            DiskWrite(victim_id, tar->data_);
+        }
+        tar->ResetMemory();
+        lck.lock();
+        inst->write_back->erase(inst->write_back->find(victim_id));
+        io_pending_[frame_id] = false;
+        inst->io_cv.notify_all();
 
         return tar;
     }
 
-    Page* BufferPoolManager::GetVictimPage() {
+    double BufferPoolManager::GetHitRatio() {
+        size_t hits = 0, total = 0;
+        for (size_t i = 0; i < num_instances_; ++i) {
+            lock_guard<mutex> lck(instances_[i].latch);
+            hits += instances_[i].hit_count.load();
+            total += instances_[i].hit_count.load() + instances_[i].miss_count;
+        }
+        return total == 0 ? 0.0 : static_cast<double>(hits) / total;
+    }
+
+    void BufferPoolManager::StartFlusher(double dirty_ratio, std::chrono::milliseconds interval) {
+        StopFlusher();
+        dirty_ratio_target_ = dirty_ratio;
+        flusher_interval_ = interval;
+        flusher_stop_ = false;
+        flusher_ = std::thread(&BufferPoolManager::FlusherLoop, this);
+    }
+
+    void BufferPoolManager::StopFlusher() {
+        if (!flusher_.joinable()) {
+            return;
+        }
+        {
+            lock_guard<mutex> lck(flusher_latch_);
+            flusher_stop_ = true;
+        }
+        flusher_cv_.notify_all();
+        flusher_.join();
+    }
+
+    double BufferPoolManager::GetDirtyRatio() {
+        size_t dirty = 0;
+        for (size_t i = 0; i < num_instances_; ++i) {
+            lock_guard<mutex> lck(instances_[i].latch);
+            for (size_t j = 0; j < instances_[i].pool_size; ++j) {
+                dirty += instances_[i].pages[j].is_dirty_ ? 1 : 0;
+            }
+        }
+        return pool_size_ == 0 ? 0.0 : static_cast<double>(dirty) / pool_size_;
+    }
+
+    size_t BufferPoolManager::GetDirtyEvictions() {
+        size_t evictions = 0;
+        for (size_t i = 0; i < num_instances_; ++i) {
+            lock_guard<mutex> lck(instances_[i].latch);
+            evictions += instances_[i].dirty_evictions;
+        }
+        return evictions;
+    }
+
+    void BufferPoolManager::FlusherLoop() {
+        unique_lock<mutex> lck(flusher_latch_);
+        while (!flusher_stop_) {
+            lck.unlock();
+            for (size_t i = 0; i < num_instances_; ++i) {
+                CleanInstance(&instances_[i]);
+            }
+            lck.lock();
+            flusher_cv_.wait_for(lck, flusher_interval_, [&] { return flusher_stop_; });
+        }
+    }
+
+    /*
+     * 从上次停下的帧继续扫描，写出未钉住的脏页，直到该分片的脏页比例不超过目标。
+     * Replacer接口不能按冷热顺序遍历，所以像时钟一样按帧下标转圈；不动替换器，
+     * 被写出的页在替换器中的位置不变。
+     * 引脚计数为0的页没有人在修改，CAS成FRAME_EVICTING挡住无锁路径的钉住，
+     * 复制一份页面并清掉脏标记后立即放开。之后的修改会在UnpinPage时重新标脏。
+     * 放开后该页可能作为干净页被替换，所以写完之前一直留在write_back里，
+     * 重新读入（包括预读）要等这次写完。期间该页还可能被改脏再作为牺牲页写回，
+     * write_back是multiset，每个写者只去掉自己的一项
+     */
+    void BufferPoolManager::CleanInstance(Instance* inst) {
+        char buf[PAGE_SIZE];
+        size_t target = static_cast<size_t>(dirty_ratio_target_ * inst->pool_size);
+        unique_lock<mutex> lck(inst->latch);
+        size_t dirty = 0;
+        for (size_t j = 0; j < inst->pool_size; ++j) {
+            dirty += inst->pages[j].is_dirty_ ? 1 : 0;
+        }
+        for (size_t scanned = 0; dirty > target && scanned < inst->pool_size; ++scanned) {
+            Page* tar = &inst->pages[inst->flush_hand];
+            inst->flush_hand = (inst->flush_hand + 1) % inst->pool_size;
+            size_t frame_id = FrameId(tar);
+            if (!tar->is_dirty_ || !ClaimFrame(frame_id)) {
+                continue;
+            }
+            page_id_t page_id = tar->page_id_;
+            memcpy(buf, tar->data_, PAGE_SIZE);
+            tar->is_dirty_ = false;
+            pin_counts_[frame_id] = 0;
+            inst->write_back->insert(page_id);
+            dirty--;
+            // 先拿disk_latch_再放开分片latch：该页之后的写回都排在这次写之后
+            unique_lock<mutex> disk_lck(disk_latch_);
+            lck.unlock();
+            DiskWrite(page_id, buf);
+            disk_lck.unlock();
+            lck.lock();
+            inst->write_back->erase(inst->write_back->find(page_id));
+            inst->io_cv.notify_all();
+        }
+    }
+
+    /*
+     * 按构造时选择的策略为分片创建替换器，三种替换器都按分片内的帧下标建数组
+     */
+    Replacer<Page*>* BufferPoolManager::MakeReplacer(Instance* inst) {
+        switch (replacer_type_) {
+        case ReplacerType::CLOCK:
+            return new ClockReplacer<Page*>(inst->pool_size, inst->pages);
+        case ReplacerType::LRU_K:
+            return new LRUKReplacer<Page*>(inst->pool_size, inst->pages);
+        case ReplacerType::LRU:
+        default:
+            return new FrameLRUReplacer<Page*>(inst->pool_size, inst->pages);
+        }
+    }
+
+    BufferPoolManager::Instance* BufferPoolManager::GetInstance(page_id_t page_id) {
+        return &instances_[static_cast<size_t>(page_id) % num_instances_];
+    }
+
+    /*
+     * 无锁路径上的钉住：引脚计数不是FRAME_EVICTING时加一
+     */
+    bool BufferPoolManager::TryPin(size_t frame_id) {
+        int pins = pin_counts_[frame_id].load();
+        while (pins != FRAME_EVICTING) {
+            if (pin_counts_[frame_id].compare_exchange_weak(pins, pins + 1)) {
+                return true;
+            }
+        }
+        return false;
+    }
+
+    /*
+     * 把引脚计数从0改成FRAME_EVICTING，成功后该帧归调用者所有，调用者必须持有分片latch
+     */
+    bool BufferPoolManager::ClaimFrame(size_t frame_id) {
+        int pins = 0;
+        return pin_counts_[frame_id].compare_exchange_strong(pins, FRAME_EVICTING);
+    }
+
+    /*
+     * 撤销一次核对失败的无锁钉住。计数回到0时该帧可能已被GetVictimPage从替换器中
+     * 取出又放弃，所以加锁放回替换器；空闲帧在free list里，不用放回
+     */
+    void BufferPoolManager::ReleasePin(Instance* inst, size_t frame_id) {
+        if (pin_counts_[frame_id].fetch_sub(1) != 1) {
+            return;
+        }
+        lock_guard<mutex> lck(inst->latch);
+        if (pin_counts_[frame_id] == 0 && frame_page_ids_[frame_id] != INVALID_PAGE_ID) {
+            inst->replacer->Insert(&pages_[frame_id]);
+        }
+    }
+
+    /*
+     * 返回的帧引脚计数为FRAME_EVICTING。无锁命中路径可能刚钉住某个候选帧，
+     * 这样的帧CAS失败：空闲帧放回free list末尾，替换器里的帧在解除钉住时会被重新放回
+     */
+    Page* BufferPoolManager::GetVictimPage(Instance* inst) {
         Page* tar = nullptr;
-        if (free_list_->empty()) {
-            if (replacer_->Size() == 0) {
-                return nullptr;
+        size_t free_frames = inst->free_list->size();
+        for (size_t i = 0; i < free_frames; ++i) {
+            tar = inst->free_list->front();
+            inst->free_list->pop_front();
+            if (ClaimFrame(FrameId(tar))) {
+                assert(tar->GetPageId() == INVALID_PAGE_ID);
+                return tar;
             }
-            replacer_->Victim(tar);
+            inst->free_list->push_back(tar);
         }
-        else {
-            tar = free_list_->front();
-            free_list_->pop_front();
-            assert(tar->GetPageId() == INVALID_PAGE_ID);
+        while (inst->replacer->Victim(tar)) {
+            if (ClaimFrame(FrameId(tar))) {
+                return tar;
+            }
         }
-        assert(tar->GetPinCount() == 0);
-        return tar;
+        return nullptr;
     }
 
 }
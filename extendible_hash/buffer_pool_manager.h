@@ -1,44 +1,149 @@
 #pragma once
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <deque>
 #include <list>
 #include <mutex>
+#include <set>
+#include <thread>
+#include <vector>
+#include "buffer/clock_replacer.h"
+#include "buffer/frame_arena.h"
+#include "buffer/lru_k_replacer.h"
 #include "buffer/lru_replacer.h"
+#include "buffer/optimistic_page_table.h"
+#include "disk/async_disk_manager.h"
 #include "disk/disk_manager.h"
 #include "hash/extendible_hash.h"
 #include "logging/log_manager.h"
 #include "page/page.h"
 
 namespace scudb {
+    // 构造缓冲池时选择的页面置换策略，LRU_K能抵抗索引扫描对热点页的冲刷
+    enum class ReplacerType { LRU = 0, CLOCK, LRU_K };
+
     class BufferPoolManager {
     public:
+        // num_instances > 1 时按 page_id 把缓冲池切分成多个互不相干的分片
         BufferPoolManager(size_t pool_size, DiskManager* disk_manager,
-            LogManager* log_manager = nullptr);
+            LogManager* log_manager = nullptr, size_t num_instances = 1,
+            ReplacerType replacer_type = ReplacerType::LRU, ArenaType arena_type = ArenaType::HEAP,
+            NumaPolicy numa_policy = NumaPolicy::NONE);
+
+        // 页面读写都经过AsyncDiskManager，预读一次最多并发发出queue_depth个读请求。
+        // 它的提交/完成接口归预读线程独占，别处不能再用
+        BufferPoolManager(size_t pool_size, AsyncDiskManager* disk_manager,
+            LogManager* log_manager = nullptr, size_t num_instances = 1,
+            ReplacerType replacer_type = ReplacerType::LRU, ArenaType arena_type = ArenaType::HEAP,
+            NumaPolicy numa_policy = NumaPolicy::NONE);
 
         ~BufferPoolManager();
 
         Page* FetchPage(page_id_t page_id);
 
+        // 页面已在缓冲池中时返回true；否则交给后台线程异步读入（不钉住）并返回false
+        bool PrefetchPage(page_id_t page_id);
+
         bool UnpinPage(page_id_t page_id, bool is_dirty);
 
         bool FlushPage(page_id_t page_id);
 
+        // 把[first_page_id, last_page_id]中的脏页按page_id顺序成批写出，返回写出的页数
+        size_t FlushRange(page_id_t first_page_id, page_id_t last_page_id);
+
+        size_t FlushAllPages();
+
         Page* NewPage(page_id_t& page_id);
 
         bool DeletePage(page_id_t page_id);
 
+        size_t GetNumInstances() const { return num_instances_; }
+
+        // NumaPolicy::PARTITION时分片的帧所在的NUMA节点，调用者可以把访问该分片的线程绑到这个节点上
+        int GetInstanceNode(size_t instance) const { return arena_->GetNode(instance); }
+
+        // FetchPage命中缓冲池的比例，用于比较不同的置换策略
+        double GetHitRatio();
+
+        // 启动后台刷脏线程：每隔interval把各分片的脏页比例写到dirty_ratio以下，
+        // 让替换时尽量拿到干净的帧。已启动时按新参数重启
+        void StartFlusher(double dirty_ratio,
+            std::chrono::milliseconds interval = std::chrono::milliseconds(10));
+
+        void StopFlusher();
+
+        // 当前脏页占整个缓冲池的比例
+        double GetDirtyRatio();
+
+        // 替换脏页时在前台同步写回的次数
+        size_t GetDirtyEvictions();
+
     private:
+        static const int FRAME_EVICTING = -1;
+        static const size_t FLUSH_BATCH_PAGES = 64; // FlushRange每批复制的页数
+
+        // 一个分片拥有自己的帧、页表、替换器和空闲列表，只由自己的latch保护
+        struct Instance {
+            size_t pool_size;   // 该分片的页数
+            Page* pages;        // 指向pages_中属于该分片的一段
+            HashTable<page_id_t, Page*>* page_table; // 跟踪页面
+            OptimisticPageTable* fast_table; // page_table的无锁副本，只给命中路径用
+            Replacer<Page*>* replacer;   // 查找要替换的未固定页
+            std::list<Page*>* free_list; // 找到一个空闲的页面进行替换
+            std::multiset<page_id_t>* write_back; // 正在写回磁盘的页面：牺牲页、CleanInstance写出的页，或被FlushRange钉住写出的页
+            std::atomic<size_t> hit_count; // FetchPage命中次数
+            size_t miss_count;           // FetchPage未命中次数
+            size_t dirty_evictions;      // 牺牲页是脏页的次数
+            size_t flush_hand;           // 后台刷脏线程下次从这一帧开始扫描
+            std::mutex latch;            // 保护该分片的共享数据结构
+            std::condition_variable io_cv; // 帧上的I/O完成时唤醒等待者
+        };
+
         size_t pool_size_; // 缓冲池中的页数
-        Page* pages_;      // 页面数组
+        FrameArena* arena_; // 帧数组所在的内存
+        Page* pages_;      // 页面数组，各分片连续地占用其中一段
         DiskManager* disk_manager_;
+        AsyncDiskManager* async_disk_manager_; // 不为空时页面I/O都走它
         LogManager* log_manager_;
-        HashTable<page_id_t, Page*>* page_table_; // 跟踪页面
-        Replacer<Page*>* replacer_;   // 查找要替换的未固定页
-        std::list<Page*>* free_list_; // 找到一个空闲的页面进行替换
-        std::mutex latch_;             // 保护共享数据结构
-        Page* GetVictimPage();
+        size_t num_instances_;  // 分片数
+        ReplacerType replacer_type_;
+        Instance* instances_;   // 分片数组
+        // 以下按帧下标索引，无锁命中路径会读取，所以都是原子的，由所在分片的latch串行化写入
+        std::atomic<int>* pin_counts_;        // 引脚计数，FRAME_EVICTING表示正在被替换或删除
+        std::atomic<page_id_t>* frame_page_ids_; // 帧中当前的页面，命中路径钉住后用来核对
+        std::atomic<bool>* io_pending_;       // I/O是否在进行
+        std::mutex disk_latch_; // DiskManager基于fstream，不能被多个分片同时读写；也保证同一页的写回按顺序落盘
+        std::thread flusher_;   // 后台刷脏线程，没有启动时不可join
+        std::mutex flusher_latch_;
+        std::condition_variable flusher_cv_;
+        bool flusher_stop_;
+        double dirty_ratio_target_;
+        std::chrono::milliseconds flusher_interval_;
+        std::thread prefetcher_; // 预读线程，第一次PrefetchPage时启动
+        std::mutex prefetch_latch_;
+        std::condition_variable prefetch_cv_;
+        std::deque<page_id_t> prefetch_queue_;
+        std::set<page_id_t> prefetch_pending_; // 已排队或正在读入的页，避免重复预读
+        bool prefetch_stop_;
+        Instance* GetInstance(page_id_t page_id);
+        Page* FetchPage(page_id_t page_id, bool count_access);
+        size_t FrameId(Page* page) const { return static_cast<size_t>(page - pages_); }
+        bool TryPin(size_t frame_id);
+        bool ClaimFrame(size_t frame_id);
+        void ReleasePin(Instance* inst, size_t frame_id);
+        Page* GetVictimPage(Instance* inst);
+        Replacer<Page*>* MakeReplacer(Instance* inst);
+        void FlusherLoop();
+        bool IsResident(page_id_t page_id);
+        void PrefetcherLoop();
+        void PrefetchBatch(const std::vector<page_id_t>& page_ids);
+        void FinishPrefetch(Page* tar, page_id_t victim_id, bool victim_dirty, bool read_ok);
+        Page* BeginRead(Instance* inst, page_id_t page_id, page_id_t& victim_id, bool& victim_dirty);
+        void FinishRead(Instance* inst, size_t frame_id, page_id_t victim_id, bool victim_dirty);
+        void DiskRead(page_id_t page_id, char* data);
+        void DiskWrite(page_id_t page_id, const char* data);
+        void WriteRun(page_id_t first_page_id, const char* data, size_t num_pages);
+        void CleanInstance(Instance* inst);
     };
-} 
-Footer
-© 2022 GitHub, Inc.
-Footer navigation
-Terms
-Privacy
+}
@@ -0,0 +1,83 @@
+#include <cassert>
+
+#include "buffer/clock_replacer.h"
+#include "page/page.h"
+
+namespace scudb {
+
+    template <typename T> ClockReplacer<T>::ClockReplacer(size_t num_frames, T base)
+        : num_frames(num_frames), base(base), hand(0), size(0) {
+        in_replacer = new bool[num_frames]();
+        ref = new bool[num_frames]();
+    }
+
+    template <typename T> ClockReplacer<T>::~ClockReplacer() {
+        delete[] in_replacer;
+        delete[] ref;
+    }
+
+    /*
+     * 把帧放入时钟并置引用位，已经在时钟里的帧只置引用位
+     */
+    template <typename T> void ClockReplacer<T>::Insert(const T& value) {
+        lock_guard<mutex> lck(latch);
+        size_t idx = FrameId(value);
+        assert(idx < num_frames);
+        if (!in_replacer[idx]) {
+            in_replacer[idx] = true;
+            size++;
+        }
+        ref[idx] = true;
+    }
+
+    /*
+     * 转动时钟指针，引用位为1的帧获得第二次机会，第一个引用位为0的帧被选中并返回true。
+     * 时钟为空返回false。最多转两圈：第一圈清掉所有引用位
+     */
+    template <typename T> bool ClockReplacer<T>::Victim(T& value) {
+        lock_guard<mutex> lck(latch);
+        if (size == 0) {
+            return false;
+        }
+        while (true) {
+            size_t idx = hand;
+            hand = (hand + 1) % num_frames;
+            if (!in_replacer[idx]) {
+                continue;
+            }
+            if (ref[idx]) {
+                ref[idx] = false;
+                continue;
+            }
+            in_replacer[idx] = false;
+            size--;
+            value = base + idx;
+            return true;
+        }
+    }
+
+    /*
+     * 从时钟中删除值。如果移除成功，返回true，否则返回false
+     */
+    template <typename T> bool ClockReplacer<T>::Erase(const T& value) {
+        lock_guard<mutex> lck(latch);
+        size_t idx = FrameId(value);
+        if (idx >= num_frames || !in_replacer[idx]) {
+            return false;
+        }
+        in_replacer[idx] = false;
+        ref[idx] = false;
+        size--;
+        return true;
+    }
+
+    template <typename T> size_t ClockReplacer<T>::Size() {
+        lock_guard<mutex> lck(latch);
+        return size;
+    }
+
+    template class ClockReplacer<Page*>;
+
+    template class ClockReplacer<int>;
+
+}
@@ -0,0 +1,38 @@
+#pragma once
+#include <mutex>
+#include "buffer/replacer.h"
+using namespace std;
+
+namespace scudb {
+
+    /*
+     * 时钟置换：按帧下标（value - base）定位一个固定数组，每帧一个引用位。
+     * Insert只是置位，不分配内存；Victim转动时钟指针，清掉遇到的引用位，
+     * 选中第一个引用位为0的帧
+     */
+    template <typename T> class ClockReplacer : public Replacer<T> {
+    public:
+        ClockReplacer(size_t num_frames, T base = T());
+
+        ~ClockReplacer();
+
+        void Insert(const T& value);
+
+        bool Victim(T& value);
+
+        bool Erase(const T& value);
+
+        size_t Size();
+
+    private:
+        size_t FrameId(const T& value) const { return static_cast<size_t>(value - base); }
+        size_t num_frames;
+        T base;                 // 下标为0的帧
+        bool* in_replacer;      // 该帧当前是否可被替换
+        bool* ref;              // 引用位
+        size_t hand;            // 时钟指针
+        size_t size;
+        mutable mutex latch;
+    };
+
+}
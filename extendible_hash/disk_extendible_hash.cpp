@@ -0,0 +1,299 @@
+#include "common/exception.h"
+#include "common/rid.h"
+#include "hash/disk_extendible_hash.h"
+#include "page/header_page.h"
+
+namespace scudb {
+
+    namespace {
+        /*
+         * FetchIndexPage/NewIndexPage在缓冲池满时抛异常，table_latch_和已钉住的页
+         * 都交给下面的对象，离开作用域时放开，异常路径上也不会一直占着
+         */
+        class TableReadLock {
+        public:
+            explicit TableReadLock(RWMutex& latch) : latch_(latch) { latch_.RLock(); }
+            ~TableReadLock() { latch_.RUnlock(); }
+        private:
+            RWMutex& latch_;
+        };
+
+        class TableWriteLock {
+        public:
+            explicit TableWriteLock(RWMutex& latch) : latch_(latch) { latch_.WLock(); }
+            ~TableWriteLock() { latch_.WUnlock(); }
+        private:
+            RWMutex& latch_;
+        };
+
+        // 已经钉住的页，析构时按是否改过解除钉住
+        class PagePin {
+        public:
+            PagePin(BufferPoolManager* buffer_pool_manager, page_id_t page_id)
+                : buffer_pool_manager_(buffer_pool_manager), page_id_(page_id), dirty_(false) {}
+            ~PagePin() { buffer_pool_manager_->UnpinPage(page_id_, dirty_); }
+            void SetDirty() { dirty_ = true; }
+        private:
+            BufferPoolManager* buffer_pool_manager_;
+            page_id_t page_id_;
+            bool dirty_;
+        };
+    }
+
+    /*
+     * 在头页中按名字查找目录页，找不到说明索引还是空的，第一次插入时再创建
+     */
+    template <typename K, typename V>
+    DiskExtendibleHash<K, V>::DiskExtendibleHash(const std::string& name, BufferPoolManager* buffer_pool_manager)
+        : index_name_(name), directory_page_id_(INVALID_PAGE_ID), buffer_pool_manager_(buffer_pool_manager) {
+        HeaderPage* header_page = static_cast<HeaderPage*>(FetchIndexPage(HEADER_PAGE_ID));
+        if (!header_page->GetRootId(index_name_, directory_page_id_)) {
+            directory_page_id_ = INVALID_PAGE_ID;
+        }
+        buffer_pool_manager_->UnpinPage(HEADER_PAGE_ID, false);
+    }
+
+    template <typename K, typename V>
+    Page* DiskExtendibleHash<K, V>::FetchIndexPage(page_id_t page_id) {
+        Page* page = buffer_pool_manager_->FetchPage(page_id);
+        if (page == nullptr) {
+            throw Exception(EXCEPTION_TYPE_INDEX, "all pages are pinned while fetching hash index page");
+        }
+        return page;
+    }
+
+    template <typename K, typename V>
+    Page* DiskExtendibleHash<K, V>::NewIndexPage(page_id_t& page_id) {
+        Page* page = buffer_pool_manager_->NewPage(page_id);
+        if (page == nullptr) {
+            throw Exception(EXCEPTION_TYPE_INDEX, "out of memory while allocating hash index page");
+        }
+        return page;
+    }
+
+    /*
+     * 目录页只在table_latch_的写锁下修改，读锁下直接读；桶页加页的读latch
+     */
+    template <typename K, typename V>
+    bool DiskExtendibleHash<K, V>::GetValue(const K& key, V& value) {
+        TableReadLock lock(table_latch_);
+        if (directory_page_id_ == INVALID_PAGE_ID) {
+            return false;
+        }
+        HashDirectoryPage* dir = reinterpret_cast<HashDirectoryPage*>(FetchIndexPage(directory_page_id_)->GetData());
+        page_id_t bucket_page_id = dir->GetBucketPageId(HashKey(key) & dir->GetGlobalDepthMask());
+        buffer_pool_manager_->UnpinPage(directory_page_id_, false);
+
+        Page* page = FetchIndexPage(bucket_page_id);
+        page->RLatch();
+        bool found = reinterpret_cast<BucketPage*>(page->GetData())->Lookup(key, value);
+        page->RUnlatch();
+        buffer_pool_manager_->UnpinPage(bucket_page_id, false);
+        return found;
+    }
+
+    /*
+     * 先在读锁下直接插入桶页，桶满或者索引还没有目录时换成写锁去分裂
+     */
+    template <typename K, typename V>
+    bool DiskExtendibleHash<K, V>::Insert(const K& key, const V& value) {
+        InsertResult result;
+        {
+            TableReadLock lock(table_latch_);
+            result = TryInsert(key, value);
+        }
+        if (result != InsertResult::NEED_SPLIT) {
+            return result == InsertResult::INSERTED;
+        }
+        TableWriteLock lock(table_latch_);
+        return SplitInsert(key, value);
+    }
+
+    template <typename K, typename V>
+    typename DiskExtendibleHash<K, V>::InsertResult DiskExtendibleHash<K, V>::TryInsert(const K& key, const V& value) {
+        if (directory_page_id_ == INVALID_PAGE_ID) {
+            return InsertResult::NEED_SPLIT;
+        }
+        HashDirectoryPage* dir = reinterpret_cast<HashDirectoryPage*>(FetchIndexPage(directory_page_id_)->GetData());
+        page_id_t bucket_page_id = dir->GetBucketPageId(HashKey(key) & dir->GetGlobalDepthMask());
+        buffer_pool_manager_->UnpinPage(directory_page_id_, false);
+
+        Page* page = FetchIndexPage(bucket_page_id);
+        BucketPage* bucket = reinterpret_cast<BucketPage*>(page->GetData());
+        InsertResult result = InsertResult::INSERTED;
+        page->WLatch();
+        if (!bucket->Insert(key, value)) {
+            V old_value;
+            result = bucket->Lookup(key, old_value) ? InsertResult::DUPLICATE : InsertResult::NEED_SPLIT;
+        }
+        page->WUnlatch();
+        buffer_pool_manager_->UnpinPage(bucket_page_id, result == InsertResult::INSERTED);
+        return result;
+    }
+
+    /*
+     * 持有写锁，其他线程都不会访问索引的页。桶满就分裂，局部深度等于全局深度时
+     * 先把目录加倍，直到键能放进桶里；目录已满且桶仍放不下时返回false
+     */
+    template <typename K, typename V>
+    bool DiskExtendibleHash<K, V>::SplitInsert(const K& key, const V& value) {
+        if (directory_page_id_ == INVALID_PAGE_ID) {
+            CreateDirectory();
+        }
+        HashDirectoryPage* dir = reinterpret_cast<HashDirectoryPage*>(FetchIndexPage(directory_page_id_)->GetData());
+        PagePin dir_pin(buffer_pool_manager_, directory_page_id_);
+        size_t hash = HashKey(key);
+        while (true) {
+            size_t idx = hash & dir->GetGlobalDepthMask();
+            page_id_t bucket_page_id = dir->GetBucketPageId(idx);
+            BucketPage* bucket = reinterpret_cast<BucketPage*>(FetchIndexPage(bucket_page_id)->GetData());
+            PagePin bucket_pin(buffer_pool_manager_, bucket_page_id);
+            V old_value;
+            if (!bucket->IsFull() || bucket->Lookup(key, old_value)) {
+                bool inserted = bucket->Insert(key, value);
+                if (inserted) {
+                    bucket_pin.SetDirty();
+                }
+                return inserted;
+            }
+            int depth = dir->GetLocalDepth(idx);
+            if (depth == dir->GetGlobalDepth()) {
+                if (!dir->CanGrow()) {
+                    return false;
+                }
+                // 加倍后的目录本身是完整的，下面分配新桶页失败也不用撤销
+                dir->IncrGlobalDepth();
+                dir_pin.SetDirty();
+            }
+            page_id_t image_page_id;
+            BucketPage* image = reinterpret_cast<BucketPage*>(NewIndexPage(image_page_id)->GetData());
+            PagePin image_pin(buffer_pool_manager_, image_page_id);
+            image->Init();
+            size_t bit = static_cast<size_t>(1) << depth;
+            bucket->MoveSplitImageTo(image, bit);
+            dir->SetBucket(idx & ~bit, depth + 1, bucket_page_id);
+            dir->SetBucket(idx | bit, depth + 1, image_page_id);
+            dir_pin.SetDirty();
+            bucket_pin.SetDirty();
+            image_pin.SetDirty();
+        }
+    }
+
+    /*
+     * 新建目录页和第一个桶页，并把目录页的page_id记到头页里。
+     * 头页先钉住，新页建好之后就不会再因为取不到头页而失败
+     */
+    template <typename K, typename V>
+    void DiskExtendibleHash<K, V>::CreateDirectory() {
+        HeaderPage* header_page = static_cast<HeaderPage*>(FetchIndexPage(HEADER_PAGE_ID));
+        PagePin header_pin(buffer_pool_manager_, HEADER_PAGE_ID);
+        page_id_t bucket_page_id;
+        reinterpret_cast<BucketPage*>(NewIndexPage(bucket_page_id)->GetData())->Init();
+        PagePin bucket_pin(buffer_pool_manager_, bucket_page_id);
+        bucket_pin.SetDirty();
+        page_id_t dir_page_id;
+        HashDirectoryPage* dir = reinterpret_cast<HashDirectoryPage*>(NewIndexPage(dir_page_id)->GetData());
+        PagePin dir_pin(buffer_pool_manager_, dir_page_id);
+        dir_pin.SetDirty();
+        dir->Init(dir_page_id, bucket_page_id);
+
+        header_page->InsertRecord(index_name_, dir_page_id);
+        header_pin.SetDirty();
+        directory_page_id_ = dir_page_id;
+    }
+
+    /*
+     * 删除后桶空了就换成写锁去和伙伴桶合并
+     */
+    template <typename K, typename V>
+    bool DiskExtendibleHash<K, V>::Remove(const K& key) {
+        bool removed, empty;
+        int depth;
+        {
+            TableReadLock lock(table_latch_);
+            if (directory_page_id_ == INVALID_PAGE_ID) {
+                return false;
+            }
+            HashDirectoryPage* dir = reinterpret_cast<HashDirectoryPage*>(FetchIndexPage(directory_page_id_)->GetData());
+            size_t idx = HashKey(key) & dir->GetGlobalDepthMask();
+            page_id_t bucket_page_id = dir->GetBucketPageId(idx);
+            depth = dir->GetLocalDepth(idx);
+            buffer_pool_manager_->UnpinPage(directory_page_id_, false);
+
+            Page* page = FetchIndexPage(bucket_page_id);
+            BucketPage* bucket = reinterpret_cast<BucketPage*>(page->GetData());
+            page->WLatch();
+            removed = bucket->Remove(key);
+            empty = bucket->GetSize() == 0;
+            page->WUnlatch();
+            buffer_pool_manager_->UnpinPage(bucket_page_id, removed);
+        }
+
+        if (removed && empty && depth > 0) {
+            TableWriteLock lock(table_latch_);
+            Merge(key);
+        }
+        return removed;
+    }
+
+    /*
+     * 持有写锁。键所在的桶和它的伙伴桶局部深度相同且其中一个为空时，
+     * 保留另一个、删除空桶页，并继续向上合并；最后尽量把目录减半。
+     * 后台刷盘或预取可能暂时钉着空桶页，这时删不掉，就先不合并，
+     * 空桶留在目录里仍然是对的，下次删除时再试
+     */
+    template <typename K, typename V>
+    void DiskExtendibleHash<K, V>::Merge(const K& key) {
+        HashDirectoryPage* dir = reinterpret_cast<HashDirectoryPage*>(FetchIndexPage(directory_page_id_)->GetData());
+        PagePin dir_pin(buffer_pool_manager_, directory_page_id_);
+        size_t hash = HashKey(key);
+        while (true) {
+            size_t idx = hash & dir->GetGlobalDepthMask();
+            int depth = dir->GetLocalDepth(idx);
+            if (depth == 0) {
+                break;
+            }
+            size_t buddy_idx = idx ^ (static_cast<size_t>(1) << (depth - 1));
+            if (dir->GetLocalDepth(buddy_idx) != depth) {
+                break;
+            }
+            page_id_t keep = dir->GetBucketPageId(buddy_idx);
+            page_id_t drop = dir->GetBucketPageId(idx);
+            BucketPage* bucket = reinterpret_cast<BucketPage*>(FetchIndexPage(drop)->GetData());
+            int size = bucket->GetSize();
+            buffer_pool_manager_->UnpinPage(drop, false);
+            if (size != 0) {
+                BucketPage* buddy = reinterpret_cast<BucketPage*>(FetchIndexPage(keep)->GetData());
+                int buddy_size = buddy->GetSize();
+                buffer_pool_manager_->UnpinPage(keep, false);
+                if (buddy_size != 0) {
+                    break;
+                }
+                std::swap(keep, drop);
+            }
+            if (!buffer_pool_manager_->DeletePage(drop)) {
+                break;
+            }
+            dir->SetBucket(idx, depth - 1, keep);
+            dir_pin.SetDirty();
+        }
+        while (dir->CanShrink()) {
+            dir->DecrGlobalDepth();
+            dir_pin.SetDirty();
+        }
+    }
+
+    template <typename K, typename V>
+    int DiskExtendibleHash<K, V>::GetGlobalDepth() {
+        TableReadLock lock(table_latch_);
+        int depth = 0;
+        if (directory_page_id_ != INVALID_PAGE_ID) {
+            depth = reinterpret_cast<HashDirectoryPage*>(FetchIndexPage(directory_page_id_)->GetData())->GetGlobalDepth();
+            buffer_pool_manager_->UnpinPage(directory_page_id_, false);
+        }
+        return depth;
+    }
+
+    template class DiskExtendibleHash<int, int>;
+    template class DiskExtendibleHash<int, RID>;
+}
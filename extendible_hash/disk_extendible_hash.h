@@ -0,0 +1,49 @@
+#pragma once
+#include <string>
+#include "buffer/buffer_pool_manager.h"
+#include "common/rwmutex.h"
+#include "hash/hash_page.h"
+using namespace std;
+
+namespace scudb {
+
+    /*
+     * 页面都在缓冲池里的可扩展哈希索引，只支持唯一键。目录页的page_id像B+树的根一样
+     * 以index_name记在头页（page 0）里，用同一个名字重新构造就能找回已有的索引。
+     * 一次查找只访问目录页和一个桶页。
+     * table_latch_的读锁下可以修改桶页（加页的写latch），分裂、合并和修改目录需要写锁
+     */
+    template <typename K, typename V> class DiskExtendibleHash {
+    public:
+        DiskExtendibleHash(const std::string& name, BufferPoolManager* buffer_pool_manager);
+
+        bool GetValue(const K& key, V& value);
+
+        // 键已存在，或桶满且目录已经到一页能放下的最大深度时返回false
+        bool Insert(const K& key, const V& value);
+
+        bool Remove(const K& key);
+
+        int GetGlobalDepth();
+
+        page_id_t GetDirectoryPageId() const { return directory_page_id_; }
+
+    private:
+        typedef HashBucketPage<K, V> BucketPage;
+        enum class InsertResult { INSERTED = 0, DUPLICATE, NEED_SPLIT };
+
+        size_t HashKey(const K& key) const { return hash<K>{}(key); }
+        Page* FetchIndexPage(page_id_t page_id);
+        Page* NewIndexPage(page_id_t& page_id);
+        InsertResult TryInsert(const K& key, const V& value);
+        bool SplitInsert(const K& key, const V& value);
+        void Merge(const K& key);
+        void CreateDirectory();
+
+        std::string index_name_;
+        page_id_t directory_page_id_;
+        BufferPoolManager* buffer_pool_manager_;
+        RWMutex table_latch_;
+    };
+
+}
@@ -1,20 +1,70 @@
+#include <cassert>
 #include <list>
 #include "hash/extendible_hash.h"
 #include "page/page.h"
+#if defined(__AVX2__)
+#include <immintrin.h>
+#elif defined(__SSE2__) || defined(_M_X64)
+#include <emmintrin.h>
+#endif
+#if defined(_MSC_VER)
+#include <intrin.h>
+#endif
 using namespace std;
 
 namespace scudb {
+    /*
+     * 编译期选择指纹比较的宽度：AVX2一次32个，SSE2一次16个，否则逐字节比较16个。
+     * 返回的位图中第i位为1表示tags[i] == tag
+     */
+#if defined(__AVX2__)
+    static const size_t TAG_GROUP = 32;
+    static inline uint32_t MatchTagGroup(const uint8_t* tags, uint8_t tag) {
+        __m256i group = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(tags));
+        __m256i eq = _mm256_cmpeq_epi8(group, _mm256_set1_epi8(static_cast<char>(tag)));
+        return static_cast<uint32_t>(_mm256_movemask_epi8(eq));
+    }
+#elif defined(__SSE2__) || defined(_M_X64)
+    static const size_t TAG_GROUP = 16;
+    static inline uint32_t MatchTagGroup(const uint8_t* tags, uint8_t tag) {
+        __m128i group = _mm_loadu_si128(reinterpret_cast<const __m128i*>(tags));
+        __m128i eq = _mm_cmpeq_epi8(group, _mm_set1_epi8(static_cast<char>(tag)));
+        return static_cast<uint32_t>(_mm_movemask_epi8(eq));
+    }
+#else
+    static const size_t TAG_GROUP = 16;
+    static inline uint32_t MatchTagGroup(const uint8_t* tags, uint8_t tag) {
+        uint32_t mask = 0;
+        for (size_t i = 0; i < TAG_GROUP; i++) {
+            mask |= static_cast<uint32_t>(tags[i] == tag) << i;
+        }
+        return mask;
+    }
+#endif
+
+    static inline int LowestBit(uint32_t mask) {
+#if defined(_MSC_VER)
+        unsigned long idx;
+        _BitScanForward(&idx, mask);
+        return static_cast<int>(idx);
+#else
+        return __builtin_ctz(mask);
+#endif
+    }
+
      template <typename K, typename V>
      ExtendibleHash<K, V>::ExtendibleHash(size_t size) {
-     global_depth = 0;
      bucket_size = size;
-     bucket_number = 1;
-     buckets.push_back(make_shared<Bucket>(0));
+     bucket_num = 1;
+     bucket_pool.emplace_back(new Bucket(0, 0, bucket_size));
+     directories.emplace_back(new Directory(0));
+     directories.back()->slots[0] = bucket_pool.back().get();
+     directory = directories.back().get();
      }
     
     template<typename K, typename V>
-    ExtendibleHash<K, V>::ExtendibleHash() {
-    ExtendibleHash(64);   //固定每个桶的数组大小
+    ExtendibleHash<K, V>::ExtendibleHash() : ExtendibleHash(64) {
+    //固定每个桶的数组大小
     }
 
     template <typename K, typename V>
@@ -22,97 +72,339 @@ namespace scudb {
         return hash<K>{}(key);     //帮助函数计算输入键的哈希地址
     }
 
+    /*
+     * 目录下标用哈希值的低位，指纹取乘法散列后的最高字节，两者互不相关；
+     * std::hash<int>是恒等函数，直接取高位对小整数全是0
+     */
     template <typename K, typename V>
-    int ExtendibleHash<K, V>::GetGlobalDepth() const {
-        lock_guard<mutex> lock(latch);
-        return global_depth;   //返回哈希表全局深度
+    uint8_t ExtendibleHash<K, V>::Fingerprint(size_t hash) {
+        return static_cast<uint8_t>((static_cast<uint64_t>(hash) * 0x9E3779B97F4A7C15ULL) >> 56);
+    }
+
+    /*
+     * 在桶的前size个槽里找键，返回槽号，找不到返回-1。调用者持有桶的latch。
+     * 每次比较一组指纹，只对位图中置位的槽比较完整的键；最后一组屏蔽掉size之后的槽
+     */
+    template <typename K, typename V>
+    int ExtendibleHash<K, V>::FindSlot(const Bucket& bucket, const K& key, uint8_t tag) const {
+        static_assert(TAG_GROUP <= TAG_GROUP_MAX, "tag array padding is too small");
+        for (size_t base = 0; base < bucket.size; base += TAG_GROUP) {
+            uint32_t mask = MatchTagGroup(&bucket.tags[base], tag);
+            if (bucket.size - base < TAG_GROUP) {
+                mask &= (1u << (bucket.size - base)) - 1;
+            }
+            while (mask != 0) {
+                size_t i = base + LowestBit(mask);
+                if (bucket.keys[i] == key) {
+                    return static_cast<int>(i);
+                }
+                mask &= mask - 1;
+            }
+        }
+        return -1;
+    }
+
+    /*
+     * 持有桶的latch时判断哈希值是否仍归这个桶管：读者取到目录后桶可能已被分裂
+     */
+    template <typename K, typename V>
+    bool ExtendibleHash<K, V>::Owns(const Bucket& bucket, size_t hash) {
+        return (hash & ((static_cast<size_t>(1) << bucket.local_depth) - 1)) == bucket.pattern;
+    }
+
+    /*
+     * 从当前发布的目录找到哈希值所在的桶并加读latch或写latch。
+     * 加锁前桶可能被分裂，加锁后核对不再归它管就重新读目录
+     */
+    template <typename K, typename V>
+    typename ExtendibleHash<K, V>::Bucket*
+    ExtendibleHash<K, V>::LatchBucket(size_t hash, bool exclusive) const {
+        while (true) {
+            Directory* dir = directory.load();
+            Bucket* cur = dir->slots[hash & ((static_cast<size_t>(1) << dir->global_depth) - 1)].load();
+            if (exclusive) {
+                cur->latch.WLock();
+            }
+            else {
+                cur->latch.RLock();
+            }
+            if (Owns(*cur, hash)) {
+                return cur;
+            }
+            if (exclusive) {
+                cur->latch.WUnlock();
+            }
+            else {
+                cur->latch.RUnlock();
+            }
+        }
     }
 
     template <typename K, typename V>
     int ExtendibleHash<K, V>::GetGlobalDepth() const {
-    lock_guard<mutex> lock(latch_table);
-        return global_depth;   //返回该桶的局部深度
+        return directory.load()->global_depth;   //返回哈希表全局深度
+    }
+
+    template <typename K, typename V>
+    int ExtendibleHash<K, V>::GetLocalDepth(int bucket_id) const {
+        Directory* dir = directory.load();
+        if (bucket_id < 0 || bucket_id >= (1 << dir->global_depth)) {
+            return -1;
+        }
+        Bucket& cur = *dir->slots[bucket_id].load();
+        cur.latch.RLock();
+        int depth = cur.size == 0 ? -1 : cur.local_depth;   //返回该桶的局部深度
+        cur.latch.RUnlock();
+        return depth;
     }
 
     template <typename K, typename V>
     int ExtendibleHash<K, V>::GetNumBuckets() const {
-        lock_guard<mutex> lock(latch);
-        return bucketNum;      //返回哈希表中桶的当前编号
+        return bucket_num.load();      //返回哈希表中桶的当前编号
     }
 
     template <typename K, typename V>
     bool ExtendibleHash<K, V>::Find(const K& key, V& value) {
-
-        int idx = getIdx(key);
-        lock_guard<mutex> lck(buckets[idx]->latch);
-        if (buckets[idx]->kmap.find(key) != buckets[idx]->kmap.end()) {
-            value = buckets[idx]->kmap[key];       //查找与输入键相关的值
-            return true;
-
+        size_t hash = HashKey(key);
+        Bucket* cur = LatchBucket(hash, false);
+        int slot = FindSlot(*cur, key, Fingerprint(hash));
+        if (slot != -1) {
+            value = cur->values[slot];       //查找与输入键相关的值
         }
-        return false;
+        cur->latch.RUnlock();
+        return slot != -1;
     }
 
     template <typename K, typename V>
     int ExtendibleHash<K, V>::getIdx(const K& key) const {
-        lock_guard<mutex> lck(latch);
-        return HashKey(key) & ((1 << global_depth) - 1);
+        return HashKey(key) & ((1 << directory.load()->global_depth) - 1);
     }
 
+    /*
+     * 删除后桶的条目不超过四分之一时尝试和伙伴桶合并
+     */
     template <typename K, typename V>   
     bool ExtendibleHash<K, V>::Remove(const K& key) {
-        int idx = getIdx(key);
-        lock_guard<mutex> lck(buckets[idx]->latch);
-        shared_ptr<Bucket> cur = buckets[idx];
-        if (cur->kmap.find(key) == cur->kmap.end()) {
+        size_t hash = HashKey(key);
+        Bucket* cur = LatchBucket(hash, true);
+        int slot = FindSlot(*cur, key, Fingerprint(hash));
+        if (slot == -1) {
+            cur->latch.WUnlock();
             return false; 
         }
-        cur->kmap.erase(key);      //删除哈希表中<key,value>的条目
+        //删除哈希表中<key,value>的条目，用最后一个槽填补空位
+        size_t last = cur->size - 1;
+        if (static_cast<size_t>(slot) != last) {
+            cur->tags[slot] = cur->tags[last];
+            cur->keys[slot] = cur->keys[last];
+            cur->values[slot] = cur->values[last];
+        }
+        cur->size--;
+        bool underflow = cur->local_depth > 0 && cur->size <= bucket_size / 4;
+        cur->latch.WUnlock();
+        if (underflow) {
+            Merge(hash);
+        }
         return true;
     }
 
+    /*
+     * 只锁住要插入的桶；桶满时放开它，按latch、桶的写latch的顺序重新加锁后分裂。
+     * 读者不受影响
+     */
     template <typename K, typename V>
     void ExtendibleHash<K, V>::Insert(const K& key, const V& value) {
-        int idx = getIdx(key);
-        shared_ptr<Bucket> cur = buckets[idx];
+        size_t hash = HashKey(key);
+        uint8_t tag = Fingerprint(hash);
         while (true) {
-            lock_guard<mutex> lck(cur->latch);
-            if (cur->kmap.find(key) != cur->kmap.end() || cur->kmap.size() < bucket_size) {
-                cur->kmap[key] = value;
-                break;
+            Bucket* cur = LatchBucket(hash, true);
+            int slot = FindSlot(*cur, key, tag);
+            if (slot != -1) {
+                cur->values[slot] = value;
+                cur->latch.WUnlock();
+                return;
+            }
+            if (cur->size < bucket_size) {
+                cur->tags[cur->size] = tag;
+                cur->keys[cur->size] = key;
+                cur->values[cur->size] = value;
+                cur->size++;
+                cur->latch.WUnlock();
+                return;
             }
-            int mask = (1 << (cur->local_depth));
-            cur->local_depth++;
+            cur->latch.WUnlock();
 
-            {
-                lock_guard<mutex> lck2(latch);
-                if (cur->local_depth > global_depth) {
+            lock_guard<mutex> lck(latch);
+            cur = LatchBucket(hash, true);
+            if (cur->size == bucket_size) {
+                Split(cur);
+            }
+            cur->latch.WUnlock();   //重新查找目录，在哈希表中插入<key,value>条目
+        }
+    }
 
-                    size_t length = buckets.size();
-                    for (size_t i = 0; i < length; i++) {
-                        buckets.push_back(buckets[i]);
-                    }
-                    global_depth++;
+    /*
+     * 深度为depth的目录数组，第一次用到时分配。调用者持有latch
+     */
+    template <typename K, typename V>
+    typename ExtendibleHash<K, V>::Directory* ExtendibleHash<K, V>::GetDirectory(int depth) {
+        assert(static_cast<size_t>(depth) <= directories.size());
+        if (static_cast<size_t>(depth) == directories.size()) {
+            directories.emplace_back(new Directory(depth));
+        }
+        return directories[depth].get();
+    }
 
+    /*
+     * 取一个空桶，优先复用合并掉的桶。返回时已加写latch：
+     * 拿着旧指针的读者可能正在等这个桶的latch
+     */
+    template <typename K, typename V>
+    typename ExtendibleHash<K, V>::Bucket* ExtendibleHash<K, V>::NewBucket(int depth, size_t pattern) {
+        Bucket* buc;
+        if (!free_buckets.empty()) {
+            buc = free_buckets.back();
+            free_buckets.pop_back();
+        }
+        else {
+            bucket_pool.emplace_back(new Bucket(0, 0, bucket_size));
+            buc = bucket_pool.back().get();
+        }
+        buc->latch.WLock();
+        buc->local_depth = depth;
+        buc->pattern = pattern;
+        buc->size = 0;
+        return buc;
+    }
+
+    /*
+     * 调用者持有latch和cur的写latch。需要时先发布加倍的目录，
+     * 再把新增位为1的条目移到新桶，原地改写指向新桶的目录槽
+     */
+    template <typename K, typename V>
+    void ExtendibleHash<K, V>::Split(Bucket* cur) {
+        Directory* dir = directory.load();
+        size_t mask = static_cast<size_t>(1) << cur->local_depth;
+        if (cur->local_depth + 1 > dir->global_depth) {
+
+            size_t length = static_cast<size_t>(1) << dir->global_depth;
+            Directory* next = GetDirectory(dir->global_depth + 1);
+            for (size_t i = 0; i < length; i++) {
+                next->slots[i] = dir->slots[i].load();
+                next->slots[i + length] = dir->slots[i].load();
+            }
+            directory = next;
+            dir = next;
+
+        }
+        //当有溢出时，拆分并重新分配桶，如有必要增加全局深度
+        Bucket* newBuc = NewBucket(cur->local_depth + 1, cur->pattern | mask);
+        cur->local_depth++;
+
+        //对数组做一趟划分：新增位为1的条目移到新桶，其余在原桶中前移
+        size_t keep = 0;
+        for (size_t i = 0; i < cur->size; i++) {
+            if (HashKey(cur->keys[i]) & mask) {
+                newBuc->tags[newBuc->size] = cur->tags[i];
+                newBuc->keys[newBuc->size] = cur->keys[i];
+                newBuc->values[newBuc->size] = cur->values[i];
+                newBuc->size++;
+            }
+            else {
+                if (keep != i) {
+                    cur->tags[keep] = cur->tags[i];
+                    cur->keys[keep] = cur->keys[i];
+                    cur->values[keep] = cur->values[i];
                 }
-                bucket_num++;       //当有溢出时，拆分并重新分配桶，如有必要增加全局深度
-                auto newBuc = make_shared<Bucket>(cur->local_depth);
-
-                typename map<K, V>::iterator it;
-                for (it = cur->kmap.begin(); it != cur->kmap.end(); ) {
-                    if (HashKey(it->first) & mask) {
-                        newBuc->kmap[it->first] = it->second;
-                        it = cur->kmap.erase(it);
-                    }
-                    else it++;
-                }
-                for (size_t i = 0; i < buckets.size(); i++) {
-                    if (buckets[i] == cur && (i & mask))
-                        buckets[i] = newBuc;
+                keep++;
+            }
+        }
+        cur->size = keep;
+        size_t length = static_cast<size_t>(1) << dir->global_depth;
+        for (size_t i = cur->pattern | mask; i < length; i += mask << 1) {
+            dir->slots[i] = newBuc;
+        }
+        bucket_num++;
+        newBuc->latch.WUnlock();
+    }
+
+    /*
+     * 把hash所在的桶和它的伙伴桶（最高的局部位相反）合并，只要两者局部深度相同
+     * 且合起来不超过半个桶，留一半空间避免马上又分裂；合并后的桶继续向上合并。
+     * 局部深度只在持有latch时修改，所以持有latch时可以直接读伙伴桶的深度
+     */
+    template <typename K, typename V>
+    void ExtendibleHash<K, V>::Merge(size_t hash) {
+        lock_guard<mutex> lck(latch);
+        bool merged = false;
+        while (true) {
+            Bucket* cur = LatchBucket(hash, true);
+            if (cur->local_depth == 0) {
+                cur->latch.WUnlock();
+                break;
+            }
+            size_t bit = static_cast<size_t>(1) << (cur->local_depth - 1);
+            Directory* dir = directory.load();
+            Bucket* buddy = dir->slots[cur->pattern ^ bit].load();
+            if (buddy->local_depth != cur->local_depth) {
+                cur->latch.WUnlock();
+                break;
+            }
+            buddy->latch.WLock();
+            if (cur->size + buddy->size > bucket_size / 2) {
+                buddy->latch.WUnlock();
+                cur->latch.WUnlock();
+                break;
+            }
+
+            Bucket* low = (cur->pattern & bit) ? buddy : cur;
+            Bucket* high = (cur->pattern & bit) ? cur : buddy;
+            for (size_t i = 0; i < high->size; i++) {
+                low->tags[low->size] = high->tags[i];
+                low->keys[low->size] = high->keys[i];
+                low->values[low->size] = high->values[i];
+                low->size++;
+            }
+            low->local_depth--;
+            size_t length = static_cast<size_t>(1) << dir->global_depth;
+            for (size_t i = high->pattern; i < length; i += bit << 1) {
+                dir->slots[i] = low;
+            }
+            //废弃的桶不再拥有任何哈希值，拿着旧指针的读者核对后会重新读目录
+            high->local_depth = 0;
+            high->pattern = ~static_cast<size_t>(0);
+            high->size = 0;
+            free_buckets.push_back(high);
+            bucket_num--;
+            buddy->latch.WUnlock();
+            cur->latch.WUnlock();
+            merged = true;
+        }
+        if (merged) {
+            ShrinkDirectory();
+        }
+    }
+
+    /*
+     * 没有桶用到最高位时（上下两半目录完全相同）把目录减半，发布较小的数组。
+     * 调用者持有latch
+     */
+    template <typename K, typename V>
+    void ExtendibleHash<K, V>::ShrinkDirectory() {
+        Directory* dir = directory.load();
+        while (dir->global_depth > 0) {
+            size_t half = static_cast<size_t>(1) << (dir->global_depth - 1);
+            for (size_t i = 0; i < half; i++) {
+                if (dir->slots[i].load() != dir->slots[i + half].load()) {
+                    return;
                 }
             }
-            idx = getIdx(key);
-            cur = buckets[idx];   //在哈希表中插入<key,value>条目
+            Directory* prev = GetDirectory(dir->global_depth - 1);
+            for (size_t i = 0; i < half; i++) {
+                prev->slots[i] = dir->slots[i].load();
+            }
+            directory = prev;
+            dir = prev;
         }
     }
 
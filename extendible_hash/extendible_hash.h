@@ -1,11 +1,13 @@
 #pragma once
 
+#include <atomic>
+#include <cstdint>
 #include <cstdlib>
 #include <vector>
 #include <string>
-#include <map>
 #include <memory>
 #include <mutex>
+#include "common/rwmutex.h"
 #include "hash/hash_table.h"
 using namespace std;
 
@@ -15,11 +17,30 @@ namespace scudb {
 
 template <typename K, typename V>
 class ExtendibleHash : public HashTable<K, V> {
+  // ͰǶ飺ǰsizeЧֵָƷֱţ
+  // һαȽһ1ָֽƣSSE2/AVX2ָͬűȽļ
+  // ָTAG_GROUP_MAXֽڣһȡԽ
+  static const size_t TAG_GROUP_MAX = 32;
+  // Ͱlocal_depthλpatternйϣֵֻͬʱlatch
+  // Ͱдlatchʱ޸ġϲͰpatternΪȫ1ӵκιϣֵ
   struct Bucket {
-    Bucket(int depth) : local_depth(depth) {};
+    Bucket(int depth, size_t pattern, size_t capacity)
+        : local_depth(depth), pattern(pattern), size(0), tags(capacity + TAG_GROUP_MAX), keys(capacity), values(capacity) {};
     int local_depth;
-    map<K, V> key_map;
-    mutex latch;
+    size_t pattern;
+    size_t size;
+    vector<uint8_t> tags;
+    vector<K> keys;
+    vector<V> values;
+    RWMutex latch;
+  };
+  // Ŀ¼Ͱָԭ飬Ѻͺϲʱԭظдۣӱʱһ顣
+  // ÿȵֻһβ߿ܻܴСĿ¼
+  struct Directory {
+    explicit Directory(int depth)
+        : global_depth(depth), slots(new atomic<Bucket *>[static_cast<size_t>(1) << depth]) {};
+    int global_depth;
+    unique_ptr<atomic<Bucket *>[]> slots;
   };
 public:
   
@@ -34,14 +55,26 @@ public:
 
   int GetGlobalDepth() const;
   int GetLocalDepth(int bucket_id) const;
-  int GetNumBuckets() const        //ȡȫֺ;ֲ
+  int GetNumBuckets() const;        //ȡȫֺ;ֲ
   int getIdx(const K &key) const;
 
 private:
-  int global_depth;
+  static uint8_t Fingerprint(size_t hash);
+  int FindSlot(const Bucket &bucket, const K &key, uint8_t tag) const;
+  static bool Owns(const Bucket &bucket, size_t hash);
+  Bucket *LatchBucket(size_t hash, bool exclusive) const;
+  Directory *GetDirectory(int depth);
+  Bucket *NewBucket(int depth, size_t pattern);
+  void Split(Bucket *bucket);
+  void Merge(size_t hash);
+  void ShrinkDirectory();
+
   size_t bucket_size;
-  int bucket_num;
-  vector<shared_ptr<Bucket>> buckets;
-  mutable mutex latch;     // ӳԱ
+  atomic<int> bucket_num;
+  atomic<Directory *> directory;           // ǰĿ¼
+  vector<unique_ptr<Directory>> directories; // ȫ±Ŀ¼
+  vector<unique_ptr<Bucket>> bucket_pool;    // Ͱʱͷ
+  vector<Bucket *> free_buckets;             // ϲͰʱ
+  mutex latch;     // лѡϲĿ¼޸ģ߲ȡ
 };
 } 
@@ -0,0 +1,168 @@
+#include <algorithm>
+#include <cstdint>
+#include <fstream>
+#include <new>
+#include <string>
+
+#include <linux/mempolicy.h>
+#include <sys/mman.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+
+#include "buffer/frame_arena.h"
+#include "common/exception.h"
+
+namespace scudb {
+
+    const size_t FrameArena::SMALL_PAGE_SIZE;
+    const size_t FrameArena::HUGE_PAGE_SIZE;
+
+    static const int MAX_NUMA_NODES = 64; // nodemask只用一个unsigned long
+
+    FrameArena::FrameArena(size_t num_frames, ArenaType type, NumaPolicy numa_policy,
+        const std::vector<size_t>& partitions)
+        : num_frames_(num_frames), type_(type), bytes_(0), region_(nullptr), frames_(nullptr) {
+        if (type_ == ArenaType::HEAP) {
+            frames_ = new Page[num_frames_];
+            return;
+        }
+        region_ = Map(type_ == ArenaType::ALIGNED ? SMALL_PAGE_SIZE : HUGE_PAGE_SIZE);
+        if (region_ == nullptr && type_ == ArenaType::HUGETLB) {
+            type_ = ArenaType::TRANSPARENT_HUGE;
+            region_ = Map(HUGE_PAGE_SIZE);
+        }
+        if (region_ == nullptr) {
+            throw Exception("out of memory while allocating buffer pool frames");
+        }
+        if (type_ == ArenaType::TRANSPARENT_HUGE) {
+            // 内核没有开启透明大页时忽略失败，仍是普通页
+            madvise(region_, bytes_, MADV_HUGEPAGE);
+        }
+        BindNodes(numa_policy, partitions);
+        frames_ = static_cast<Page*>(region_);
+        for (size_t i = 0; i < num_frames_; ++i) {
+            new (&frames_[i]) Page();
+        }
+    }
+
+    FrameArena::~FrameArena() {
+        if (type_ == ArenaType::HEAP) {
+            delete[] frames_;
+            return;
+        }
+        for (size_t i = 0; i < num_frames_; ++i) {
+            frames_[i].~Page();
+        }
+        munmap(region_, bytes_);
+    }
+
+    /*
+     * MAP_HUGETLB的映射本身按大页对齐。其他情况mmap只保证按4 KiB对齐，
+     * 需要更大的对齐时多映射一个对齐长度，再把两头多出来的部分解除映射
+     */
+    void* FrameArena::Map(size_t align) {
+        bytes_ = (num_frames_ * sizeof(Page) + align - 1) / align * align;
+        if (bytes_ == 0) {
+            bytes_ = align;
+        }
+        if (type_ == ArenaType::HUGETLB) {
+            void* addr = mmap(nullptr, bytes_, PROT_READ | PROT_WRITE,
+                MAP_PRIVATE | MAP_ANONYMOUS | MAP_HUGETLB, -1, 0);
+            return addr == MAP_FAILED ? nullptr : addr;
+        }
+        size_t mapped = bytes_ + (align > SMALL_PAGE_SIZE ? align : 0);
+        void* addr = mmap(nullptr, mapped, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+        if (addr == MAP_FAILED) {
+            return nullptr;
+        }
+        char* start = static_cast<char*>(addr);
+        char* aligned = reinterpret_cast<char*>((reinterpret_cast<uintptr_t>(start) + align - 1) / align * align);
+        if (aligned > start) {
+            munmap(start, aligned - start);
+        }
+        if (start + mapped > aligned + bytes_) {
+            munmap(aligned + bytes_, start + mapped - (aligned + bytes_));
+        }
+        return aligned;
+    }
+
+    /*
+     * mbind按页设置策略，分片的边界向下取整到页，跨边界的那一页归后一个分片，
+     * 所以不足一页、整个落在这一页里的分片不算绑定。
+     * 没有libnuma，直接用系统调用；失败时（比如容器禁止了mbind）保持默认的首次访问分配，
+     * 该分片的节点记为-1
+     */
+    void FrameArena::BindNodes(NumaPolicy numa_policy, const std::vector<size_t>& partitions) {
+        std::vector<int> nodes;
+        for (int node : GetOnlineNodes()) {
+            if (node < MAX_NUMA_NODES) {
+                nodes.push_back(node);
+            }
+        }
+        if (numa_policy == NumaPolicy::NONE || nodes.size() <= 1) {
+            return;
+        }
+        unsigned long max_node = static_cast<unsigned long>(nodes.back()) + 2;
+        if (numa_policy == NumaPolicy::INTERLEAVE) {
+            unsigned long mask = 0;
+            for (int node : nodes) {
+                mask |= 1UL << node;
+            }
+            syscall(__NR_mbind, region_, bytes_, MPOL_INTERLEAVE, &mask, max_node, 0);
+            return;
+        }
+        size_t page = type_ == ArenaType::ALIGNED ? SMALL_PAGE_SIZE : HUGE_PAGE_SIZE;
+        char* base = static_cast<char*>(region_);
+        size_t first_frame = 0;
+        for (size_t i = 0; i < partitions.size(); ++i) {
+            int node = nodes[i % nodes.size()];
+            size_t begin = first_frame * sizeof(Page) / page * page;
+            first_frame += partitions[i];
+            size_t end = i + 1 == partitions.size() ? bytes_ : first_frame * sizeof(Page) / page * page;
+            unsigned long mask = 1UL << node;
+            if (end <= begin || syscall(__NR_mbind, base + begin, end - begin, MPOL_BIND, &mask, max_node, 0) != 0) {
+                node = -1;
+            }
+            nodes_.push_back(node);
+        }
+    }
+
+    int FrameArena::GetNode(size_t partition) const {
+        return partition < nodes_.size() ? nodes_[partition] : -1;
+    }
+
+    /*
+     * /sys/devices/system/node/online形如"0"、"0-1"或"0,2-3"
+     */
+    std::vector<int> FrameArena::GetOnlineNodes() {
+        std::vector<int> nodes;
+        std::ifstream online("/sys/devices/system/node/online");
+        std::string ranges;
+        if (online >> ranges) {
+            size_t pos = 0;
+            try {
+                while (pos < ranges.size()) {
+                    size_t end = ranges.find(',', pos);
+                    std::string range = ranges.substr(pos, end == std::string::npos ? std::string::npos : end - pos);
+                    size_t dash = range.find('-');
+                    int lo = std::stoi(range.substr(0, dash));
+                    int hi = dash == std::string::npos ? lo : std::stoi(range.substr(dash + 1));
+                    for (int node = lo; node <= hi; ++node) {
+                        nodes.push_back(node);
+                    }
+                    pos = end == std::string::npos ? ranges.size() : end + 1;
+                }
+            } catch (const std::exception&) {
+                nodes.clear();
+            }
+        }
+        if (nodes.empty()) {
+            nodes.push_back(0);
+        }
+        return nodes;
+    }
+
+    int FrameArena::GetNumNodes() {
+        return static_cast<int>(GetOnlineNodes().size());
+    }
+}
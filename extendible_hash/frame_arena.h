@@ -0,0 +1,59 @@
+#pragma once
+#include <cstddef>
+#include <vector>
+#include "page/page.h"
+using namespace std;
+
+namespace scudb {
+    // 缓冲池帧数组的内存来源。ALIGNED是一段按4 KiB对齐的匿名映射，
+    // TRANSPARENT_HUGE再按2 MiB对齐并建议内核用透明大页，减少随机访问帧时的TLB缺失。
+    // HUGETLB用预留的2 MiB大页（MAP_HUGETLB），系统没有预留足够的大页时退回TRANSPARENT_HUGE
+    enum class ArenaType { HEAP = 0, ALIGNED, TRANSPARENT_HUGE, HUGETLB };
+
+    // 帧数组在NUMA节点间的分布，只对映射出来的arena有效，单节点的机器上不起作用。
+    // INTERLEAVE按页轮流放在各节点上；PARTITION把每个分片的帧放在同一个节点上，
+    // 分片i用第i % 节点数个在线节点
+    enum class NumaPolicy { NONE = 0, INTERLEAVE, PARTITION };
+
+    /*
+     * 一次分配num_frames个连续的Page。Page的数据区是Page内的数组，只有帧数组的起点
+     * 能按页对齐，所以O_DIRECT读写其他帧时仍由AsyncDiskManager经中转缓冲区复制。
+     * NUMA策略在构造Page之前用mbind设置，帧第一次被写时就落在对应的节点上
+     */
+    class FrameArena {
+    public:
+        static const size_t SMALL_PAGE_SIZE = 4096;
+        static const size_t HUGE_PAGE_SIZE = 2 * 1024 * 1024;
+
+        // partitions是各分片的帧数，和为num_frames，只在PARTITION时使用
+        FrameArena(size_t num_frames, ArenaType type, NumaPolicy numa_policy = NumaPolicy::NONE,
+            const std::vector<size_t>& partitions = std::vector<size_t>());
+
+        ~FrameArena();
+
+        Page* GetFrames() const { return frames_; }
+        // 实际使用的内存来源，HUGETLB可能已退回TRANSPARENT_HUGE
+        ArenaType GetType() const { return type_; }
+        size_t GetBytes() const { return bytes_; }
+
+        // PARTITION时第partition个分片所在的节点；其他情况，或者没能把该分片绑到节点上时返回-1
+        int GetNode(size_t partition) const;
+
+        // 本机在线的NUMA节点号，升序，节点号不一定连续。读不到时为{0}
+        static std::vector<int> GetOnlineNodes();
+
+        // 本机在线的NUMA节点数，读不到时为1
+        static int GetNumNodes();
+
+    private:
+        void* Map(size_t align);
+        void BindNodes(NumaPolicy numa_policy, const std::vector<size_t>& partitions);
+
+        size_t num_frames_;
+        ArenaType type_;
+        size_t bytes_;      // 映射的字节数，HEAP时为0
+        void* region_;      // 映射的起点，已按对齐要求调整
+        Page* frames_;
+        std::vector<int> nodes_; // PARTITION时各分片所在的节点，绑定失败的为-1
+    };
+}
@@ -0,0 +1,110 @@
+#include <cassert>
+#include <functional>
+
+#include "common/rid.h"
+#include "hash/hash_page.h"
+
+namespace scudb {
+
+    const size_t HashDirectoryPage::DIRECTORY_SLOTS;
+
+    void HashDirectoryPage::Init(page_id_t page_id, page_id_t bucket_page_id) {
+        static_assert(sizeof(HashDirectoryPage) <= PAGE_SIZE, "directory does not fit in a page");
+        page_id_ = page_id;
+        global_depth_ = 0;
+        local_depths_[0] = 0;
+        bucket_page_ids_[0] = bucket_page_id;
+    }
+
+    void HashDirectoryPage::SetBucket(size_t low_idx, int depth, page_id_t bucket_page_id) {
+        size_t step = static_cast<size_t>(1) << depth;
+        for (size_t i = low_idx & (step - 1); i < Size(); i += step) {
+            local_depths_[i] = static_cast<uint8_t>(depth);
+            bucket_page_ids_[i] = bucket_page_id;
+        }
+    }
+
+    void HashDirectoryPage::IncrGlobalDepth() {
+        assert(CanGrow());
+        size_t length = Size();
+        for (size_t i = 0; i < length; i++) {
+            local_depths_[i + length] = local_depths_[i];
+            bucket_page_ids_[i + length] = bucket_page_ids_[i];
+        }
+        global_depth_++;
+    }
+
+    bool HashDirectoryPage::CanShrink() const {
+        if (global_depth_ == 0) {
+            return false;
+        }
+        for (size_t i = 0; i < Size(); i++) {
+            if (local_depths_[i] == global_depth_) {
+                return false;
+            }
+        }
+        return true;
+    }
+
+    void HashDirectoryPage::DecrGlobalDepth() {
+        assert(CanShrink());
+        global_depth_--;
+    }
+
+    template <typename K, typename V>
+    int HashBucketPage<K, V>::KeyIndex(const K& key) const {
+        for (int i = 0; i < size_; i++) {
+            if (array[i].first == key) {
+                return i;
+            }
+        }
+        return -1;
+    }
+
+    template <typename K, typename V>
+    bool HashBucketPage<K, V>::Lookup(const K& key, V& value) const {
+        int idx = KeyIndex(key);
+        if (idx == -1) {
+            return false;
+        }
+        value = array[idx].second;
+        return true;
+    }
+
+    template <typename K, typename V>
+    bool HashBucketPage<K, V>::Insert(const K& key, const V& value) {
+        if (IsFull() || KeyIndex(key) != -1) {
+            return false;
+        }
+        array[size_++] = MappingType(key, value);
+        return true;
+    }
+
+    // 用最后一个条目填补空位
+    template <typename K, typename V>
+    bool HashBucketPage<K, V>::Remove(const K& key) {
+        int idx = KeyIndex(key);
+        if (idx == -1) {
+            return false;
+        }
+        array[idx] = array[--size_];
+        return true;
+    }
+
+    template <typename K, typename V>
+    void HashBucketPage<K, V>::MoveSplitImageTo(HashBucketPage* recipient, size_t bit) {
+        int keep = 0;
+        for (int i = 0; i < size_; i++) {
+            if (hash<K>{}(array[i].first) & bit) {
+                recipient->array[recipient->size_++] = array[i];
+            }
+            else {
+                array[keep++] = array[i];
+            }
+        }
+        size_ = keep;
+    }
+
+    template class HashBucketPage<int, int>;
+    template class HashBucketPage<int, RID>;
+}
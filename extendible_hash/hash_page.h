@@ -0,0 +1,86 @@
+#pragma once
+#include <cstdint>
+#include <utility>
+#include "page/page.h"
+using namespace std;
+
+namespace scudb {
+
+    // 页头8字节之后每个槽占5字节，取能放进一页的最大的2的幂
+    constexpr size_t HashDirectorySlots(size_t slots) {
+        return 8 + 5 * slots * 2 <= PAGE_SIZE ? HashDirectorySlots(slots * 2) : slots;
+    }
+
+    /*
+     * 磁盘可扩展哈希的目录页，整个目录放在一页里
+     *  -----------------------------------------------------------------------------
+     * | PageId (4) | GlobalDepth (4) | LocalDepth (1) * SLOTS | BucketPageId (4) * SLOTS |
+     *  -----------------------------------------------------------------------------
+     * 局部深度和桶一起记在目录里，判断能否分裂、合并时不用读桶页
+     */
+    class HashDirectoryPage {
+    public:
+        static const size_t DIRECTORY_SLOTS = HashDirectorySlots(1);
+
+        // 新分配的目录页只有一个槽，指向bucket_page_id
+        void Init(page_id_t page_id, page_id_t bucket_page_id);
+
+        page_id_t GetPageId() const { return page_id_; }
+        int GetGlobalDepth() const { return global_depth_; }
+        size_t Size() const { return static_cast<size_t>(1) << global_depth_; }
+        size_t GetGlobalDepthMask() const { return Size() - 1; }
+        bool CanGrow() const { return Size() < DIRECTORY_SLOTS; }
+
+        page_id_t GetBucketPageId(size_t idx) const { return bucket_page_ids_[idx]; }
+        int GetLocalDepth(size_t idx) const { return local_depths_[idx]; }
+
+        // 把low_idx所在桶的所有槽都设为指向bucket_page_id，局部深度为depth
+        void SetBucket(size_t low_idx, int depth, page_id_t bucket_page_id);
+
+        // 目录加倍，新的上半部分复制下半部分
+        void IncrGlobalDepth();
+
+        // 没有桶的局部深度等于全局深度时可以减半
+        bool CanShrink() const;
+        void DecrGlobalDepth();
+
+    private:
+        page_id_t page_id_;
+        int global_depth_;
+        uint8_t local_depths_[DIRECTORY_SLOTS];
+        page_id_t bucket_page_ids_[DIRECTORY_SLOTS];
+    };
+
+    /*
+     * 磁盘可扩展哈希的桶页，条目不排序，前size个有效
+     *  ----------------------------------------------------------
+     * | CurrentSize (4) | KEY(1) + VALUE(1) | ... | KEY(n) + VALUE(n)
+     *  ----------------------------------------------------------
+     */
+    template <typename K, typename V> class HashBucketPage {
+    public:
+        typedef pair<K, V> MappingType;
+
+        void Init() { size_ = 0; }
+
+        int GetSize() const { return size_; }
+        static int GetMaxSize() { return static_cast<int>((PAGE_SIZE - sizeof(HashBucketPage)) / sizeof(MappingType)); }
+        bool IsFull() const { return size_ >= GetMaxSize(); }
+
+        bool Lookup(const K& key, V& value) const;
+
+        // 键已存在或桶已满时返回false
+        bool Insert(const K& key, const V& value);
+
+        bool Remove(const K& key);
+
+        // 把哈希值中bit位为1的条目移到recipient，用于分裂
+        void MoveSplitImageTo(HashBucketPage* recipient, size_t bit);
+
+    private:
+        int KeyIndex(const K& key) const;
+        int size_;
+        MappingType array[0];
+    };
+
+}
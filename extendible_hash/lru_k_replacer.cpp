@@ -0,0 +1,98 @@
+#include <cassert>
+
+#include "buffer/lru_k_replacer.h"
+#include "page/page.h"
+
+namespace scudb {
+
+    template <typename T> LRUKReplacer<T>::LRUKReplacer(size_t num_frames, T base, size_t k)
+        : num_frames(num_frames), k(k == 0 ? 1 : k), base(base), current_timestamp(0), size(0) {
+        history = new size_t[num_frames * this->k]();
+        access_count = new size_t[num_frames]();
+        next_slot = new size_t[num_frames]();
+        in_replacer = new bool[num_frames]();
+    }
+
+    template <typename T> LRUKReplacer<T>::~LRUKReplacer() {
+        delete[] history;
+        delete[] access_count;
+        delete[] next_slot;
+        delete[] in_replacer;
+    }
+
+    /*
+     * 记录一次访问并让帧可被替换
+     */
+    template <typename T> void LRUKReplacer<T>::Insert(const T& value) {
+        lock_guard<mutex> lck(latch);
+        size_t idx = FrameId(value);
+        assert(idx < num_frames);
+        history[idx * k + next_slot[idx]] = current_timestamp++;
+        next_slot[idx] = (next_slot[idx] + 1) % k;
+        if (access_count[idx] < k) {
+            access_count[idx]++;
+        }
+        if (!in_replacer[idx]) {
+            in_replacer[idx] = true;
+            size++;
+        }
+    }
+
+    /*
+     * 在可替换的帧中选后向K距离最大的：访问不足K次的帧优先，比较最早一次访问；
+     * 否则比较倒数第K次访问。被选中的帧清空访问历史，因为它将装入别的页面
+     */
+    template <typename T> bool LRUKReplacer<T>::Victim(T& value) {
+        lock_guard<mutex> lck(latch);
+        if (size == 0) {
+            return false;
+        }
+        size_t victim = num_frames;
+        bool victim_inf = false;
+        size_t victim_ts = 0;
+        for (size_t i = 0; i < num_frames; ++i) {
+            if (!in_replacer[i]) {
+                continue;
+            }
+            bool inf = access_count[i] < k;
+            // 环形缓冲区未写满时最早的访问在0号位置，写满时在next_slot处
+            size_t ts = history[i * k + (inf ? 0 : next_slot[i])];
+            if (victim == num_frames || (inf && !victim_inf) ||
+                (inf == victim_inf && ts < victim_ts)) {
+                victim = i;
+                victim_inf = inf;
+                victim_ts = ts;
+            }
+        }
+        in_replacer[victim] = false;
+        access_count[victim] = 0;
+        next_slot[victim] = 0;
+        size--;
+        value = base + victim;
+        return true;
+    }
+
+    /*
+     * 从替换器中删除值，保留访问历史。如果移除成功，返回true，否则返回false
+     */
+    template <typename T> bool LRUKReplacer<T>::Erase(const T& value) {
+        lock_guard<mutex> lck(latch);
+        size_t idx = FrameId(value);
+        if (idx >= num_frames || !in_replacer[idx]) {
+            return false;
+        }
+        in_replacer[idx] = false;
+        size--;
+        return true;
+    }
+
+    template <typename T> size_t LRUKReplacer<T>::Size() {
+        lock_guard<mutex> lck(latch);
+        return size;
+    }
+
+    template class LRUKReplacer<Page*>;
+
+    template class LRUKReplacer<int>;
+
+}
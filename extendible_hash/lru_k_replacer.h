@@ -0,0 +1,43 @@
+#pragma once
+#include <mutex>
+#include "buffer/replacer.h"
+using namespace std;
+
+namespace scudb {
+
+    /*
+     * LRU-K置换：按帧下标（value - base）记录每帧最近K次访问的时间戳，
+     * 淘汰后向K距离最大的帧。访问不足K次的帧距离为无穷大，优先淘汰，
+     * 其中最早被访问的先淘汰。一次顺序扫描只访问每页一次，不会挤掉
+     * 被反复访问的热点页
+     */
+    template <typename T> class LRUKReplacer : public Replacer<T> {
+    public:
+        LRUKReplacer(size_t num_frames, T base = T(), size_t k = 2);
+
+        ~LRUKReplacer();
+
+        // 一次Insert算作对该帧的一次访问
+        void Insert(const T& value);
+
+        bool Victim(T& value);
+
+        bool Erase(const T& value);
+
+        size_t Size();
+
+    private:
+        size_t FrameId(const T& value) const { return static_cast<size_t>(value - base); }
+        size_t num_frames;
+        size_t k;
+        T base;                 // 下标为0的帧
+        size_t* history;        // 每帧k个时间戳的环形缓冲区，共num_frames * k个
+        size_t* access_count;   // 每帧记录的访问次数，最多k
+        size_t* next_slot;      // 环形缓冲区中下一次写入的位置
+        bool* in_replacer;      // 该帧当前是否可被替换
+        size_t current_timestamp;
+        size_t size;
+        mutable mutex latch;
+    };
+
+}
@@ -1,13 +1,15 @@
+#include <cassert>
+
 #include "buffer/lru_replacer.h"
 #include "page/page.h"
 
 namespace scudb {
 
     template <typename T> LRUReplacer<T>::LRUReplacer() {
-        head_node = make_shared<Node>();
-        tail_node = make_shared<Node>();
-        head_node->next_node = tail_node;
-        tail_node->prev_node = head_node;
+        head = make_shared<Node>();
+        tail = make_shared<Node>();
+        head->next = tail;
+        tail->prev = head;
     }
 
     template <typename T> LRUReplacer<T>::~LRUReplacer() {}
@@ -21,18 +23,18 @@ namespace scudb {
             cur = map[value];
             shared_ptr<Node> prev = cur->prev;
             shared_ptr<Node> succ = cur->next;
-            prev->next_node = succ;
-            succ->prev_node = prev;
+            prev->next = succ;
+            succ->prev = prev;
         }
         else {
             cur = make_shared<Node>(value);
         }
-        shared_ptr<Node> fir = head_node->next_node;
-        cur_node->next_node = fir_node;
-        fir_node->prev_node = cur_node;
-        cur_node->prev_node = head_node;
-        head_node->next_node = cur_node;
-        node_map[value] = cur_node;   //将值插入LRU
+        shared_ptr<Node> fir = head->next;
+        cur->next = fir;
+        fir->prev = cur;
+        cur->prev = head;
+        head->next = cur;
+        map[value] = cur;   //将值插入LRU
         return;
     }
 
@@ -44,11 +46,11 @@ namespace scudb {
         if (map.empty()) {
             return false;
         }
-        shared_ptr<Node> last_node = tail_node->prev_node;
-        tail_node->prev_node = last_node->prev_node;
-        last_node->prev_node->next_node = tail_node;
-        value = last_node->val_node;
-        node_map.erase(last->val);
+        shared_ptr<Node> last_node = tail->prev;
+        tail->prev = last_node->prev;
+        last_node->prev->next = tail;
+        value = last_node->val;
+        map.erase(last_node->val);
         return true;
     }
 
@@ -58,20 +60,101 @@ namespace scudb {
     template <typename T> bool LRUReplacer<T>::Erase(const T& value) {
         lock_guard<mutex> lck(latch);
         if (map.find(value) != map.end()) {
-            shared_ptr<Node> cur_node = node_map[value];
-            cur_node->prev_node->next_node = cur_node->next_node;
-            cur_node->next_node->prev_node = cur_node->prev_node;
+            shared_ptr<Node> cur = map[value];
+            cur->prev->next = cur->next;
+            cur->next->prev = cur->prev;
         }
-        return node_map.erase(value);
+        return map.erase(value);
     }
 
     template <typename T> size_t LRUReplacer<T>::Size() {
         lock_guard<mutex> lck(latch);
-        return node_map.size();
+        return map.size();
+    }
+
+    template <typename T> FrameLRUReplacer<T>::FrameLRUReplacer(size_t num_frames, T base)
+        : num_frames(num_frames), base(base), size(0) {
+        prev = new size_t[num_frames + 1];
+        next = new size_t[num_frames + 1];
+        in_list = new bool[num_frames]();
+        prev[num_frames] = num_frames;
+        next[num_frames] = num_frames;
+    }
+
+    template <typename T> FrameLRUReplacer<T>::~FrameLRUReplacer() {
+        delete[] prev;
+        delete[] next;
+        delete[] in_list;
+    }
+
+    template <typename T> void FrameLRUReplacer<T>::Unlink(size_t idx) {
+        next[prev[idx]] = next[idx];
+        prev[next[idx]] = prev[idx];
+    }
+
+    /*
+     * 把帧移到哨兵之后（最近使用端），已经在链表中的先摘下来
+     */
+    template <typename T> void FrameLRUReplacer<T>::Insert(const T& value) {
+        lock_guard<mutex> lck(latch);
+        size_t idx = FrameId(value);
+        assert(idx < num_frames);
+        if (in_list[idx]) {
+            Unlink(idx);
+        }
+        else {
+            in_list[idx] = true;
+            size++;
+        }
+        size_t fir = next[num_frames];
+        next[idx] = fir;
+        prev[fir] = idx;
+        prev[idx] = num_frames;
+        next[num_frames] = idx;
+    }
+
+    /*
+     *如果LRU非空，从哨兵之前（最久未使用端）弹出一帧到参数“value”，并且返回true。如果LRU为空，返回false
+     */
+    template <typename T> bool FrameLRUReplacer<T>::Victim(T& value) {
+        lock_guard<mutex> lck(latch);
+        if (size == 0) {
+            return false;
+        }
+        size_t last = prev[num_frames];
+        Unlink(last);
+        in_list[last] = false;
+        size--;
+        value = base + last;
+        return true;
+    }
+
+    /*
+     * 从LRU中删除值。如果移除成功，返回true，否则返回false
+     */
+    template <typename T> bool FrameLRUReplacer<T>::Erase(const T& value) {
+        lock_guard<mutex> lck(latch);
+        size_t idx = FrameId(value);
+        if (idx >= num_frames || !in_list[idx]) {
+            return false;
+        }
+        Unlink(idx);
+        in_list[idx] = false;
+        size--;
+        return true;
+    }
+
+    template <typename T> size_t FrameLRUReplacer<T>::Size() {
+        lock_guard<mutex> lck(latch);
+        return size;
     }
 
     template class LRUReplacer<Page*>;
     
     template class LRUReplacer<int>;
 
+    template class FrameLRUReplacer<Page*>;
+
+    template class FrameLRUReplacer<int>;
+
 } 
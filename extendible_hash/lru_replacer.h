@@ -35,4 +35,35 @@ namespace scudb {
         mutable mutex latch;    //在这里添加成员变量
     };
 
+    /*
+     * 按帧下标（value - base）组织的侵入式LRU链表：前驱和后继都是预分配数组里的下标，
+     * 下标num_frames是哨兵。Insert/Victim/Erase都是O(1)，构造之后不再分配内存，
+     * 也没有shared_ptr的引用计数开销。缓冲池的帧数组就是这种固定的键空间
+     */
+    template <typename T> class FrameLRUReplacer : public Replacer<T> {
+    public:
+        FrameLRUReplacer(size_t num_frames, T base = T());
+
+        ~FrameLRUReplacer();
+
+        void Insert(const T& value);
+
+        bool Victim(T& value);
+
+        bool Erase(const T& value);
+
+        size_t Size();
+
+    private:
+        size_t FrameId(const T& value) const { return static_cast<size_t>(value - base); }
+        void Unlink(size_t idx);
+        size_t num_frames;
+        T base;                 // 下标为0的帧
+        size_t* prev;           // 共num_frames + 1个，最后一个是哨兵
+        size_t* next;
+        bool* in_list;          // 该帧当前是否在链表中
+        size_t size;
+        mutable mutex latch;
+    };
+
 }
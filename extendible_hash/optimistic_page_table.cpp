@@ -0,0 +1,113 @@
+#include <cassert>
+#include <vector>
+
+#include "buffer/optimistic_page_table.h"
+
+namespace scudb {
+
+    OptimisticPageTable::OptimisticPageTable(size_t num_frames)
+        : num_entries_(0), num_tombstones_(0) {
+        capacity_ = 2;
+        while (capacity_ < num_frames * 2) {
+            capacity_ <<= 1;
+        }
+        mask_ = capacity_ - 1;
+        slots_ = new atomic<uint64_t>[capacity_];
+        for (size_t i = 0; i < capacity_; ++i) {
+            slots_[i].store(EMPTY, memory_order_relaxed);
+        }
+    }
+
+    OptimisticPageTable::~OptimisticPageTable() {
+        delete[] slots_;
+    }
+
+    // 同一分片内的page_id模分片数同余，用乘法散列打散，避免挤在少数槽上
+    size_t OptimisticPageTable::Home(page_id_t page_id) const {
+        return static_cast<size_t>((static_cast<uint32_t>(page_id) * 0x9E3779B97F4A7C15ULL) >> 32) & mask_;
+    }
+
+    /*
+     * 线性探测直到空槽，不加锁。返回true只说明该槽某一时刻记录过这个映射
+     */
+    bool OptimisticPageTable::Find(page_id_t page_id, size_t& frame_id) const {
+        if (page_id == INVALID_PAGE_ID) {
+            return false;
+        }
+        size_t idx = Home(page_id);
+        for (size_t probe = 0; probe < capacity_; ++probe) {
+            uint64_t slot = slots_[idx].load(memory_order_acquire);
+            if (slot == EMPTY) {
+                return false;
+            }
+            if (slot != TOMBSTONE && PageIdOf(slot) == page_id) {
+                frame_id = static_cast<uint32_t>(slot);
+                return true;
+            }
+            idx = (idx + 1) & mask_;
+        }
+        return false;
+    }
+
+    /*
+     * 调用者保证page_id不在表中。复用探测序列上的第一个墓碑或空槽
+     */
+    void OptimisticPageTable::Insert(page_id_t page_id, size_t frame_id) {
+        assert(page_id != INVALID_PAGE_ID);
+        size_t idx = Home(page_id);
+        while (true) {
+            uint64_t slot = slots_[idx].load(memory_order_relaxed);
+            if (slot == EMPTY || slot == TOMBSTONE) {
+                if (slot == TOMBSTONE) {
+                    num_tombstones_--;
+                }
+                slots_[idx].store(Pack(page_id, frame_id), memory_order_release);
+                num_entries_++;
+                break;
+            }
+            idx = (idx + 1) & mask_;
+        }
+    }
+
+    bool OptimisticPageTable::Remove(page_id_t page_id) {
+        if (page_id == INVALID_PAGE_ID) {
+            return false;
+        }
+        size_t idx = Home(page_id);
+        for (size_t probe = 0; probe < capacity_; ++probe) {
+            uint64_t slot = slots_[idx].load(memory_order_relaxed);
+            if (slot == EMPTY) {
+                return false;
+            }
+            if (slot != TOMBSTONE && PageIdOf(slot) == page_id) {
+                slots_[idx].store(TOMBSTONE, memory_order_release);
+                num_entries_--;
+                num_tombstones_++;
+                // 墓碑太多时未命中要扫很长，原地重建；读者最多漏掉几次，退回加锁路径
+                if (capacity_ - num_entries_ - num_tombstones_ < capacity_ / 4) {
+                    Rebuild();
+                }
+                return true;
+            }
+            idx = (idx + 1) & mask_;
+        }
+        return false;
+    }
+
+    void OptimisticPageTable::Rebuild() {
+        std::vector<uint64_t> live;
+        for (size_t i = 0; i < capacity_; ++i) {
+            uint64_t slot = slots_[i].load(memory_order_relaxed);
+            if (slot != EMPTY && slot != TOMBSTONE) {
+                live.push_back(slot);
+            }
+            slots_[i].store(EMPTY, memory_order_release);
+        }
+        num_entries_ = 0;
+        num_tombstones_ = 0;
+        for (uint64_t slot : live) {
+            Insert(PageIdOf(slot), static_cast<uint32_t>(slot));
+        }
+    }
+
+}
@@ -0,0 +1,45 @@
+#pragma once
+#include <atomic>
+#include <cstdint>
+#include "common/config.h"
+using namespace std;
+
+namespace scudb {
+
+    /*
+     * 缓冲池命中路径用的定长开放寻址表：page_id -> 帧下标。
+     * 每个槽是一个原子的64位字（高32位page_id，低32位帧下标），读者不加锁，
+     * 写者由调用者（分片的latch）串行化。读者可能读到过时的结果或漏掉正在
+     * 移动的条目，所以Find的结果只是提示：调用者必须钉住帧后再核对帧里的
+     * page_id，找不到时退回加锁的路径
+     */
+    class OptimisticPageTable {
+    public:
+        explicit OptimisticPageTable(size_t num_frames);
+
+        ~OptimisticPageTable();
+
+        bool Find(page_id_t page_id, size_t& frame_id) const;
+
+        void Insert(page_id_t page_id, size_t frame_id);
+
+        bool Remove(page_id_t page_id);
+
+    private:
+        static const uint64_t EMPTY = ~0ULL;
+        static const uint64_t TOMBSTONE = ~0ULL - 1;
+        static uint64_t Pack(page_id_t page_id, size_t frame_id) {
+            return (static_cast<uint64_t>(static_cast<uint32_t>(page_id)) << 32) | static_cast<uint32_t>(frame_id);
+        }
+        static page_id_t PageIdOf(uint64_t slot) { return static_cast<page_id_t>(slot >> 32); }
+        size_t Home(page_id_t page_id) const;
+        void Rebuild();
+
+        size_t capacity_;       // 2的幂，至少是帧数的两倍
+        size_t mask_;
+        atomic<uint64_t>* slots_;
+        size_t num_entries_;
+        size_t num_tombstones_;
+    };
+
+}
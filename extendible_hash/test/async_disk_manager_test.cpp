@@ -0,0 +1,320 @@
+/**
+ * async_disk_manager_test.cpp
+ */
+
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <thread>
+#include <type_traits>
+#include <vector>
+
+#include "buffer/buffer_pool_manager.h"
+#include "disk/async_disk_manager.h"
+#include "gtest/gtest.h"
+
+namespace cmudb {
+
+// page I/O through a DiskManager* would bypass the O_DIRECT file descriptor
+static_assert(!std::is_convertible<AsyncDiskManager *, DiskManager *>::value,
+              "AsyncDiskManager must not be usable as a DiskManager");
+
+// both backends write a batch, read it back, and zero-fill past the end of file
+static void CheckBatchIO(bool use_io_uring) {
+  const size_t queue_depth = 16;
+  AsyncDiskManager disk_manager("test.db", queue_depth, use_io_uring);
+  if (!use_io_uring) {
+    EXPECT_EQ(AsyncDiskManager::Backend::THREAD_POOL, disk_manager.GetBackend());
+  }
+  EXPECT_EQ(queue_depth, disk_manager.GetQueueDepth());
+
+  std::vector<std::vector<char>> pages(queue_depth, std::vector<char>(PAGE_SIZE));
+  for (size_t i = 0; i < queue_depth; ++i) {
+    snprintf(pages[i].data(), PAGE_SIZE, "page %zu", i);
+    EXPECT_EQ(true, disk_manager.SubmitWrite(static_cast<page_id_t>(i), pages[i].data(), i));
+  }
+  // every slot is in flight
+  EXPECT_EQ(false, disk_manager.SubmitWrite(0, pages[0].data(), 0));
+  EXPECT_EQ(queue_depth, disk_manager.GetInFlight());
+  disk_manager.Submit();
+  std::vector<AsyncDiskManager::Completion> done;
+  while (done.size() < queue_depth) {
+    disk_manager.Complete(done, 1);
+  }
+  std::vector<bool> seen(queue_depth, false);
+  for (auto &completion : done) {
+    EXPECT_EQ(0, completion.result);
+    seen[completion.tag] = true;
+  }
+  for (size_t i = 0; i < queue_depth; ++i) {
+    EXPECT_EQ(true, static_cast<bool>(seen[i]));
+  }
+  EXPECT_EQ(0u, disk_manager.GetInFlight());
+
+  std::vector<std::vector<char>> reads(queue_depth, std::vector<char>(PAGE_SIZE, 'x'));
+  for (size_t i = 0; i < queue_depth; ++i) {
+    // the last request reads a page that was never written
+    page_id_t page_id = static_cast<page_id_t>(i == queue_depth - 1 ? 1000 : i);
+    EXPECT_EQ(true, disk_manager.SubmitRead(page_id, reads[i].data(), i));
+  }
+  disk_manager.Submit();
+  done.clear();
+  EXPECT_EQ(queue_depth, disk_manager.Complete(done, queue_depth));
+  for (auto &completion : done) {
+    EXPECT_EQ(0, completion.result);
+  }
+  for (size_t i = 0; i + 1 < queue_depth; ++i) {
+    EXPECT_EQ(0, memcmp(pages[i].data(), reads[i].data(), PAGE_SIZE));
+  }
+  std::vector<char> zeros(PAGE_SIZE, 0);
+  EXPECT_EQ(0, memcmp(zeros.data(), reads[queue_depth - 1].data(), PAGE_SIZE));
+
+  // synchronous calls see the same file
+  char buf[PAGE_SIZE];
+  disk_manager.ReadPage(3, buf);
+  EXPECT_EQ(0, strcmp("page 3", buf));
+  strcpy(buf, "rewritten");
+  disk_manager.WritePage(3, buf);
+  EXPECT_EQ(true, disk_manager.SubmitRead(3, reads[0].data(), 0));
+  disk_manager.Submit();
+  done.clear();
+  disk_manager.Complete(done, 1);
+  EXPECT_EQ(0, strcmp("rewritten", reads[0].data()));
+}
+
+TEST(AsyncDiskManagerTest, IoUringTest) {
+  CheckBatchIO(true);
+  remove("test.db");
+}
+
+TEST(AsyncDiskManagerTest, ThreadPoolTest) {
+  CheckBatchIO(false);
+  remove("test.db");
+}
+
+// prefetches through the buffer pool are read with many requests in flight
+TEST(AsyncDiskManagerTest, BufferPoolPrefetchTest) {
+  const int pool_size = 64;
+  page_id_t temp_page_id;
+
+  AsyncDiskManager *disk_manager = new AsyncDiskManager("test.db", 32);
+  BufferPoolManager *bpm = new BufferPoolManager(pool_size, disk_manager, nullptr, 4);
+  for (int i = 0; i < pool_size * 2; ++i) {
+    Page *page = bpm->NewPage(temp_page_id);
+    ASSERT_NE(nullptr, page);
+    snprintf(page->GetData(), PAGE_SIZE, "page %d", temp_page_id);
+    EXPECT_EQ(true, bpm->UnpinPage(temp_page_id, true));
+  }
+
+  for (page_id_t page_id = 0; page_id < pool_size; ++page_id) {
+    bpm->PrefetchPage(page_id);
+  }
+  for (page_id_t page_id = 0; page_id < pool_size; ++page_id) {
+    while (!bpm->PrefetchPage(page_id)) {
+      std::this_thread::sleep_for(std::chrono::milliseconds(1));
+    }
+  }
+  // prefetches are not counted as misses
+  EXPECT_EQ(0.0, bpm->GetHitRatio());
+  char expect[PAGE_SIZE];
+  for (page_id_t page_id = 0; page_id < pool_size; ++page_id) {
+    Page *page = bpm->FetchPage(page_id);
+    ASSERT_NE(nullptr, page);
+    snprintf(expect, PAGE_SIZE, "page %d", page_id);
+    EXPECT_EQ(0, strcmp(expect, page->GetData()));
+    EXPECT_EQ(true, bpm->UnpinPage(page_id, false));
+  }
+  EXPECT_EQ(1.0, bpm->GetHitRatio());
+
+  delete bpm;
+  delete disk_manager;
+  remove("test.db");
+}
+
+// pages written back by the flusher and then evicted clean are never
+// prefetched from disk before the write lands
+TEST(AsyncDiskManagerTest, PrefetchWithFlusherTest) {
+  const int pool_size = 16;
+  const int num_pages = 64;
+  const int rounds = 50;
+  page_id_t temp_page_id;
+
+  AsyncDiskManager *disk_manager = new AsyncDiskManager("test.db", 8);
+  BufferPoolManager *bpm = new BufferPoolManager(pool_size, disk_manager, nullptr, 2);
+  for (int i = 0; i < num_pages; ++i) {
+    Page *page = bpm->NewPage(temp_page_id);
+    ASSERT_NE(nullptr, page);
+    snprintf(page->GetData(), PAGE_SIZE, "page %d round 0", temp_page_id);
+    EXPECT_EQ(true, bpm->UnpinPage(temp_page_id, true));
+  }
+  bpm->StartFlusher(0.0, std::chrono::milliseconds(0));
+
+  char expect[PAGE_SIZE];
+  for (int round = 1; round <= rounds; ++round) {
+    for (page_id_t page_id = 0; page_id < num_pages; ++page_id) {
+      Page *page = bpm->FetchPage(page_id);
+      ASSERT_NE(nullptr, page);
+      snprintf(expect, PAGE_SIZE, "page %d round %d", page_id, round - 1);
+      EXPECT_EQ(0, strcmp(expect, page->GetData()));
+      snprintf(page->GetData(), PAGE_SIZE, "page %d round %d", page_id, round);
+      EXPECT_EQ(true, bpm->UnpinPage(page_id, true));
+      // the page just written is soon evicted; ask for it back at once
+      bpm->PrefetchPage((page_id + num_pages - pool_size) % num_pages);
+      bpm->PrefetchPage(page_id);
+    }
+  }
+  bpm->StopFlusher();
+
+  delete bpm;
+  delete disk_manager;
+  remove("test.db");
+}
+
+// O_DIRECT I/O from unaligned frames goes through the bounce buffers
+TEST(AsyncDiskManagerTest, DirectIOTest) {
+  for (bool use_io_uring : {true, false}) {
+    AsyncDiskManager disk_manager("test.db", 4, use_io_uring, true);
+    std::vector<char> data(PAGE_SIZE * 3 + 1);
+    char *unaligned = data.data() + 1;
+    for (page_id_t page_id = 0; page_id < 3; ++page_id) {
+      snprintf(unaligned + page_id * PAGE_SIZE, PAGE_SIZE, "direct %d", page_id);
+      EXPECT_EQ(true, disk_manager.SubmitWrite(page_id, unaligned + page_id * PAGE_SIZE, page_id));
+    }
+    disk_manager.Submit();
+    std::vector<AsyncDiskManager::Completion> done;
+    disk_manager.Complete(done, 3);
+    for (auto &completion : done) {
+      EXPECT_EQ(0, completion.result);
+    }
+
+    char buf[PAGE_SIZE + 1];
+    disk_manager.ReadPage(1, buf + 1);
+    EXPECT_EQ(0, strcmp("direct 1", buf + 1));
+    memset(unaligned, 0, PAGE_SIZE * 3);
+    EXPECT_EQ(true, disk_manager.SubmitRead(2, unaligned, 0));
+    disk_manager.Submit();
+    disk_manager.Complete(done, 1);
+    EXPECT_EQ(0, strcmp("direct 2", unaligned));
+    std::cout << "AsyncDiskManager direct I/O: " << (disk_manager.IsDirectIO() ? "O_DIRECT" : "buffered")
+              << std::endl;
+    remove("test.db");
+  }
+
+  // a buffer pool on an aligned arena round-trips pages through O_DIRECT
+  const int pool_size = 16;
+  AsyncDiskManager *disk_manager = new AsyncDiskManager("test.db", 8, true, true);
+  BufferPoolManager *bpm = new BufferPoolManager(pool_size, disk_manager, nullptr, 1, ReplacerType::LRU,
+                                                 ArenaType::ALIGNED);
+  page_id_t temp_page_id;
+  for (int i = 0; i < pool_size * 2; ++i) {
+    Page *page = bpm->NewPage(temp_page_id);
+    ASSERT_NE(nullptr, page);
+    snprintf(page->GetData(), PAGE_SIZE, "page %d", temp_page_id);
+    EXPECT_EQ(true, bpm->UnpinPage(temp_page_id, true));
+  }
+  char expect[PAGE_SIZE];
+  for (page_id_t page_id = 0; page_id < pool_size * 2; ++page_id) {
+    Page *page = bpm->FetchPage(page_id);
+    ASSERT_NE(nullptr, page);
+    snprintf(expect, PAGE_SIZE, "page %d", page_id);
+    EXPECT_EQ(0, strcmp(expect, page->GetData()));
+    EXPECT_EQ(true, bpm->UnpinPage(page_id, false));
+  }
+  delete bpm;
+  delete disk_manager;
+  remove("test.db");
+}
+
+// a run of pages is written with one call, from aligned and unaligned buffers,
+// and FlushRange writes its runs through it
+TEST(AsyncDiskManagerTest, WritePagesTest) {
+  for (bool direct_io : {false, true}) {
+    AsyncDiskManager disk_manager("test.db", 4, true, direct_io);
+    void *mem = nullptr;
+    ASSERT_EQ(0, posix_memalign(&mem, AsyncDiskManager::DIRECT_IO_ALIGNMENT, PAGE_SIZE * 5));
+    char *aligned = static_cast<char *>(mem);
+    for (page_id_t page_id = 0; page_id < 4; ++page_id) {
+      snprintf(aligned + page_id * PAGE_SIZE, PAGE_SIZE, "run %d", page_id);
+    }
+    disk_manager.WritePages(0, aligned, 4);
+    // pages 2..3 again, one byte off the alignment
+    memmove(aligned + 1, aligned + 2 * PAGE_SIZE, PAGE_SIZE * 2);
+    snprintf(aligned + 1 + PAGE_SIZE, PAGE_SIZE, "moved 3");
+    disk_manager.WritePages(2, aligned + 1, 2);
+
+    char buf[PAGE_SIZE];
+    for (page_id_t page_id = 0; page_id < 4; ++page_id) {
+      disk_manager.ReadPage(page_id, buf);
+      char expect[PAGE_SIZE];
+      snprintf(expect, PAGE_SIZE, page_id == 3 ? "moved %d" : "run %d", page_id);
+      EXPECT_EQ(0, strcmp(expect, buf));
+    }
+    free(mem);
+    remove("test.db");
+  }
+
+  const int pool_size = 32;
+  AsyncDiskManager *disk_manager = new AsyncDiskManager("test.db", 8);
+  BufferPoolManager *bpm = new BufferPoolManager(pool_size, disk_manager, nullptr, 4);
+  page_id_t temp_page_id;
+  for (int i = 0; i < pool_size; ++i) {
+    Page *page = bpm->NewPage(temp_page_id);
+    ASSERT_NE(nullptr, page);
+    snprintf(page->GetData(), PAGE_SIZE, "page %d", temp_page_id);
+    // every third page stays clean, which splits the range into runs
+    EXPECT_EQ(true, bpm->UnpinPage(temp_page_id, temp_page_id % 3 != 0));
+  }
+  EXPECT_EQ(static_cast<size_t>(pool_size - (pool_size + 2) / 3), bpm->FlushRange(0, pool_size - 1));
+  EXPECT_EQ(0u, bpm->FlushRange(0, pool_size - 1));
+  char buf[PAGE_SIZE];
+  char expect[PAGE_SIZE];
+  for (page_id_t page_id = 0; page_id < pool_size; ++page_id) {
+    if (page_id % 3 == 0) {
+      continue;
+    }
+    disk_manager->ReadPage(page_id, buf);
+    snprintf(expect, PAGE_SIZE, "page %d", page_id);
+    EXPECT_EQ(0, strcmp(expect, buf));
+  }
+  delete bpm;
+  delete disk_manager;
+  remove("test.db");
+}
+
+// reading N pages one at a time against queue-depth batches
+TEST(AsyncDiskManagerTest, QueueDepthBenchmarkTest) {
+  const size_t num_pages = 4096;
+  const size_t queue_depth = 32;
+  AsyncDiskManager disk_manager("test.db", queue_depth);
+  std::vector<char> data(num_pages * PAGE_SIZE, 'a');
+  for (size_t i = 0; i < num_pages; ++i) {
+    disk_manager.WritePage(static_cast<page_id_t>(i), &data[i * PAGE_SIZE]);
+  }
+
+  auto start = std::chrono::steady_clock::now();
+  for (size_t i = 0; i < num_pages; ++i) {
+    disk_manager.ReadPage(static_cast<page_id_t>(i), &data[i * PAGE_SIZE]);
+  }
+  std::chrono::duration<double, std::micro> qd1 = std::chrono::steady_clock::now() - start;
+
+  std::vector<AsyncDiskManager::Completion> done;
+  start = std::chrono::steady_clock::now();
+  for (size_t first = 0; first < num_pages; first += queue_depth) {
+    for (size_t i = first; i < first + queue_depth; ++i) {
+      disk_manager.SubmitRead(static_cast<page_id_t>(i), &data[i * PAGE_SIZE], i);
+    }
+    disk_manager.Submit();
+    done.clear();
+    disk_manager.Complete(done, queue_depth);
+  }
+  std::chrono::duration<double, std::micro> batched = std::chrono::steady_clock::now() - start;
+  std::cout << "AsyncDiskManager (" << (disk_manager.GetBackend() == AsyncDiskManager::Backend::IO_URING
+                                          ? "io_uring" : "threads")
+            << "): QD1 " << qd1.count() / num_pages << " us/page, QD" << queue_depth << " "
+            << batched.count() / num_pages << " us/page" << std::endl;
+
+  remove("test.db");
+}
+
+} // namespace cmudb
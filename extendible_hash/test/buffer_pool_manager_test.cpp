@@ -2,7 +2,10 @@
  * buffer_pool_manager_test.cpp
  */
 
+#include <chrono>
 #include <cstdio>
+#include <random>
+#include <thread>
 
 #include "buffer/buffer_pool_manager.h"
 #include "gtest/gtest.h"
@@ -99,4 +102,379 @@ TEST(BufferPoolManagerTest, SampleTest2) {
 }
 
 
+TEST(BufferPoolManagerTest, ShardedTest) {
+  page_id_t temp_page_id;
+
+  DiskManager *disk_manager = new DiskManager("test.db");
+  // 12 frames split into 4 instances of 3 frames each
+  BufferPoolManager bpm(12, disk_manager, nullptr, 4);
+  EXPECT_EQ(4, bpm.GetNumInstances());
+
+  for (int i = 0; i < 12; ++i) {
+    auto page = bpm.NewPage(temp_page_id);
+    ASSERT_NE(nullptr, page);
+    EXPECT_EQ(i, temp_page_id);
+    snprintf(page->GetData(), PAGE_SIZE, "page %d", i);
+  }
+  // every instance is full, the next page id maps to a pinned instance
+  EXPECT_EQ(nullptr, bpm.NewPage(temp_page_id));
+
+  // unpin the pages of instance 1 only (page ids 1, 5, 9)
+  for (int i = 1; i < 12; i += 4) {
+    EXPECT_EQ(true, bpm.UnpinPage(i, true));
+  }
+  // page ids that land in instance 1 can be created, the others can not
+  int created = 0;
+  for (int i = 0; i < 8; ++i) {
+    Page *page = bpm.NewPage(temp_page_id);
+    if (page != nullptr) {
+      EXPECT_EQ(1, temp_page_id % 4);
+      EXPECT_EQ(true, bpm.UnpinPage(temp_page_id, false));
+      created++;
+    }
+  }
+  EXPECT_EQ(2, created);
+
+  // evicted dirty pages were written back and can be read again
+  for (int i = 1; i < 12; i += 4) {
+    Page *page = bpm.FetchPage(i);
+    ASSERT_NE(nullptr, page);
+    char expect[PAGE_SIZE];
+    snprintf(expect, PAGE_SIZE, "page %d", i);
+    EXPECT_EQ(0, strcmp(page->GetData(), expect));
+    EXPECT_EQ(true, bpm.UnpinPage(i, false));
+  }
+
+  remove("test.db");
+}
+
+TEST(BufferPoolManagerTest, ConcurrentFetchTest) {
+  const int num_threads = 8;
+  const int num_runs = 50;
+  page_id_t temp_page_id;
+
+  DiskManager *disk_manager = new DiskManager("test.db");
+  BufferPoolManager bpm(2, disk_manager);
+
+  // three dirty pages cycling through two frames
+  for (int i = 0; i < 3; ++i) {
+    Page *page = bpm.NewPage(temp_page_id);
+    ASSERT_NE(nullptr, page);
+    snprintf(page->GetData(), PAGE_SIZE, "page %d", i);
+    EXPECT_EQ(true, bpm.UnpinPage(temp_page_id, true));
+  }
+
+  for (int run = 0; run < num_runs; run++) {
+    // two pages per run, so every run misses on at least one of them
+    int page_ids[2] = {run % 3, (run + 1) % 3};
+    std::vector<std::thread> threads;
+    std::vector<Page *> fetched(num_threads, nullptr);
+    for (int tid = 0; tid < num_threads; tid++) {
+      threads.push_back(std::thread([tid, &bpm, &fetched, &page_ids]() {
+        fetched[tid] = bpm.FetchPage(page_ids[tid % 2]);
+      }));
+    }
+    for (int i = 0; i < num_threads; i++) {
+      threads[i].join();
+    }
+    // concurrent fetchers of the same page share one frame and one read
+    for (int tid = 0; tid < num_threads; tid++) {
+      ASSERT_NE(nullptr, fetched[tid]);
+      EXPECT_EQ(fetched[tid % 2], fetched[tid]);
+      char expect[PAGE_SIZE];
+      snprintf(expect, PAGE_SIZE, "page %d", page_ids[tid % 2]);
+      EXPECT_EQ(0, strcmp(fetched[tid]->GetData(), expect));
+    }
+    for (int tid = 0; tid < num_threads; tid++) {
+      EXPECT_EQ(true, bpm.UnpinPage(page_ids[tid % 2], false));
+    }
+  }
+
+  remove("test.db");
+}
+
+// same skewed workload on every replacer, prints hit ratio and throughput
+TEST(BufferPoolManagerTest, ReplacerComparisonTest) {
+  const int num_pages = 256;
+  const int num_fetches = 100000;
+  std::vector<std::pair<const char *, ReplacerType>> replacers{
+      {"LRU", ReplacerType::LRU}, {"CLOCK", ReplacerType::CLOCK},
+      {"LRU_K", ReplacerType::LRU_K}};
+
+  for (auto &r : replacers) {
+    page_id_t temp_page_id;
+    DiskManager *disk_manager = new DiskManager("test.db");
+    BufferPoolManager bpm(64, disk_manager, nullptr, 1, r.second);
+    for (int i = 0; i < num_pages; ++i) {
+      ASSERT_NE(nullptr, bpm.NewPage(temp_page_id));
+      EXPECT_EQ(true, bpm.UnpinPage(temp_page_id, true));
+    }
+
+    // 80% of the fetches go to the first 20% of the pages
+    std::default_random_engine engine(0);
+    std::uniform_int_distribution<int> coin(0, 9);
+    std::uniform_int_distribution<int> hot(0, num_pages / 5 - 1);
+    std::uniform_int_distribution<int> cold(num_pages / 5, num_pages - 1);
+    auto start = std::chrono::steady_clock::now();
+    for (int i = 0; i < num_fetches; ++i) {
+      page_id_t page_id = coin(engine) < 8 ? hot(engine) : cold(engine);
+      Page *page = bpm.FetchPage(page_id);
+      ASSERT_NE(nullptr, page);
+      EXPECT_EQ(true, bpm.UnpinPage(page_id, false));
+    }
+    std::chrono::duration<double> elapsed = std::chrono::steady_clock::now() - start;
+
+    EXPECT_GT(bpm.GetHitRatio(), 0.5);
+    std::cout << r.first << " hit ratio: " << bpm.GetHitRatio()
+              << " fetches/s: " << num_fetches / elapsed.count() << std::endl;
+    remove("test.db");
+  }
+}
+
+// point lookups on a hot set interleaved with a full scan
+TEST(BufferPoolManagerTest, ScanResistanceTest) {
+  const int num_hot = 8;
+  const int num_pages = 200;
+  double hit_ratio[2];
+  ReplacerType replacers[2] = {ReplacerType::LRU, ReplacerType::LRU_K};
+
+  for (int r = 0; r < 2; ++r) {
+    page_id_t temp_page_id;
+    DiskManager *disk_manager = new DiskManager("test.db");
+    BufferPoolManager bpm(16, disk_manager, nullptr, 1, replacers[r]);
+    for (int i = 0; i < num_pages; ++i) {
+      ASSERT_NE(nullptr, bpm.NewPage(temp_page_id));
+      EXPECT_EQ(true, bpm.UnpinPage(temp_page_id, true));
+    }
+    for (int round = 0; round < 10; ++round) {
+      // every hot page is looked up twice between scans
+      for (int i = 0; i < 2 * num_hot; ++i) {
+        ASSERT_NE(nullptr, bpm.FetchPage(i % num_hot));
+        EXPECT_EQ(true, bpm.UnpinPage(i % num_hot, false));
+      }
+      // the scan visits every cold page once per round
+      for (int i = num_hot + round * 19; i < num_hot + (round + 1) * 19; ++i) {
+        ASSERT_NE(nullptr, bpm.FetchPage(i));
+        EXPECT_EQ(true, bpm.UnpinPage(i, false));
+      }
+    }
+    hit_ratio[r] = bpm.GetHitRatio();
+    remove("test.db");
+  }
+  // LRU loses the hot set to every scan, LRU-K keeps it resident
+  EXPECT_GT(hit_ratio[1], hit_ratio[0]);
+}
+
+// resident hits race with misses that evict the same frames
+TEST(BufferPoolManagerTest, ConcurrentHitTest) {
+  const int num_threads = 8;
+  const int num_pages = 24;
+  const int num_fetches = 20000;
+  page_id_t temp_page_id;
+
+  DiskManager *disk_manager = new DiskManager("test.db");
+  BufferPoolManager bpm(16, disk_manager, nullptr, 2);
+  for (int i = 0; i < num_pages; ++i) {
+    Page *page = bpm.NewPage(temp_page_id);
+    ASSERT_NE(nullptr, page);
+    snprintf(page->GetData(), PAGE_SIZE, "page %d", temp_page_id);
+    EXPECT_EQ(true, bpm.UnpinPage(temp_page_id, true));
+  }
+
+  std::vector<std::thread> threads;
+  std::vector<int> failures(num_threads, 0);
+  for (int tid = 0; tid < num_threads; tid++) {
+    threads.push_back(std::thread([tid, &bpm, &failures]() {
+      std::default_random_engine engine(tid);
+      // most fetches go to a few pages that stay resident
+      std::uniform_int_distribution<int> coin(0, 9);
+      std::uniform_int_distribution<int> any(0, num_pages - 1);
+      char expect[PAGE_SIZE];
+      for (int i = 0; i < num_fetches; ++i) {
+        page_id_t page_id = coin(engine) < 9 ? i % 4 : any(engine);
+        Page *page = bpm.FetchPage(page_id);
+        if (page == nullptr) {
+          continue;
+        }
+        snprintf(expect, PAGE_SIZE, "page %d", page_id);
+        if (page->GetPageId() != page_id || strcmp(page->GetData(), expect) != 0) {
+          failures[tid]++;
+        }
+        bpm.UnpinPage(page_id, false);
+      }
+    }));
+  }
+  for (int i = 0; i < num_threads; i++) {
+    threads[i].join();
+  }
+  for (int tid = 0; tid < num_threads; tid++) {
+    EXPECT_EQ(0, failures[tid]);
+  }
+  EXPECT_GT(bpm.GetHitRatio(), 0.5);
+
+  remove("test.db");
+}
+
+
+// the background flusher cleans unpinned pages so that evictions find clean frames
+TEST(BufferPoolManagerTest, BackgroundFlushTest) {
+  const int pool_size = 20;
+  page_id_t temp_page_id;
+
+  DiskManager *disk_manager = new DiskManager("test.db");
+  BufferPoolManager bpm(pool_size, disk_manager);
+  for (int i = 0; i < pool_size; ++i) {
+    Page *page = bpm.NewPage(temp_page_id);
+    ASSERT_NE(nullptr, page);
+    snprintf(page->GetData(), PAGE_SIZE, "page %d", temp_page_id);
+    EXPECT_EQ(true, bpm.UnpinPage(temp_page_id, true));
+  }
+  EXPECT_EQ(1.0, bpm.GetDirtyRatio());
+
+  bpm.StartFlusher(0.0, std::chrono::milliseconds(1));
+  for (int i = 0; i < 2000 && bpm.GetDirtyRatio() > 0.0; ++i) {
+    std::this_thread::sleep_for(std::chrono::milliseconds(1));
+  }
+  EXPECT_EQ(0.0, bpm.GetDirtyRatio());
+
+  // a writer keeps re-dirtying pages while the flusher runs
+  std::default_random_engine engine(0);
+  std::uniform_int_distribution<int> any(0, pool_size - 1);
+  std::vector<int> version(pool_size, 0);
+  for (int i = 0; i < 5000; ++i) {
+    page_id_t page_id = any(engine);
+    Page *page = bpm.FetchPage(page_id);
+    ASSERT_NE(nullptr, page);
+    page->WLatch();
+    snprintf(page->GetData(), PAGE_SIZE, "page %d version %d", page_id, ++version[page_id]);
+    page->WUnlatch();
+    EXPECT_EQ(true, bpm.UnpinPage(page_id, true));
+  }
+  for (int i = 0; i < 2000 && bpm.GetDirtyRatio() > 0.0; ++i) {
+    std::this_thread::sleep_for(std::chrono::milliseconds(1));
+  }
+  bpm.StopFlusher();
+  EXPECT_EQ(0.0, bpm.GetDirtyRatio());
+
+  // every frame is evicted without a foreground write
+  for (int i = 0; i < pool_size; ++i) {
+    EXPECT_NE(nullptr, bpm.NewPage(temp_page_id));
+    EXPECT_EQ(true, bpm.UnpinPage(temp_page_id, false));
+  }
+  EXPECT_EQ(0u, bpm.GetDirtyEvictions());
+
+  // the newest version of every page reached disk
+  char expect[PAGE_SIZE];
+  for (page_id_t page_id = 0; page_id < pool_size; ++page_id) {
+    Page *page = bpm.FetchPage(page_id);
+    ASSERT_NE(nullptr, page);
+    if (version[page_id] == 0) {
+      snprintf(expect, PAGE_SIZE, "page %d", page_id);
+    } else {
+      snprintf(expect, PAGE_SIZE, "page %d version %d", page_id, version[page_id]);
+    }
+    EXPECT_EQ(0, strcmp(expect, page->GetData()));
+    EXPECT_EQ(true, bpm.UnpinPage(page_id, false));
+  }
+
+  remove("test.db");
+}
+
+
+// FlushRange/FlushAllPages write out the dirty set in page_id order
+TEST(BufferPoolManagerTest, FlushAllPagesTest) {
+  const int pool_size = 300;
+  page_id_t temp_page_id;
+
+  DiskManager *disk_manager = new DiskManager("test.db");
+  BufferPoolManager bpm(pool_size, disk_manager, nullptr, 3);
+  for (int i = 0; i < pool_size; ++i) {
+    Page *page = bpm.NewPage(temp_page_id);
+    ASSERT_NE(nullptr, page);
+    snprintf(page->GetData(), PAGE_SIZE, "page %d", temp_page_id);
+    EXPECT_EQ(true, bpm.UnpinPage(temp_page_id, true));
+  }
+
+  EXPECT_EQ(100u, bpm.FlushRange(100, 199));
+  EXPECT_EQ(0u, bpm.FlushRange(100, 199));
+  EXPECT_DOUBLE_EQ(2.0 / 3, bpm.GetDirtyRatio());
+
+  // a checkpoint through FlushPage takes one latch round trip and write per page
+  auto start = std::chrono::steady_clock::now();
+  for (page_id_t page_id = 0; page_id < 100; ++page_id) {
+    EXPECT_EQ(true, bpm.FlushPage(page_id));
+  }
+  std::chrono::duration<double, std::micro> per_page = std::chrono::steady_clock::now() - start;
+
+  for (page_id_t page_id = 0; page_id < 100; ++page_id) {
+    Page *page = bpm.FetchPage(page_id);
+    ASSERT_NE(nullptr, page);
+    EXPECT_EQ(true, bpm.UnpinPage(page_id, true));
+  }
+  start = std::chrono::steady_clock::now();
+  EXPECT_EQ(200u, bpm.FlushAllPages());
+  std::chrono::duration<double, std::micro> batched = std::chrono::steady_clock::now() - start;
+  EXPECT_EQ(0.0, bpm.GetDirtyRatio());
+  std::cout << "FlushPage: " << per_page.count() / 100 << " us/page, FlushAllPages: "
+            << batched.count() / 200 << " us/page" << std::endl;
+
+  // nothing is left for eviction to write, and every page reached disk
+  for (int i = 0; i < pool_size; ++i) {
+    EXPECT_NE(nullptr, bpm.NewPage(temp_page_id));
+    EXPECT_EQ(true, bpm.UnpinPage(temp_page_id, false));
+  }
+  EXPECT_EQ(0u, bpm.GetDirtyEvictions());
+  char expect[PAGE_SIZE];
+  for (page_id_t page_id = 0; page_id < pool_size; ++page_id) {
+    Page *page = bpm.FetchPage(page_id);
+    ASSERT_NE(nullptr, page);
+    snprintf(expect, PAGE_SIZE, "page %d", page_id);
+    EXPECT_EQ(0, strcmp(expect, page->GetData()));
+    EXPECT_EQ(true, bpm.UnpinPage(page_id, false));
+  }
+
+  remove("test.db");
+}
+
+// prefetched pages are read in the background and left unpinned for a later fetch
+TEST(BufferPoolManagerTest, PrefetchTest) {
+  const int pool_size = 20;
+  page_id_t temp_page_id;
+
+  DiskManager *disk_manager = new DiskManager("test.db");
+  BufferPoolManager bpm(pool_size, disk_manager);
+  for (int i = 0; i < pool_size * 2; ++i) {
+    Page *page = bpm.NewPage(temp_page_id);
+    ASSERT_NE(nullptr, page);
+    snprintf(page->GetData(), PAGE_SIZE, "page %d", temp_page_id);
+    EXPECT_EQ(true, bpm.UnpinPage(temp_page_id, true));
+  }
+
+  // pages 0..19 were evicted by the second half
+  EXPECT_EQ(true, bpm.PrefetchPage(pool_size));
+  for (page_id_t page_id = 0; page_id < pool_size / 2; ++page_id) {
+    EXPECT_EQ(false, bpm.PrefetchPage(page_id));
+  }
+  for (page_id_t page_id = 0; page_id < pool_size / 2; ++page_id) {
+    while (!bpm.PrefetchPage(page_id)) {
+      std::this_thread::sleep_for(std::chrono::milliseconds(1));
+    }
+  }
+
+  // prefetching does not pin, so every frame can still be replaced
+  for (page_id_t page_id = 0; page_id < pool_size / 2; ++page_id) {
+    EXPECT_EQ(false, bpm.UnpinPage(page_id, false));
+  }
+  char expect[PAGE_SIZE];
+  for (page_id_t page_id = 0; page_id < pool_size / 2; ++page_id) {
+    Page *page = bpm.FetchPage(page_id);
+    ASSERT_NE(nullptr, page);
+    snprintf(expect, PAGE_SIZE, "page %d", page_id);
+    EXPECT_EQ(0, strcmp(expect, page->GetData()));
+    EXPECT_EQ(true, bpm.UnpinPage(page_id, false));
+  }
+
+  remove("test.db");
+}
+
 } // namespace cmudb
@@ -0,0 +1,96 @@
+/**
+ * clock_replacer_test.cpp
+ */
+
+#include <cstdio>
+
+#include "buffer/clock_replacer.h"
+#include "gtest/gtest.h"
+
+namespace scudb {
+
+TEST(ClockReplacerTest, SampleTest) {
+  ClockReplacer<int> clock_replacer(7);
+
+  // push element into replacer
+  clock_replacer.Insert(1);
+  clock_replacer.Insert(2);
+  clock_replacer.Insert(3);
+  clock_replacer.Insert(4);
+  clock_replacer.Insert(5);
+  clock_replacer.Insert(6);
+  clock_replacer.Insert(1);
+  EXPECT_EQ(6, clock_replacer.Size());
+
+  // first sweep clears every reference bit, then victims follow the hand
+  int value;
+  clock_replacer.Victim(value);
+  EXPECT_EQ(1, value);
+  clock_replacer.Victim(value);
+  EXPECT_EQ(2, value);
+  clock_replacer.Victim(value);
+  EXPECT_EQ(3, value);
+
+  // remove element from replacer
+  EXPECT_EQ(false, clock_replacer.Erase(3));
+  EXPECT_EQ(true, clock_replacer.Erase(5));
+  EXPECT_EQ(2, clock_replacer.Size());
+
+  // a referenced frame gets a second chance
+  clock_replacer.Insert(4);
+  clock_replacer.Victim(value);
+  EXPECT_EQ(6, value);
+  clock_replacer.Victim(value);
+  EXPECT_EQ(4, value);
+  EXPECT_EQ(false, clock_replacer.Victim(value));
+}
+
+TEST(ClockReplacerTest, SampleTest1) {
+  ClockReplacer<int> clock_replacer(3);
+  int value;
+
+  EXPECT_EQ(false, clock_replacer.Victim(value));
+
+  clock_replacer.Insert(0);
+  EXPECT_EQ(1, clock_replacer.Size());
+  EXPECT_EQ(true, clock_replacer.Victim(value));
+  EXPECT_EQ(0, value);
+  EXPECT_EQ(false, clock_replacer.Victim(value));
+
+  EXPECT_EQ(false, clock_replacer.Erase(0));
+  EXPECT_EQ(0, clock_replacer.Size());
+
+  clock_replacer.Insert(1);
+  clock_replacer.Insert(1);
+  clock_replacer.Insert(2);
+  clock_replacer.Insert(2);
+  EXPECT_EQ(2, clock_replacer.Size());
+  EXPECT_EQ(true, clock_replacer.Victim(value));
+  EXPECT_EQ(1, value);
+}
+
+TEST(ClockReplacerTest, BasicTest) {
+  ClockReplacer<int> clock_replacer(100);
+
+  // push element into replacer
+  for (int i = 0; i < 100; ++i) {
+    clock_replacer.Insert(i);
+  }
+  EXPECT_EQ(100, clock_replacer.Size());
+
+  // erase the first 50 frames
+  for (int i = 0; i < 50; ++i) {
+    EXPECT_EQ(true, clock_replacer.Erase(i));
+  }
+
+  // check left, in clock order
+  int value = -1;
+  for (int i = 50; i < 100; ++i) {
+    clock_replacer.Victim(value);
+    EXPECT_EQ(i, value);
+    value = -1;
+  }
+  EXPECT_EQ(0, clock_replacer.Size());
+}
+
+} // namespace scudb
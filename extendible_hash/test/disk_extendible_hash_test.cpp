@@ -0,0 +1,209 @@
+/**
+ * disk_extendible_hash_test.cpp
+ */
+
+#include <chrono>
+#include <cstdio>
+#include <vector>
+
+#include "buffer/buffer_pool_manager.h"
+#include "common/exception.h"
+#include "hash/disk_extendible_hash.h"
+#include "page/header_page.h"
+#include "gtest/gtest.h"
+
+namespace cmudb {
+
+TEST(DiskExtendibleHashTest, SampleTest) {
+  DiskManager *disk_manager = new DiskManager("test.db");
+  // small pool so that directory and bucket pages get evicted and read back
+  BufferPoolManager *bpm = new BufferPoolManager(10, disk_manager);
+  page_id_t header_page_id;
+  auto header_page = static_cast<HeaderPage *>(bpm->NewPage(header_page_id));
+  ASSERT_EQ(HEADER_PAGE_ID, header_page_id);
+  header_page->Init();
+  bpm->UnpinPage(HEADER_PAGE_ID, true);
+
+  DiskExtendibleHash<int, int> hash("foo_pk", bpm);
+  EXPECT_EQ(INVALID_PAGE_ID, hash.GetDirectoryPageId());
+  int value = 0;
+  EXPECT_FALSE(hash.GetValue(1, value));
+
+  const int num_keys = 2000;
+  for (int i = 0; i < num_keys; i++) {
+    EXPECT_TRUE(hash.Insert(i, i * 10));
+  }
+  EXPECT_FALSE(hash.Insert(5, 0));
+  EXPECT_LT(0, hash.GetGlobalDepth());
+  for (int i = 0; i < num_keys; i++) {
+    EXPECT_TRUE(hash.GetValue(i, value));
+    EXPECT_EQ(i * 10, value);
+  }
+  EXPECT_FALSE(hash.GetValue(num_keys, value));
+
+  // the directory root is recorded in the header page
+  page_id_t directory_page_id;
+  header_page = static_cast<HeaderPage *>(bpm->FetchPage(HEADER_PAGE_ID));
+  EXPECT_TRUE(header_page->GetRootId("foo_pk", directory_page_id));
+  EXPECT_EQ(hash.GetDirectoryPageId(), directory_page_id);
+  bpm->UnpinPage(HEADER_PAGE_ID, false);
+
+  // reopening the index by name sees the same contents
+  DiskExtendibleHash<int, int> reopened("foo_pk", bpm);
+  EXPECT_EQ(directory_page_id, reopened.GetDirectoryPageId());
+  for (int i = 0; i < num_keys; i += 7) {
+    EXPECT_TRUE(reopened.GetValue(i, value));
+    EXPECT_EQ(i * 10, value);
+  }
+
+  for (int i = 0; i < num_keys; i++) {
+    if (i % 2 == 1) {
+      EXPECT_TRUE(hash.Remove(i));
+    }
+  }
+  EXPECT_FALSE(hash.Remove(1));
+  for (int i = 0; i < num_keys; i++) {
+    EXPECT_EQ(i % 2 == 0, hash.GetValue(i, value));
+  }
+
+  // emptied buckets merge and the directory shrinks back to one bucket
+  for (int i = 0; i < num_keys; i += 2) {
+    EXPECT_TRUE(hash.Remove(i));
+  }
+  EXPECT_EQ(0, hash.GetGlobalDepth());
+
+  delete bpm;
+  delete disk_manager;
+  remove("test.db");
+}
+
+// keys that agree on every directory bit cannot be separated by splitting
+TEST(DiskExtendibleHashTest, FullDirectoryTest) {
+  DiskManager *disk_manager = new DiskManager("test.db");
+  BufferPoolManager *bpm = new BufferPoolManager(10, disk_manager);
+  page_id_t header_page_id;
+  static_cast<HeaderPage *>(bpm->NewPage(header_page_id))->Init();
+  bpm->UnpinPage(HEADER_PAGE_ID, true);
+
+  DiskExtendibleHash<int, int> hash("foo_pk", bpm);
+  const int stride = static_cast<int>(HashDirectoryPage::DIRECTORY_SLOTS);
+  const int max_size = HashBucketPage<int, int>::GetMaxSize();
+  for (int i = 0; i < max_size; i++) {
+    EXPECT_TRUE(hash.Insert(i * stride, i));
+  }
+  EXPECT_FALSE(hash.Insert(max_size * stride, max_size));
+  int value;
+  for (int i = 0; i < max_size; i++) {
+    EXPECT_TRUE(hash.GetValue(i * stride, value));
+    EXPECT_EQ(i, value);
+  }
+  // other buckets still accept keys
+  EXPECT_TRUE(hash.Insert(1, 1));
+
+  delete bpm;
+  delete disk_manager;
+  remove("test.db");
+}
+
+// pins new pages until the pool is full
+static std::vector<page_id_t> FillPool(BufferPoolManager *bpm) {
+  std::vector<page_id_t> pinned;
+  page_id_t page_id;
+  while (bpm->NewPage(page_id) != nullptr) {
+    pinned.push_back(page_id);
+  }
+  return pinned;
+}
+
+// with every frame pinned the index throws, but leaves no latch or pin behind
+TEST(DiskExtendibleHashTest, PoolExhaustedTest) {
+  DiskManager *disk_manager = new DiskManager("test.db");
+  BufferPoolManager *bpm = new BufferPoolManager(10, disk_manager);
+  page_id_t header_page_id;
+  static_cast<HeaderPage *>(bpm->NewPage(header_page_id))->Init();
+  bpm->UnpinPage(HEADER_PAGE_ID, true);
+
+  DiskExtendibleHash<int, int> hash("foo_pk", bpm);
+  const int num_keys = 500;
+  for (int i = 0; i < num_keys; i++) {
+    EXPECT_TRUE(hash.Insert(i, i));
+  }
+  std::vector<page_id_t> pinned = FillPool(bpm);
+  const size_t free_frames = pinned.size();
+  EXPECT_LT(0u, free_frames);
+
+  int value;
+  int failures = 0;
+  for (int op = 0; op < 4; op++) {
+    try {
+      if (op == 0) {
+        hash.GetValue(0, value);
+      } else if (op == 1) {
+        hash.Insert(num_keys, 0);
+      } else if (op == 2) {
+        hash.Remove(0);
+      } else {
+        hash.GetGlobalDepth();
+      }
+    } catch (Exception &e) {
+      failures++;
+    }
+  }
+  EXPECT_EQ(4, failures);
+  for (page_id_t page_id : pinned) {
+    bpm->UnpinPage(page_id, false);
+  }
+
+  // splits and merges take the write latch, so the failed calls released it
+  for (int i = num_keys; i < 2 * num_keys; i++) {
+    EXPECT_TRUE(hash.Insert(i, i));
+  }
+  for (int i = 0; i < 2 * num_keys; i++) {
+    EXPECT_TRUE(hash.GetValue(i, value));
+    EXPECT_EQ(i, value);
+    EXPECT_TRUE(hash.Remove(i));
+  }
+  EXPECT_EQ(0, hash.GetGlobalDepth());
+  // and no page stayed pinned
+  pinned = FillPool(bpm);
+  EXPECT_EQ(free_frames, pinned.size());
+  for (page_id_t page_id : pinned) {
+    bpm->UnpinPage(page_id, false);
+  }
+
+  delete bpm;
+  delete disk_manager;
+  remove("test.db");
+}
+
+// page accesses per probe are constant: one directory page and one bucket page
+TEST(DiskExtendibleHashTest, LookupBenchmarkTest) {
+  DiskManager *disk_manager = new DiskManager("test.db");
+  BufferPoolManager *bpm = new BufferPoolManager(100, disk_manager);
+  page_id_t header_page_id;
+  static_cast<HeaderPage *>(bpm->NewPage(header_page_id))->Init();
+  bpm->UnpinPage(HEADER_PAGE_ID, true);
+
+  DiskExtendibleHash<int, int> hash("foo_pk", bpm);
+  const int num_keys = 2000;
+  const int num_probes = 200000;
+  for (int i = 0; i < num_keys; i++) {
+    hash.Insert(i, i);
+  }
+  int value;
+  long found = 0;
+  auto start = std::chrono::steady_clock::now();
+  for (int i = 0; i < num_probes; i++) {
+    found += hash.GetValue(i % num_keys, value);
+  }
+  std::chrono::duration<double, std::nano> elapsed = std::chrono::steady_clock::now() - start;
+  EXPECT_EQ(num_probes, found);
+  std::cout << "DiskExtendibleHash lookup: " << elapsed.count() / num_probes
+            << " ns/probe" << std::endl;
+
+  delete bpm;
+  delete disk_manager;
+  remove("test.db");
+}
+
+} // namespace cmudb
@@ -2,6 +2,9 @@
  * extendible_hash_test.cpp
  */
 
+#include <atomic>
+#include <chrono>
+#include <map>
 #include <thread>
 #include <random>
 
@@ -236,6 +239,49 @@ TEST(ExtendibleHashTest, RandomInsertAndDeleteTest) {
 
 
 
+// buckets merge with their buddy and the directory halves after deletes
+TEST(ExtendibleHashTest, MergeTest) {
+  ExtendibleHash<int, int> *test = new ExtendibleHash<int, int>(4);
+
+  for (int i = 0; i < 1000; i++) {
+    test->Insert(i, i);
+  }
+  int peak_depth = test->GetGlobalDepth();
+  int peak_buckets = test->GetNumBuckets();
+  EXPECT_LE(8, peak_depth);
+
+  // keep the first 100 keys, they fit in far fewer buckets
+  for (int i = 100; i < 1000; i++) {
+    EXPECT_EQ(1, test->Remove(i));
+  }
+  EXPECT_GT(peak_depth, test->GetGlobalDepth());
+  EXPECT_GT(peak_buckets, test->GetNumBuckets());
+  int value;
+  for (int i = 0; i < 1000; i++) {
+    EXPECT_EQ(i < 100, test->Find(i, value));
+  }
+
+  for (int i = 0; i < 100; i++) {
+    EXPECT_EQ(1, test->Remove(i));
+  }
+  EXPECT_EQ(0, test->GetGlobalDepth());
+  EXPECT_EQ(1, test->GetNumBuckets());
+
+  // merged buckets and directories are reused when the table grows again
+  for (int i = 0; i < 1000; i++) {
+    test->Insert(i, i);
+  }
+  EXPECT_EQ(peak_depth, test->GetGlobalDepth());
+  EXPECT_EQ(peak_buckets, test->GetNumBuckets());
+  for (int i = 0; i < 1000; i++) {
+    EXPECT_TRUE(test->Find(i, value));
+    EXPECT_EQ(i, value);
+  }
+
+  delete test;
+}
+
+
 TEST(ExtendibleHashTest, ConcurrentInsertTest) {
   const int num_runs = 50;
   const int num_threads = 3;
@@ -281,7 +327,8 @@ TEST(ExtendibleHashTest, ConcurrentRemoveTest) {
     for (int i = 0; i < num_threads; i++) {
       threads[i].join();
     }
-    EXPECT_EQ(test->GetGlobalDepth(), 6);
+    // emptied buckets merge back, so the directory may have shrunk
+    EXPECT_LE(test->GetGlobalDepth(), 6);
     int val;
     EXPECT_EQ(0, test->Find(0, val));
     EXPECT_EQ(1, test->Find(8, val));
@@ -291,4 +338,86 @@ TEST(ExtendibleHashTest, ConcurrentRemoveTest) {
   }
 }
 
+
+// ConcurrentInsertTest/ConcurrentRemoveTest scaled up: every thread inserts,
+// finds and removes its own keys; prints ops/s for 1..64 threads
+TEST(ExtendibleHashTest, ConcurrentThroughputTest) {
+  const int keys_per_thread = 20000;
+  int thread_counts[] = {1, 2, 4, 8, 16, 32, 64};
+
+  for (int num_threads : thread_counts) {
+    std::shared_ptr<ExtendibleHash<int, int>> test{new ExtendibleHash<int, int>(BUCKET_SIZE)};
+    std::vector<std::thread> threads;
+    std::atomic<int> errors(0);
+    auto start = std::chrono::steady_clock::now();
+    for (int tid = 0; tid < num_threads; tid++) {
+      threads.push_back(std::thread([tid, num_threads, &test, &errors]() {
+        int val;
+        // keys are interleaved so all threads hit the same buckets and splits
+        for (int i = tid; i < keys_per_thread * num_threads; i += num_threads) {
+          test->Insert(i, i);
+        }
+        for (int i = tid; i < keys_per_thread * num_threads; i += num_threads) {
+          if (!test->Find(i, val) || val != i) errors++;
+        }
+        for (int i = tid; i < keys_per_thread * num_threads; i += 2 * num_threads) {
+          if (!test->Remove(i)) errors++;
+        }
+      }));
+    }
+    for (int i = 0; i < num_threads; i++) {
+      threads[i].join();
+    }
+    std::chrono::duration<double> elapsed = std::chrono::steady_clock::now() - start;
+
+    EXPECT_EQ(0, errors.load());
+    int val;
+    for (int i = 0; i < keys_per_thread * num_threads; i++) {
+      EXPECT_EQ((i % (2 * num_threads)) >= num_threads, test->Find(i, val));
+    }
+    // insert + find for every key, remove for half of them
+    double ops = keys_per_thread * num_threads * 2.5;
+    std::cout << num_threads << " threads: " << ops / elapsed.count()
+              << " ops/s" << std::endl;
+  }
+}
+
+
+// probe latency inside one bucket filled to 50/90/100% of bucket_size
+TEST(ExtendibleHashTest, ProbeLatencyTest) {
+  const int bucket_size = 64;
+  const int num_probes = 1000000;
+  int fills[] = {50, 90, 100};
+
+  for (int fill : fills) {
+    // a single bucket never splits while it holds at most bucket_size keys
+    ExtendibleHash<int, int> *test =
+            new ExtendibleHash<int, int>(bucket_size);
+    int num_keys = bucket_size * fill / 100;
+    for (int i = 0; i < num_keys; i++) {
+      test->Insert(i, i);
+    }
+    EXPECT_EQ(0, test->GetGlobalDepth());
+
+    int value = 0;
+    long found = 0;
+    auto start = std::chrono::steady_clock::now();
+    for (int i = 0; i < num_probes; i++) {
+      found += test->Find(i % num_keys, value);
+    }
+    std::chrono::duration<double, std::nano> hit = std::chrono::steady_clock::now() - start;
+    start = std::chrono::steady_clock::now();
+    for (int i = 0; i < num_probes; i++) {
+      found += test->Find(num_keys + i, value);
+    }
+    std::chrono::duration<double, std::nano> miss = std::chrono::steady_clock::now() - start;
+
+    EXPECT_EQ(num_probes, found);
+    std::cout << "fill " << fill << "%: hit " << hit.count() / num_probes
+              << " ns/probe, miss " << miss.count() / num_probes
+              << " ns/probe" << std::endl;
+    delete test;
+  }
+}
+
 } // namespace cmudb
\ No newline at end of file
@@ -0,0 +1,248 @@
+/**
+ * frame_arena_test.cpp
+ */
+
+#include <chrono>
+#include <cstdint>
+#include <cstring>
+#include <fstream>
+#include <string>
+#include <vector>
+
+#include <linux/mempolicy.h>
+#include <linux/perf_event.h>
+#include <sched.h>
+#include <sys/ioctl.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+
+#include "buffer/buffer_pool_manager.h"
+#include "buffer/frame_arena.h"
+#include "gtest/gtest.h"
+
+namespace cmudb {
+
+TEST(FrameArenaTest, AlignmentTest) {
+  const size_t num_frames = 100;
+  FrameArena heap(num_frames, ArenaType::HEAP);
+  FrameArena aligned(num_frames, ArenaType::ALIGNED);
+  FrameArena huge(num_frames, ArenaType::TRANSPARENT_HUGE);
+  EXPECT_EQ(0u, heap.GetBytes());
+  EXPECT_EQ(0u, reinterpret_cast<uintptr_t>(aligned.GetFrames()) % FrameArena::SMALL_PAGE_SIZE);
+  EXPECT_LE(num_frames * sizeof(Page), aligned.GetBytes());
+  EXPECT_EQ(0u, reinterpret_cast<uintptr_t>(huge.GetFrames()) % FrameArena::HUGE_PAGE_SIZE);
+  EXPECT_EQ(0u, huge.GetBytes() % FrameArena::HUGE_PAGE_SIZE);
+
+  // frames are constructed and writable
+  for (FrameArena *arena : {&heap, &aligned, &huge}) {
+    Page *frames = arena->GetFrames();
+    for (size_t i = 0; i < num_frames; ++i) {
+      EXPECT_EQ(INVALID_PAGE_ID, frames[i].GetPageId());
+      EXPECT_EQ(0, frames[i].GetData()[PAGE_SIZE - 1]);
+      memset(frames[i].GetData(), 'x', PAGE_SIZE);
+    }
+  }
+}
+
+// free 2 MiB pages reserved for MAP_HUGETLB, from /proc/meminfo
+static long FreeHugePages() {
+  std::ifstream in("/proc/meminfo");
+  std::string name;
+  long value;
+  long free_pages = 0, page_kb = 0;
+  while (in >> name >> value) {
+    if (name == "HugePages_Free:") {
+      free_pages = value;
+    } else if (name == "Hugepagesize:") {
+      page_kb = value;
+    }
+    in.ignore(256, '\n');
+  }
+  return page_kb == static_cast<long>(FrameArena::HUGE_PAGE_SIZE / 1024) ? free_pages : 0;
+}
+
+TEST(FrameArenaTest, HugeTlbFallbackTest) {
+  const size_t num_frames = 10;
+  bool reserved = FreeHugePages() * FrameArena::HUGE_PAGE_SIZE >= num_frames * sizeof(Page);
+  FrameArena arena(num_frames, ArenaType::HUGETLB);
+  if (!reserved) {
+    // without reserved huge pages the arena falls back to transparent huge pages
+    EXPECT_EQ(ArenaType::TRANSPARENT_HUGE, arena.GetType());
+  } else {
+    EXPECT_EQ(true, arena.GetType() == ArenaType::HUGETLB || arena.GetType() == ArenaType::TRANSPARENT_HUGE);
+  }
+  EXPECT_EQ(0u, reinterpret_cast<uintptr_t>(arena.GetFrames()) % FrameArena::HUGE_PAGE_SIZE);
+  EXPECT_EQ(0u, arena.GetBytes() % FrameArena::HUGE_PAGE_SIZE);
+  EXPECT_LE(num_frames * sizeof(Page), arena.GetBytes());
+  Page *frames = arena.GetFrames();
+  for (size_t i = 0; i < num_frames; ++i) {
+    EXPECT_EQ(INVALID_PAGE_ID, frames[i].GetPageId());
+    memset(frames[i].GetData(), 'x', PAGE_SIZE);
+  }
+}
+
+TEST(FrameArenaTest, OnlineNodesTest) {
+  std::vector<int> nodes = FrameArena::GetOnlineNodes();
+  ASSERT_EQ(false, nodes.empty());
+  EXPECT_EQ(static_cast<int>(nodes.size()), FrameArena::GetNumNodes());
+  for (size_t i = 1; i < nodes.size(); ++i) {
+    EXPECT_LT(nodes[i - 1], nodes[i]);
+  }
+}
+
+// each shard of a partitioned arena is on its node, or reported as unbound
+TEST(FrameArenaTest, NumaPartitionTest) {
+  std::vector<int> nodes = FrameArena::GetOnlineNodes();
+  const size_t frames_per_shard = 4 * FrameArena::HUGE_PAGE_SIZE / sizeof(Page);
+  std::vector<size_t> shards(4, frames_per_shard);
+  FrameArena arena(frames_per_shard * shards.size(), ArenaType::ALIGNED, NumaPolicy::PARTITION, shards);
+  for (size_t i = 0; i < shards.size(); ++i) {
+    int node = arena.GetNode(i);
+    if (nodes.size() <= 1) {
+      EXPECT_EQ(-1, node);
+      continue;
+    }
+    if (node == -1) {
+      // mbind is not permitted here
+      continue;
+    }
+    EXPECT_EQ(nodes[i % nodes.size()], node);
+    // a page in the middle of the shard is placed on that node when first touched
+    Page *frame = &arena.GetFrames()[i * frames_per_shard + frames_per_shard / 2];
+    memset(frame->GetData(), 'x', PAGE_SIZE);
+    int placed = -1;
+    ASSERT_EQ(0, syscall(__NR_get_mempolicy, &placed, nullptr, 0, frame->GetData(), MPOL_F_NODE | MPOL_F_ADDR));
+    EXPECT_EQ(node, placed);
+  }
+}
+
+// the buffer pool reports the node of each shard
+TEST(FrameArenaTest, NumaBufferPoolTest) {
+  std::vector<int> nodes = FrameArena::GetOnlineNodes();
+  DiskManager *disk_manager = new DiskManager("test.db");
+  BufferPoolManager *bpm = new BufferPoolManager(100, disk_manager, nullptr, 4, ReplacerType::LRU,
+                                                 ArenaType::ALIGNED, NumaPolicy::PARTITION);
+  for (size_t i = 0; i < bpm->GetNumInstances(); ++i) {
+    int node = bpm->GetInstanceNode(i);
+    if (nodes.size() > 1) {
+      EXPECT_EQ(true, node == -1 || node == nodes[i % nodes.size()]);
+    } else {
+      EXPECT_EQ(-1, node);
+    }
+  }
+  page_id_t page_id;
+  for (int i = 0; i < 200; ++i) {
+    ASSERT_NE(nullptr, bpm->NewPage(page_id));
+    EXPECT_EQ(true, bpm->UnpinPage(page_id, false));
+  }
+  delete bpm;
+  delete disk_manager;
+  remove("test.db");
+}
+
+// counts user-space dTLB load misses of this thread; -1 when the counter is unavailable
+static int OpenTlbCounter() {
+  perf_event_attr attr;
+  memset(&attr, 0, sizeof(attr));
+  attr.size = sizeof(attr);
+  attr.type = PERF_TYPE_HW_CACHE;
+  attr.config = PERF_COUNT_HW_CACHE_DTLB | (PERF_COUNT_HW_CACHE_OP_READ << 8) |
+                (PERF_COUNT_HW_CACHE_RESULT_MISS << 16);
+  attr.disabled = 1;
+  attr.exclude_kernel = 1;
+  attr.exclude_hv = 1;
+  return static_cast<int>(syscall(__NR_perf_event_open, &attr, 0, -1, -1, 0));
+}
+
+// touches random bytes of frames [first, first + count), returns ns/touch
+static double TouchFrames(Page *frames, size_t first, size_t count, size_t touches, long long *tlb_misses) {
+  int counter = OpenTlbCounter();
+  uint64_t x = 88172645463325252ULL;
+  uint64_t sum = 0;
+  if (counter >= 0) {
+    ioctl(counter, PERF_EVENT_IOC_RESET, 0);
+    ioctl(counter, PERF_EVENT_IOC_ENABLE, 0);
+  }
+  auto start = std::chrono::steady_clock::now();
+  for (size_t i = 0; i < touches; ++i) {
+    x ^= x << 13;
+    x ^= x >> 7;
+    x ^= x << 17;
+    sum += frames[first + x % count].GetData()[(x >> 32) % PAGE_SIZE];
+  }
+  std::chrono::duration<double, std::nano> elapsed = std::chrono::steady_clock::now() - start;
+  *tlb_misses = -1;
+  if (counter >= 0) {
+    ioctl(counter, PERF_EVENT_IOC_DISABLE, 0);
+    if (read(counter, tlb_misses, sizeof(*tlb_misses)) != sizeof(*tlb_misses)) {
+      *tlb_misses = -1;
+    }
+    close(counter);
+  }
+  EXPECT_EQ(0u, sum);
+  return elapsed.count() / touches;
+}
+
+// binds the calling thread to the CPUs of a NUMA node
+static bool BindToNode(int node) {
+  std::ifstream in("/sys/devices/system/node/node" + std::to_string(node) + "/cpulist");
+  std::string list;
+  if (!(in >> list)) {
+    return false;
+  }
+  cpu_set_t cpus;
+  CPU_ZERO(&cpus);
+  size_t pos = 0;
+  while (pos < list.size()) {
+    size_t end = list.find(',', pos);
+    std::string range = list.substr(pos, end == std::string::npos ? std::string::npos : end - pos);
+    size_t dash = range.find('-');
+    int lo = std::stoi(range.substr(0, dash));
+    int hi = dash == std::string::npos ? lo : std::stoi(range.substr(dash + 1));
+    for (int cpu = lo; cpu <= hi; ++cpu) {
+      CPU_SET(cpu, &cpus);
+    }
+    pos = end == std::string::npos ? list.size() : end + 1;
+  }
+  return sched_setaffinity(0, sizeof(cpus), &cpus) == 0;
+}
+
+// random frame touches over a 256 MiB arena for each memory source; on a
+// multi-node host also a thread on the first node reading its own shard when shards
+// are partitioned by node versus interleaved across nodes
+TEST(FrameArenaTest, PlacementBenchmarkTest) {
+  const size_t num_frames = (256u << 20) / sizeof(Page);
+  const size_t touches = 4000000;
+  const char *names[] = {"heap", "aligned", "transparent huge", "hugetlb"};
+  for (ArenaType type : {ArenaType::HEAP, ArenaType::ALIGNED, ArenaType::TRANSPARENT_HUGE, ArenaType::HUGETLB}) {
+    FrameArena arena(num_frames, type);
+    long long tlb_misses;
+    double ns = TouchFrames(arena.GetFrames(), 0, num_frames, touches, &tlb_misses);
+    std::cout << "FrameArena " << names[static_cast<int>(type)] << " (got "
+              << names[static_cast<int>(arena.GetType())] << "): " << ns << " ns/touch, dTLB misses/touch "
+              << (tlb_misses < 0 ? std::string("n/a") : std::to_string(static_cast<double>(tlb_misses) / touches))
+              << std::endl;
+  }
+
+  std::vector<int> nodes = FrameArena::GetOnlineNodes();
+  int num_nodes = static_cast<int>(nodes.size());
+  cpu_set_t saved;
+  if (num_nodes <= 1 || sched_getaffinity(0, sizeof(saved), &saved) != 0 || !BindToNode(nodes[0])) {
+    std::cout << "FrameArena: single NUMA node, skipping placement comparison" << std::endl;
+    return;
+  }
+  std::vector<size_t> shards(num_nodes, num_frames / num_nodes);
+  shards[0] += num_frames % num_nodes;
+  for (NumaPolicy policy : {NumaPolicy::INTERLEAVE, NumaPolicy::PARTITION}) {
+    FrameArena arena(num_frames, ArenaType::TRANSPARENT_HUGE, policy, shards);
+    long long tlb_misses;
+    double ns = TouchFrames(arena.GetFrames(), 0, shards[0], touches, &tlb_misses);
+    std::cout << "FrameArena shard 0 from node " << nodes[0] << ", "
+              << (policy == NumaPolicy::INTERLEAVE ? "interleaved" : "partitioned") << ": " << ns
+              << " ns/touch" << std::endl;
+  }
+  // the other tests run on this thread
+  sched_setaffinity(0, sizeof(saved), &saved);
+}
+
+} // namespace cmudb
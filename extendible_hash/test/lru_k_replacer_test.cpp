@@ -0,0 +1,100 @@
+/**
+ * lru_k_replacer_test.cpp
+ */
+
+#include <cstdio>
+
+#include "buffer/lru_k_replacer.h"
+#include "gtest/gtest.h"
+
+namespace scudb {
+
+TEST(LRUKReplacerTest, SampleTest) {
+  LRUKReplacer<int> lru_k_replacer(7);
+
+  // frame 1 is accessed twice, all others once
+  lru_k_replacer.Insert(1);
+  lru_k_replacer.Insert(2);
+  lru_k_replacer.Insert(3);
+  lru_k_replacer.Insert(4);
+  lru_k_replacer.Insert(5);
+  lru_k_replacer.Insert(6);
+  lru_k_replacer.Insert(1);
+  EXPECT_EQ(6, lru_k_replacer.Size());
+
+  // frames with less than k accesses go first, oldest first
+  int value;
+  lru_k_replacer.Victim(value);
+  EXPECT_EQ(2, value);
+  lru_k_replacer.Victim(value);
+  EXPECT_EQ(3, value);
+  lru_k_replacer.Victim(value);
+  EXPECT_EQ(4, value);
+
+  // remove element from replacer
+  EXPECT_EQ(false, lru_k_replacer.Erase(4));
+  EXPECT_EQ(true, lru_k_replacer.Erase(6));
+  EXPECT_EQ(2, lru_k_replacer.Size());
+
+  lru_k_replacer.Victim(value);
+  EXPECT_EQ(5, value);
+  lru_k_replacer.Victim(value);
+  EXPECT_EQ(1, value);
+  EXPECT_EQ(false, lru_k_replacer.Victim(value));
+}
+
+TEST(LRUKReplacerTest, BackwardKDistanceTest) {
+  LRUKReplacer<int> lru_k_replacer(4);
+  int value;
+
+  // access order 0 1 2 0 1 2 1: the 2nd most recent access of
+  // frame 0 is the oldest, then frame 2, then frame 1
+  lru_k_replacer.Insert(0);
+  lru_k_replacer.Insert(1);
+  lru_k_replacer.Insert(2);
+  lru_k_replacer.Insert(0);
+  lru_k_replacer.Insert(1);
+  lru_k_replacer.Insert(2);
+  lru_k_replacer.Insert(1);
+
+  lru_k_replacer.Victim(value);
+  EXPECT_EQ(0, value);
+  lru_k_replacer.Victim(value);
+  EXPECT_EQ(2, value);
+
+  // an erased frame keeps its history, a victim does not
+  EXPECT_EQ(true, lru_k_replacer.Erase(1));
+  lru_k_replacer.Insert(0);
+  lru_k_replacer.Insert(1);
+  lru_k_replacer.Victim(value);
+  EXPECT_EQ(0, value);
+  lru_k_replacer.Victim(value);
+  EXPECT_EQ(1, value);
+}
+
+TEST(LRUKReplacerTest, ScanResistanceTest) {
+  LRUKReplacer<int> lru_k_replacer(100);
+  int value;
+
+  // frames 0..9 are hot, accessed twice
+  for (int i = 0; i < 10; ++i) {
+    lru_k_replacer.Insert(i);
+    lru_k_replacer.Insert(i);
+  }
+  // a scan touches frames 10..99 once, after the hot accesses
+  for (int i = 10; i < 100; ++i) {
+    lru_k_replacer.Insert(i);
+  }
+  // every scanned frame is evicted before any hot frame
+  for (int i = 10; i < 100; ++i) {
+    lru_k_replacer.Victim(value);
+    EXPECT_EQ(i, value);
+  }
+  for (int i = 0; i < 10; ++i) {
+    lru_k_replacer.Victim(value);
+    EXPECT_EQ(i, value);
+  }
+  EXPECT_EQ(0, lru_k_replacer.Size());
+}
+
+} // namespace scudb
@@ -2,7 +2,9 @@
  * lru_replacer_test.cpp
  */
 
+#include <chrono>
 #include <cstdio>
+#include <random>
 
 #include "buffer/lru_replacer.h"
 #include "gtest/gtest.h"
@@ -97,4 +99,103 @@ TEST(LRUReplacerTest, BasicTest) {
   }
 }
 
+TEST(LRUReplacerTest, FrameSampleTest) {
+  FrameLRUReplacer<int> lru_replacer(7);
+
+  // push element into replacer
+  lru_replacer.Insert(1);
+  lru_replacer.Insert(2);
+  lru_replacer.Insert(3);
+  lru_replacer.Insert(4);
+  lru_replacer.Insert(5);
+  lru_replacer.Insert(6);
+  lru_replacer.Insert(1);
+  EXPECT_EQ(6, lru_replacer.Size());
+
+  // pop element from replacer
+  int value;
+  lru_replacer.Victim(value);
+  EXPECT_EQ(2, value);
+  lru_replacer.Victim(value);
+  EXPECT_EQ(3, value);
+  lru_replacer.Victim(value);
+  EXPECT_EQ(4, value);
+
+  // remove element from replacer
+  EXPECT_EQ(false, lru_replacer.Erase(4));
+  EXPECT_EQ(true, lru_replacer.Erase(6));
+  EXPECT_EQ(2, lru_replacer.Size());
+
+  // pop element from replacer after removal
+  lru_replacer.Victim(value);
+  EXPECT_EQ(5, value);
+  lru_replacer.Victim(value);
+  EXPECT_EQ(1, value);
+  EXPECT_EQ(false, lru_replacer.Victim(value));
+}
+
+TEST(LRUReplacerTest, FrameBasicTest) {
+  FrameLRUReplacer<int> lru_replacer(100);
+
+  // push element into replacer
+  for (int i = 0; i < 100; ++i) {
+    lru_replacer.Insert(i);
+  }
+  EXPECT_EQ(100, lru_replacer.Size());
+
+  // reverse then insert again
+  for (int i = 0; i < 100; ++i) {
+    lru_replacer.Insert(99 - i);
+  }
+
+  // erase 50 element from the tail
+  for (int i = 0; i < 50; ++i) {
+    EXPECT_EQ(true, lru_replacer.Erase(i));
+  }
+
+  // check left
+  int value = -1;
+  for (int i = 99; i >= 50; --i) {
+    lru_replacer.Victim(value);
+    EXPECT_EQ(i, value);
+    value = -1;
+  }
+}
+
+// unpin/pin/evict cycle of the buffer pool against both implementations
+template <typename Replacer>
+double ReplacerOpsPerSecond(Replacer &replacer, int num_frames) {
+  const int num_ops = 1000000;
+  std::default_random_engine engine(0);
+  std::uniform_int_distribution<int> distribution(0, num_frames - 1);
+  int value;
+  auto start = std::chrono::steady_clock::now();
+  for (int i = 0; i < num_ops; ++i) {
+    int frame = distribution(engine);
+    switch (i % 3) {
+    case 0: replacer.Insert(frame); break;
+    case 1: replacer.Erase(frame); break;
+    default:
+      if (replacer.Victim(value)) {
+        replacer.Insert(value);
+      }
+      break;
+    }
+  }
+  std::chrono::duration<double> elapsed = std::chrono::steady_clock::now() - start;
+  return num_ops / elapsed.count();
+}
+
+TEST(LRUReplacerTest, BenchmarkTest) {
+  const int num_frames = 1024;
+  LRUReplacer<int> lru_replacer;
+  FrameLRUReplacer<int> frame_lru_replacer(num_frames);
+
+  double lru_ops = ReplacerOpsPerSecond(lru_replacer, num_frames);
+  double frame_lru_ops = ReplacerOpsPerSecond(frame_lru_replacer, num_frames);
+  std::cout << "LRUReplacer ops/s: " << lru_ops << std::endl;
+  std::cout << "FrameLRUReplacer ops/s: " << frame_lru_ops << std::endl;
+  EXPECT_EQ(lru_replacer.Size(), frame_lru_replacer.Size());
+}
+
 } // namespace cmudb
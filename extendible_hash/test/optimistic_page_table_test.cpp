@@ -0,0 +1,68 @@
+/**
+ * optimistic_page_table_test.cpp
+ */
+
+#include <cstdio>
+#include <map>
+#include <random>
+
+#include "buffer/optimistic_page_table.h"
+#include "gtest/gtest.h"
+
+namespace scudb {
+
+TEST(OptimisticPageTableTest, SampleTest) {
+  OptimisticPageTable table(4);
+  size_t frame_id = 0;
+
+  EXPECT_EQ(false, table.Find(0, frame_id));
+  table.Insert(0, 3);
+  table.Insert(4, 1);
+  table.Insert(8, 2);
+  EXPECT_EQ(true, table.Find(0, frame_id));
+  EXPECT_EQ(3, frame_id);
+  EXPECT_EQ(true, table.Find(8, frame_id));
+  EXPECT_EQ(2, frame_id);
+  EXPECT_EQ(false, table.Find(12, frame_id));
+  EXPECT_EQ(false, table.Find(INVALID_PAGE_ID, frame_id));
+
+  EXPECT_EQ(true, table.Remove(4));
+  EXPECT_EQ(false, table.Remove(4));
+  EXPECT_EQ(false, table.Find(4, frame_id));
+  EXPECT_EQ(true, table.Find(8, frame_id));
+  EXPECT_EQ(2, frame_id);
+}
+
+// eviction churn: the table never holds more entries than frames
+TEST(OptimisticPageTableTest, ChurnTest) {
+  const size_t num_frames = 16;
+  OptimisticPageTable table(num_frames);
+  std::map<page_id_t, size_t> resident;
+  std::default_random_engine engine(0);
+  std::uniform_int_distribution<int> distribution(0, 1000);
+
+  page_id_t next_page_id = 0;
+  for (int i = 0; i < 100000; ++i) {
+    if (resident.size() == num_frames) {
+      auto victim = resident.begin();
+      std::advance(victim, distribution(engine) % resident.size());
+      size_t frame_id = victim->second;
+      EXPECT_EQ(true, table.Remove(victim->first));
+      resident.erase(victim);
+      resident[next_page_id] = frame_id;
+      table.Insert(next_page_id++, frame_id);
+    } else {
+      resident[next_page_id] = resident.size();
+      table.Insert(next_page_id++, resident.size() - 1);
+    }
+  }
+
+  size_t frame_id = 0;
+  for (auto &entry : resident) {
+    EXPECT_EQ(true, table.Find(entry.first, frame_id));
+    EXPECT_EQ(entry.second, frame_id);
+  }
+  EXPECT_EQ(false, table.Find(0, frame_id));
+}
+
+} // namespace scudb